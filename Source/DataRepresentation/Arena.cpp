@@ -0,0 +1,112 @@
+/*!
+* \file
+* Member function definitions for Arena class. This file is part of DataRepresentation module.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#include <DataRepresentation/Arena.h>
+#include <new>
+
+namespace lpmldata
+{
+
+//-----------------------------------------------------------------------------
+
+Arena::Arena( size_t aChunkSize )
+:
+	mMutex(),
+	mChunks(),
+	mChunkSize( ( ( aChunkSize < kAlignment ? kAlignment : aChunkSize ) + kAlignment - 1 ) / kAlignment * kAlignment ),
+	mCurrent( nullptr ),
+	mRemaining( 0 ),
+	mSize( 0 ),
+	mCapacity( 0 )
+{
+}
+
+//-----------------------------------------------------------------------------
+
+Arena::~Arena()
+{
+	clear();
+}
+
+//-----------------------------------------------------------------------------
+
+void* Arena::allocate( size_t aSize )
+{
+	size_t size = ( ( aSize == 0 ? 1 : aSize ) + kAlignment - 1 ) / kAlignment * kAlignment;
+
+	QMutexLocker locker( &mMutex );
+
+	if ( size > mRemaining )
+	{
+		// Large blocks get their own chunk and leave the current one in place.
+		bool isOwnChunk = size > mChunkSize / 4;
+		size_t chunkSize = isOwnChunk ? size : mChunkSize;
+
+		char* chunk = static_cast< char* >( aligned_malloc( kAlignment, chunkSize ) );
+		if ( chunk == nullptr ) throw std::bad_alloc();
+
+		mChunks.push_back( chunk );
+		mCapacity += chunkSize;
+
+		if ( isOwnChunk )
+		{
+			mSize += size;
+			return chunk;
+		}
+
+		mCurrent   = chunk;
+		mRemaining = chunkSize;
+	}
+
+	void* block = mCurrent;
+	mCurrent   += size;
+	mRemaining -= size;
+	mSize      += size;
+
+	return block;
+}
+
+//-----------------------------------------------------------------------------
+
+void Arena::clear()
+{
+	QMutexLocker locker( &mMutex );
+
+	for ( char* chunk : mChunks )
+	{
+		aligned_free( chunk );
+	}
+
+	mChunks.clear();
+	mCurrent   = nullptr;
+	mRemaining = 0;
+	mSize      = 0;
+	mCapacity  = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+size_t Arena::size() const
+{
+	QMutexLocker locker( &mMutex );
+	return mSize;
+}
+
+//-----------------------------------------------------------------------------
+
+size_t Arena::capacity() const
+{
+	QMutexLocker locker( &mMutex );
+	return mCapacity;
+}
+
+//-----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,87 @@
+/*!
+* \file This file is part of Datarepresentation module.
+* The Arena class is a bump allocator handing out aligned blocks from large chunks which are freed all at once.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#pragma once
+
+#include <DataRepresentation/Export.h>
+#include <DataRepresentation/System.h>
+#include <QVector>
+#include <QMutex>
+#include <cstddef>
+
+namespace lpmldata
+{
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Arena allocator for the buffers of tables which live and die together, e.g. a table loaded from a file.
+*
+* \details Blocks are carved out of 64 byte aligned chunks allocated with aligned_malloc, so every block is 64 byte aligned.
+* Blocks are never freed one by one, all chunks are released by clear() or by the destructor. A block larger than a quarter
+* of the chunk size gets a chunk of its own. Allocation is thread-safe.
+*/
+class DataRepresentation_API Arena
+{
+
+public:
+	/*!
+	* \brief Constructor.
+	* \param [in] aChunkSize The size of the chunks in bytes.
+	*/
+	Arena( size_t aChunkSize = kDefaultChunkSize );
+
+	/*!
+	* \brief Destructor, frees every chunk.
+	*/
+	~Arena();
+
+	/*!
+	* \brief Returns with a 64 byte aligned block of at least the given size. The block lives as long as the arena.
+	*/
+	void* allocate( size_t aSize );
+
+	/*!
+	* \brief Frees every chunk at once. Blocks allocated before must not be used anymore.
+	*/
+	void clear();
+
+	/*!
+	* \brief Returns with the number of bytes handed out, including the alignment padding.
+	*/
+	size_t size() const;
+
+	/*!
+	* \brief Returns with the number of bytes allocated from the system.
+	*/
+	size_t capacity() const;
+
+	static const size_t kDefaultChunkSize = size_t( 4 ) << 20;
+	static const size_t kAlignment        = 64;
+
+private:
+	Arena( const Arena& ) = delete;
+
+	Arena& operator=( const Arena& ) = delete;
+
+private:
+	mutable QMutex     mMutex;       //!< Guards the chunks and the bump pointer.
+	QVector< char* >   mChunks;      //!< The chunks allocated from the system.
+	size_t             mChunkSize;   //!< The size of a regular chunk in bytes.
+	char*              mCurrent;     //!< The next free byte of the current chunk.
+	size_t             mRemaining;   //!< The number of free bytes in the current chunk.
+	size_t             mSize;        //!< The number of bytes handed out.
+	size_t             mCapacity;    //!< The number of bytes allocated from the system.
+
+};
+
+//-----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,123 @@
+/*!
+* \file This file is part of Datarepresentation module.
+* The ColumnView class is a lightweight, non-owning view over the values of a column.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#pragma once
+
+#include <DataRepresentation/Types.h>
+#include <iterator>
+
+namespace lpmldata
+{
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Non-owning strided view over column values.
+*
+* \details The view does not allocate, it refers to the storage of the column it was taken from. It is invalidated by any
+* modification of that column (insert, remove, type promotion), and by destroying the owning table. Element i of a view taken
+* from a TabularData belongs to the row with index i, that is to keys().at( i ).
+*/
+template< typename T >
+class ColumnView
+{
+
+public:
+	/*!
+	* \brief Random access iterator over the view.
+	*/
+	class const_iterator
+	{
+
+	public:
+		typedef std::random_access_iterator_tag  iterator_category;
+		typedef T                                value_type;
+		typedef lint                             difference_type;
+		typedef const T*                         pointer;
+		typedef const T&                         reference;
+
+		const_iterator() : mPointer( nullptr ), mStride( 1 ) {}
+		const_iterator( const T* aPointer, int aStride ) : mPointer( aPointer ), mStride( aStride ) {}
+
+		reference operator*() const { return *mPointer; }
+		pointer operator->() const { return mPointer; }
+		reference operator[]( difference_type aOffset ) const { return mPointer[ aOffset * mStride ]; }
+
+		const_iterator& operator++() { mPointer += mStride; return *this; }
+		const_iterator operator++( int ) { const_iterator previous = *this; mPointer += mStride; return previous; }
+		const_iterator& operator--() { mPointer -= mStride; return *this; }
+		const_iterator operator--( int ) { const_iterator previous = *this; mPointer -= mStride; return previous; }
+		const_iterator& operator+=( difference_type aOffset ) { mPointer += aOffset * mStride; return *this; }
+		const_iterator& operator-=( difference_type aOffset ) { mPointer -= aOffset * mStride; return *this; }
+		const_iterator operator+( difference_type aOffset ) const { return const_iterator( mPointer + aOffset * mStride, mStride ); }
+		const_iterator operator-( difference_type aOffset ) const { return const_iterator( mPointer - aOffset * mStride, mStride ); }
+		difference_type operator-( const const_iterator& aOther ) const { return ( mPointer - aOther.mPointer ) / mStride; }
+
+		bool operator==( const const_iterator& aOther ) const { return mPointer == aOther.mPointer; }
+		bool operator!=( const const_iterator& aOther ) const { return mPointer != aOther.mPointer; }
+		bool operator<( const const_iterator& aOther ) const { return mPointer < aOther.mPointer; }
+
+	private:
+		const T*  mPointer;   //!< The current element.
+		int       mStride;    //!< Distance of two consecutive elements in number of T.
+
+	};
+
+	/*!
+	* \brief Default constructor, creates an empty view.
+	*/
+	ColumnView() : mData( nullptr ), mSize( 0 ), mStride( 1 ) {}
+
+	/*!
+	* \brief Constructor.
+	* \param [in] aData Pointer to the first element.
+	* \param [in] aSize Number of elements.
+	* \param [in] aStride Distance of two consecutive elements in number of T.
+	*/
+	ColumnView( const T* aData, int aSize, int aStride = 1 ) : mData( aData ), mSize( aData == nullptr ? 0 : aSize ), mStride( aStride ) {}
+
+	int size() const { return mSize; }
+
+	bool isEmpty() const { return mSize == 0; }
+
+	int stride() const { return mStride; }
+
+	/*!
+	* \brief Returns true if the elements are adjacent in memory, thus data() can be used as a plain array.
+	*/
+	bool isContiguous() const { return mStride == 1; }
+
+	const T* data() const { return mData; }
+
+	const T& operator[]( int aIndex ) const { return mData[ lint( aIndex ) * mStride ]; }
+
+	const T& at( int aIndex ) const { return mData[ lint( aIndex ) * mStride ]; }
+
+	const_iterator begin() const { return const_iterator( mData, mStride ); }
+
+	const_iterator end() const { return const_iterator( mData + lint( mSize ) * mStride, mStride ); }
+
+	/*!
+	* \brief Returns with a view of a contiguous range of the elements.
+	* \param [in] aStart Index of the first element of the range.
+	* \param [in] aCount Number of elements in the range.
+	*/
+	ColumnView mid( int aStart, int aCount ) const { return ColumnView( mData + lint( aStart ) * mStride, aCount, mStride ); }
+
+private:
+	const T*  mData;     //!< The first element.
+	int       mSize;     //!< The number of elements.
+	int       mStride;   //!< Distance of two consecutive elements in number of T.
+
+};
+
+//-----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,477 @@
+/*!
+* \file
+* Function definitions of the number formatter. This file is part of DataRepresentation module.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#include <DataRepresentation/NumberFormatter.h>
+#include <DataRepresentation/System.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#if defined( CC_MSVC )
+#include <intrin.h>
+#endif
+
+namespace lpmldata
+{
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+const int kMantissaBits        = 52;
+const int kExponentBias        = 1023;
+const int kPowerBits           = 125;   //!< The bits of the approximations of the powers of five and their inverses.
+const int kPowerCount          = 326;   //!< The powers of five 5^0 to 5^325.
+const int kInversePowerCount   = 342;   //!< The inverse powers of five 5^0 to 5^-341.
+const int kMinPlainExponent    = -5;    //!< The smallest decimal exponent written without an exponent, 0.00001.
+const int kMaxPlainExponent    = 16;    //!< The largest decimal exponent written without an exponent, 10000000000000000.
+
+struct UInt128
+{
+	quint64 high;
+	quint64 low;
+};
+
+UInt128 multiply( quint64 aFirst, quint64 aSecond )
+{
+	UInt128 product;
+#if defined( CC_MSVC )
+	product.low = _umul128( aFirst, aSecond, &product.high );
+#else
+	unsigned __int128 wide = static_cast< unsigned __int128 >( aFirst ) * aSecond;
+	product.high = quint64( wide >> 64 );
+	product.low  = quint64( wide );
+#endif
+	return product;
+}
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Unsigned big integer of 32 bit words, least significant first; just enough arithmetic to build the power tables.
+*/
+typedef std::vector< quint32 > BigInteger;
+
+int bitLength( const BigInteger& aValue )
+{
+	for ( int wordIndex = int( aValue.size() ) - 1; wordIndex >= 0; --wordIndex )
+	{
+		for ( int bit = 31; bit >= 0; --bit )
+		{
+			if ( ( aValue[ wordIndex ] >> bit ) & 1 ) return wordIndex * 32 + bit + 1;
+		}
+	}
+
+	return 0;
+}
+
+/*!
+* \brief Returns with the 128 bits of aValue from aLowestBit up, a negative aLowestBit shifts the value up.
+*/
+UInt128 bitsFrom( const BigInteger& aValue, int aLowestBit )
+{
+	UInt128 result = { 0, 0 };
+	for ( int bit = 0; bit < 128; ++bit )
+	{
+		int sourceBit = aLowestBit + bit;
+		if ( sourceBit < 0 || sourceBit / 32 >= int( aValue.size() ) || ( ( aValue[ sourceBit / 32 ] >> ( sourceBit % 32 ) ) & 1 ) == 0 ) continue;
+		if ( bit < 64 ) result.low |= quint64( 1 ) << bit;
+		else result.high |= quint64( 1 ) << ( bit - 64 );
+	}
+
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief The 125 most significant bits of 5^i and floor( 2^( bitLength( 5^i ) - 1 + 125 ) / 5^i ) + 1 of Ryu.
+*/
+class PowerTables
+{
+
+public:
+	PowerTables()
+	{
+		const int kDividendBits = 1024;  // Above the largest numerator, bitLength( 5^341 ) - 1 + 125.
+
+		BigInteger power( 1, 1 );
+		BigInteger reciprocal( kDividendBits / 32 + 1, 0 );
+		reciprocal.back() = 1;  // 2^kDividendBits.
+
+		for ( int exponent = 0; exponent < kInversePowerCount; ++exponent )
+		{
+			int powerBits = bitLength( power );
+			if ( exponent < kPowerCount )
+			{
+				mPowers[ exponent ] = bitsFrom( power, powerBits - kPowerBits );
+			}
+
+			// floor( floor( 2^K / 5^i ) / 2^( K - j ) ) = floor( 2^j / 5^i ).
+			UInt128& inverse = mInversePowers[ exponent ];
+			inverse = bitsFrom( reciprocal, kDividendBits - ( powerBits - 1 + kPowerBits ) );
+			inverse.high += ++inverse.low == 0 ? 1 : 0;
+
+			quint64 carry = 0;
+			for ( quint32& word : power )
+			{
+				carry += quint64( word ) * 5;
+				word = quint32( carry );
+				carry >>= 32;
+			}
+
+			if ( carry != 0 ) power.push_back( quint32( carry ) );
+
+			quint64 remainder = 0;
+			for ( int wordIndex = int( reciprocal.size() ) - 1; wordIndex >= 0; --wordIndex )
+			{
+				remainder = ( remainder << 32 ) | reciprocal[ wordIndex ];
+				reciprocal[ wordIndex ] = quint32( remainder / 5 );
+				remainder %= 5;
+			}
+		}
+	}
+
+	const UInt128& power( int aExponent ) const { return mPowers[ aExponent ]; }
+	const UInt128& inversePower( int aExponent ) const { return mInversePowers[ aExponent ]; }
+
+private:
+	UInt128 mPowers[ kPowerCount ];                 //!< 5^i, the top 125 bits.
+	UInt128 mInversePowers[ kInversePowerCount ];   //!< 5^-i scaled to 125 bits, rounded up.
+
+};
+
+const PowerTables& powerTables()
+{
+	static const PowerTables tables;
+	return tables;
+}
+
+//-----------------------------------------------------------------------------
+
+int log10Pow2( int aExponent ) { return int( ( quint32( aExponent ) * 78913 ) >> 18 ); }
+int log10Pow5( int aExponent ) { return int( ( quint32( aExponent ) * 732923 ) >> 20 ); }
+int pow5Bits( int aExponent ) { return int( ( quint32( aExponent ) * 1217359 ) >> 19 ) + 1; }
+
+bool isMultipleOfPowerOf5( quint64 aValue, int aExponent )
+{
+	int count = 0;
+	while ( aValue % 5 == 0 && aValue != 0 )
+	{
+		aValue /= 5;
+		++count;
+	}
+
+	return count >= aExponent;
+}
+
+bool isMultipleOfPowerOf2( quint64 aValue, int aExponent )
+{
+	return ( aValue & ( ( quint64( 1 ) << aExponent ) - 1 ) ) == 0;
+}
+
+/*!
+* \brief Returns with ( aValue * aFactor ) >> aShift, where aValue has at most 55 bits and 64 < aShift < 128.
+*/
+quint64 multiplyShift( quint64 aValue, const UInt128& aFactor, int aShift )
+{
+	UInt128 low = multiply( aValue, aFactor.low );
+	UInt128 high = multiply( aValue, aFactor.high );
+	quint64 sum = low.high + high.low;
+	quint64 top = high.high + ( sum < low.high ? 1 : 0 );
+	int distance = aShift - 64;
+	return ( top << ( 64 - distance ) ) | ( sum >> distance );
+}
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Ryu: the shortest decimal aDigits * 10^aExponent in the rounding interval of a finite, positive double, the one
+* closest to it if there are several.
+*/
+void shortestDecimal( quint64 aMantissa, int aBiasedExponent, quint64& aDigits, int& aExponent )
+{
+	int exponent2 = 0;
+	quint64 mantissa = 0;
+	if ( aBiasedExponent == 0 )
+	{
+		exponent2 = 1 - kExponentBias - kMantissaBits - 2;
+		mantissa = aMantissa;
+	}
+	else
+	{
+		exponent2 = aBiasedExponent - kExponentBias - kMantissaBits - 2;
+		mantissa = ( quint64( 1 ) << kMantissaBits ) | aMantissa;
+	}
+
+	// The interval of the values rounding to the double is [ mm, mp ] around mv, scaled by 4.
+	bool acceptBounds = ( mantissa & 1 ) == 0;
+	quint64 mv = 4 * mantissa;
+	quint32 mmShift = aMantissa != 0 || aBiasedExponent <= 1 ? 1 : 0;
+
+	quint64 vr = 0;
+	quint64 vp = 0;
+	quint64 vm = 0;
+	int exponent10 = 0;
+	bool isVmTrailingZeros = false;
+	bool isVrTrailingZeros = false;
+
+	if ( exponent2 >= 0 )
+	{
+		int q = log10Pow2( exponent2 ) - ( exponent2 > 3 ? 1 : 0 );
+		exponent10 = q;
+		int k = kPowerBits + pow5Bits( q ) - 1;
+		int i = -exponent2 + q + k;
+		const UInt128& factor = powerTables().inversePower( q );
+		vr = multiplyShift( 4 * mantissa, factor, i );
+		vp = multiplyShift( 4 * mantissa + 2, factor, i );
+		vm = multiplyShift( 4 * mantissa - 1 - mmShift, factor, i );
+
+		if ( q <= 21 )
+		{
+			// Only one of mp, mv and mm can be a multiple of 5, if any.
+			if ( mv % 5 == 0 )
+			{
+				isVrTrailingZeros = isMultipleOfPowerOf5( mv, q );
+			}
+			else if ( acceptBounds )
+			{
+				isVmTrailingZeros = isMultipleOfPowerOf5( mv - 1 - mmShift, q );
+			}
+			else
+			{
+				vp -= isMultipleOfPowerOf5( mv + 2, q ) ? 1 : 0;
+			}
+		}
+	}
+	else
+	{
+		int q = log10Pow5( -exponent2 ) - ( -exponent2 > 1 ? 1 : 0 );
+		exponent10 = q + exponent2;
+		int i = -exponent2 - q;
+		int k = pow5Bits( i ) - kPowerBits;
+		int j = q - k;
+		const UInt128& factor = powerTables().power( i );
+		vr = multiplyShift( 4 * mantissa, factor, j );
+		vp = multiplyShift( 4 * mantissa + 2, factor, j );
+		vm = multiplyShift( 4 * mantissa - 1 - mmShift, factor, j );
+
+		if ( q <= 1 )
+		{
+			// mv = 4 * m2 has at least two trailing zero bits, mm has one if mmShift is 1.
+			isVrTrailingZeros = true;
+			if ( acceptBounds )
+			{
+				isVmTrailingZeros = mmShift == 1;
+			}
+			else
+			{
+				--vp;
+			}
+		}
+		else if ( q < 63 )
+		{
+			isVrTrailingZeros = isMultipleOfPowerOf2( mv, q );
+		}
+	}
+
+	// Remove digits while the interval still contains a shorter decimal.
+	int removed = 0;
+	quint64 output = 0;
+	if ( isVmTrailingZeros || isVrTrailingZeros )
+	{
+		// The exact value or the lower bound may end in zeros, which happens rarely.
+		int lastRemovedDigit = 0;
+		while ( vp / 10 > vm / 10 )
+		{
+			isVmTrailingZeros &= vm % 10 == 0;
+			isVrTrailingZeros &= lastRemovedDigit == 0;
+			lastRemovedDigit = int( vr % 10 );
+			vr /= 10;
+			vp /= 10;
+			vm /= 10;
+			++removed;
+		}
+
+		if ( isVmTrailingZeros )
+		{
+			while ( vm % 10 == 0 )
+			{
+				isVrTrailingZeros &= lastRemovedDigit == 0;
+				lastRemovedDigit = int( vr % 10 );
+				vr /= 10;
+				vp /= 10;
+				vm /= 10;
+				++removed;
+			}
+		}
+
+		if ( isVrTrailingZeros && lastRemovedDigit == 5 && vr % 2 == 0 )
+		{
+			lastRemovedDigit = 4;  // Round to even if the exact value ends in 50..0.
+		}
+
+		output = vr + ( ( vr == vm && ( !acceptBounds || !isVmTrailingZeros ) ) || lastRemovedDigit >= 5 ? 1 : 0 );
+	}
+	else
+	{
+		bool isRoundedUp = false;
+		if ( vp / 100 > vm / 100 )
+		{
+			isRoundedUp = vr % 100 >= 50;
+			vr /= 100;
+			vp /= 100;
+			vm /= 100;
+			removed += 2;
+		}
+
+		while ( vp / 10 > vm / 10 )
+		{
+			isRoundedUp = vr % 10 >= 5;
+			vr /= 10;
+			vp /= 10;
+			vm /= 10;
+			++removed;
+		}
+
+		output = vr + ( vr == vm || isRoundedUp ? 1 : 0 );
+	}
+
+	aExponent = exponent10 + removed;
+	while ( output % 10 == 0 && output != 0 )
+	{
+		output /= 10;
+		++aExponent;
+	}
+
+	aDigits = output;
+}
+
+/*!
+* \brief Writes the decimal digits of a number, returns with their count.
+*/
+int writeDigits( quint64 aValue, char* aBuffer )
+{
+	char digits[ 20 ];
+	int count = 0;
+	do
+	{
+		digits[ count++ ] = char( '0' + aValue % 10 );
+		aValue /= 10;
+	}
+	while ( aValue != 0 );
+
+	for ( int index = 0; index < count; ++index )
+	{
+		aBuffer[ index ] = digits[ count - 1 - index ];
+	}
+
+	return count;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+
+int formatDouble( double aValue, char* aBuffer )
+{
+	quint64 bits = 0;
+	std::memcpy( &bits, &aValue, sizeof( bits ) );
+	bool isNegative = ( bits >> 63 ) != 0;
+	quint64 mantissa = bits & ( ( quint64( 1 ) << kMantissaBits ) - 1 );
+	int biasedExponent = int( ( bits >> kMantissaBits ) & 0x7FF );
+
+	char* position = aBuffer;
+	if ( biasedExponent == 0x7FF )
+	{
+		if ( mantissa != 0 )
+		{
+			std::memcpy( aBuffer, "nan", 3 );
+			return 3;
+		}
+
+		if ( isNegative ) *position++ = '-';
+		std::memcpy( position, "inf", 3 );
+		return int( position - aBuffer ) + 3;
+	}
+
+	if ( isNegative ) *position++ = '-';
+	if ( biasedExponent == 0 && mantissa == 0 )
+	{
+		*position++ = '0';
+		return int( position - aBuffer );
+	}
+
+	quint64 digits = 0;
+	int exponent = 0;
+	shortestDecimal( mantissa, biasedExponent, digits, exponent );
+
+	char text[ 20 ];
+	int digitCount = writeDigits( digits, text );
+	int scientificExponent = exponent + digitCount - 1;
+
+	if ( scientificExponent < kMinPlainExponent || scientificExponent > kMaxPlainExponent )
+	{
+		// d.ddde+XX
+		*position++ = text[ 0 ];
+		if ( digitCount > 1 )
+		{
+			*position++ = '.';
+			std::memcpy( position, text + 1, size_t( digitCount - 1 ) );
+			position += digitCount - 1;
+		}
+
+		*position++ = 'e';
+		*position++ = scientificExponent < 0 ? '-' : '+';
+		int magnitude = scientificExponent < 0 ? -scientificExponent : scientificExponent;
+		if ( magnitude < 10 ) *position++ = '0';
+		position += writeDigits( quint64( magnitude ), position );
+	}
+	else if ( scientificExponent >= 0 )
+	{
+		// ddd.ddd or ddd00, the point falls inside or behind the digits.
+		int integerCount = scientificExponent + 1;
+		int integerDigitCount = std::min( integerCount, digitCount );
+		std::memcpy( position, text, size_t( integerDigitCount ) );
+		position += integerDigitCount;
+		for ( int zero = integerDigitCount; zero < integerCount; ++zero ) *position++ = '0';
+		if ( digitCount > integerCount )
+		{
+			*position++ = '.';
+			std::memcpy( position, text + integerCount, size_t( digitCount - integerCount ) );
+			position += digitCount - integerCount;
+		}
+	}
+	else
+	{
+		// 0.000ddd
+		*position++ = '0';
+		*position++ = '.';
+		for ( int zero = 1; zero < -scientificExponent; ++zero ) *position++ = '0';
+		std::memcpy( position, text, size_t( digitCount ) );
+		position += digitCount;
+	}
+
+	return int( position - aBuffer );
+}
+
+//-----------------------------------------------------------------------------
+
+int formatInteger( qint64 aValue, char* aBuffer )
+{
+	if ( aValue >= 0 ) return writeDigits( quint64( aValue ), aBuffer );
+
+	aBuffer[ 0 ] = '-';
+	return 1 + writeDigits( quint64( 0 ) - quint64( aValue ), aBuffer + 1 );
+}
+
+//-----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,45 @@
+/*!
+* \file This file is part of Datarepresentation module.
+* Locale-independent, allocation-free formatting of numbers into UTF-8 text, e.g. the fields of a CSV file.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#pragma once
+
+#include <DataRepresentation/Export.h>
+#include <QtGlobal>
+
+namespace lpmldata
+{
+
+//-----------------------------------------------------------------------------
+
+const int kNumberTextCapacity = 32;   //!< The buffer size which holds every formatted number.
+
+/*!
+* \brief Formats a double with the fewest significant digits which parse back to the same double (Ryu).
+*
+* \details The layout is plain if the decimal exponent is in [ -5, 16 ], as the cells of TabularDataColumn::toString, and
+* exponential otherwise, with a sign and at least two exponent digits, e.g. 0.001, 123.5, 100000, 1e+17, 2.5e-07.
+* Infinities and NaN are written as inf, -inf and nan.
+* \param [in] aValue The number to format.
+* \param [out] aBuffer At least kNumberTextCapacity bytes, the text is not null-terminated.
+* \return The size of the text in bytes.
+*/
+DataRepresentation_API int formatDouble( double aValue, char* aBuffer );
+
+/*!
+* \brief Formats a 64 bit integer in decimal.
+* \param [in] aValue The number to format.
+* \param [out] aBuffer At least kNumberTextCapacity bytes, the text is not null-terminated.
+* \return The size of the text in bytes.
+*/
+DataRepresentation_API int formatInteger( qint64 aValue, char* aBuffer );
+
+//-----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,374 @@
+/*!
+* \file
+* Function definitions of the number parser. This file is part of DataRepresentation module.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#include <DataRepresentation/NumberParser.h>
+#include <DataRepresentation/System.h>
+#include <QString>
+#include <cstring>
+#include <vector>
+#if defined( CC_MSVC )
+#include <intrin.h>
+#endif
+
+namespace lpmldata
+{
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+const int kSmallestPowerOfTen = -342;   //!< Below it every significand of 19 digits rounds to zero.
+const int kLargestPowerOfTen  = 308;    //!< Above it every nonzero significand overflows.
+const int kMaximumDigitCount  = 19;     //!< The number of significant digits which always fit into 64 bits.
+
+const double kExactPowersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                     1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+struct UInt128
+{
+	quint64 high;
+	quint64 low;
+};
+
+UInt128 multiply( quint64 aFirst, quint64 aSecond )
+{
+	UInt128 product;
+#if defined( CC_MSVC )
+	product.low = _umul128( aFirst, aSecond, &product.high );
+#else
+	unsigned __int128 wide = static_cast< unsigned __int128 >( aFirst ) * aSecond;
+	product.high = quint64( wide >> 64 );
+	product.low  = quint64( wide );
+#endif
+	return product;
+}
+
+int leadingZeroCount( quint64 aValue )
+{
+#if defined( CC_MSVC )
+	unsigned long index = 0;
+	_BitScanReverse64( &index, aValue );
+	return 63 - int( index );
+#else
+	return __builtin_clzll( aValue );
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Unsigned big integer of 32 bit words, least significant first; just enough arithmetic to build the power table.
+*/
+typedef std::vector< quint32 > BigInteger;
+
+int bitLength( const BigInteger& aValue )
+{
+	for ( int wordIndex = int( aValue.size() ) - 1; wordIndex >= 0; --wordIndex )
+	{
+		if ( aValue[ wordIndex ] != 0 ) return wordIndex * 32 + 64 - leadingZeroCount( aValue[ wordIndex ] );
+	}
+
+	return 0;
+}
+
+bool bitAt( const BigInteger& aValue, int aBit )
+{
+	return aBit >= 0 && aBit / 32 < int( aValue.size() ) && ( ( aValue[ aBit / 32 ] >> ( aBit % 32 ) ) & 1 ) != 0;
+}
+
+void multiplyBy( BigInteger& aValue, quint32 aFactor )
+{
+	quint64 carry = 0;
+	for ( quint32& word : aValue )
+	{
+		carry += quint64( word ) * aFactor;
+		word = quint32( carry );
+		carry >>= 32;
+	}
+
+	if ( carry != 0 ) aValue.push_back( quint32( carry ) );
+}
+
+void divideBy( BigInteger& aValue, quint32 aDivisor )
+{
+	quint64 remainder = 0;
+	for ( int wordIndex = int( aValue.size() ) - 1; wordIndex >= 0; --wordIndex )
+	{
+		remainder = ( remainder << 32 ) | aValue[ wordIndex ];
+		aValue[ wordIndex ] = quint32( remainder / aDivisor );
+		remainder %= aDivisor;
+	}
+}
+
+/*!
+* \brief Returns with the 128 bits of floor( aValue / 2^aShift ) + aIncrement, truncated to its 128 most significant bits.
+* A value shorter than 128 bits is shifted up to 128 bits.
+*/
+UInt128 mostSignificantBits( const BigInteger& aValue, int aShift, quint32 aIncrement )
+{
+	BigInteger value( aValue.size(), 0 );
+	for ( int bit = 0; bit + aShift < int( aValue.size() ) * 32; ++bit )
+	{
+		if ( bitAt( aValue, bit + aShift ) ) value[ bit / 32 ] |= quint32( 1 ) << ( bit % 32 );
+	}
+
+	value.push_back( 0 );
+	quint64 carry = aIncrement;
+	for ( quint32& word : value )
+	{
+		carry += word;
+		word = quint32( carry );
+		carry >>= 32;
+	}
+
+	int lowestBit = bitLength( value ) - 128;
+	UInt128 result = { 0, 0 };
+	for ( int bit = 0; bit < 128; ++bit )
+	{
+		if ( !bitAt( value, lowestBit + bit ) ) continue;
+		if ( bit < 64 ) result.low |= quint64( 1 ) << bit;
+		else result.high |= quint64( 1 ) << ( bit - 64 );
+	}
+
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief 128 bit approximations of the powers of five from 5^-342 to 5^308, normalized so that the top bit is set.
+* \details The positive powers are truncated. The negative ones are floor( 2^b / 5^-q ) + 1 with b chosen so that the
+* quotient has at least 128 bits, then truncated; for 5^-q < 2^64 the 128 bits are enough for the exact result.
+*/
+class PowersOfFive
+{
+
+public:
+	PowersOfFive()
+	{
+		const int kDividendBits = 2048;  // Above the largest b, 2 * 795 + 128.
+
+		BigInteger power( 1, 1 );
+		BigInteger reciprocal( kDividendBits / 32 + 1, 0 );
+		reciprocal.back() = 1;  // 2^kDividendBits.
+
+		at( 0 ) = mostSignificantBits( power, 0, 0 );
+
+		for ( int exponent = 1; exponent <= -kSmallestPowerOfTen; ++exponent )
+		{
+			multiplyBy( power, 5 );
+			divideBy( reciprocal, 5 );  // floor( floor( x / 5^( n - 1 ) ) / 5 ) = floor( x / 5^n ).
+
+			if ( exponent <= kLargestPowerOfTen )
+			{
+				at( exponent ) = mostSignificantBits( power, 0, 0 );
+			}
+
+			int powerBits = bitLength( power );
+			int quotientBits = exponent <= 27 ? powerBits + 127 : 2 * powerBits + 128;
+			at( -exponent ) = mostSignificantBits( reciprocal, kDividendBits - quotientBits, 1 );
+		}
+	}
+
+	const UInt128& operator[]( int aExponent ) const { return mPowers[ aExponent - kSmallestPowerOfTen ]; }
+
+private:
+	UInt128& at( int aExponent ) { return mPowers[ aExponent - kSmallestPowerOfTen ]; }
+
+	UInt128 mPowers[ kLargestPowerOfTen - kSmallestPowerOfTen + 1 ];   //!< The power of five of each decimal exponent.
+
+};
+
+const PowersOfFive& powersOfFive()
+{
+	static const PowersOfFive powers;
+	return powers;
+}
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Eisel-Lemire: rounds aSignificand * 10^aExponent to the nearest double.
+* \return False if the result is subnormal, out of range or the approximation cannot decide the rounding.
+*/
+bool computeDouble( quint64 aSignificand, int aExponent, bool aIsNegative, double& aValue )
+{
+	if ( aExponent < kSmallestPowerOfTen || aExponent > kLargestPowerOfTen ) return false;
+
+	int leadingZeros = leadingZeroCount( aSignificand );
+	quint64 significand = aSignificand << leadingZeros;
+
+	const UInt128& power = powersOfFive()[ aExponent ];
+	UInt128 product = multiply( significand, power.high );
+
+	// Only the top 55 bits are needed; the lower half of the power matters if the bits below them are all set.
+	const quint64 precisionMask = ~quint64( 0 ) >> 55;
+	if ( ( product.high & precisionMask ) == precisionMask )
+	{
+		UInt128 lowProduct = multiply( significand, power.low );
+		product.low += lowProduct.high;
+		if ( lowProduct.high > product.low ) ++product.high;
+
+		if ( product.low == ~quint64( 0 ) && ( aExponent < -27 || aExponent > 55 ) ) return false;
+	}
+
+	int upperBit = int( product.high >> 63 );
+	int shift = upperBit + 64 - 52 - 3;
+	quint64 mantissa = product.high >> shift;
+	int binaryExponent = ( ( ( 152170 + 65536 ) * aExponent ) >> 16 ) + 63 + upperBit - leadingZeros + 1023;
+
+	if ( binaryExponent <= 0 ) return false;  // Subnormal.
+
+	// Exactly halfway between two doubles: round to even instead of up.
+	if ( product.low <= 1 && aExponent >= -4 && aExponent <= 23 && ( mantissa & 3 ) == 1 && ( mantissa << shift ) == product.high )
+	{
+		mantissa &= ~quint64( 1 );
+	}
+
+	mantissa += mantissa & 1;
+	mantissa >>= 1;
+	if ( mantissa >= ( quint64( 2 ) << 52 ) )
+	{
+		mantissa = quint64( 1 ) << 52;
+		++binaryExponent;
+	}
+
+	if ( binaryExponent >= 0x7FF ) return false;  // Overflow.
+
+	quint64 bits = ( mantissa & ~( quint64( 1 ) << 52 ) ) | ( quint64( binaryExponent ) << 52 ) | ( aIsNegative ? quint64( 1 ) << 63 : 0 );
+	std::memcpy( &aValue, &bits, sizeof( double ) );
+	return true;
+}
+
+bool isDigit( char aCharacter )
+{
+	return aCharacter >= '0' && aCharacter <= '9';
+}
+
+}
+
+//-----------------------------------------------------------------------------
+
+bool parseDouble( const char* aText, int aSize, double& aValue )
+{
+	const char* position = aText;
+	const char* end = aText + aSize;
+
+	bool isNegative = position < end && *position == '-';
+	if ( position < end && ( *position == '-' || *position == '+' ) ) ++position;
+
+	quint64 significand = 0;
+	int digitCount = 0;      // Significant digits, without the leading zeros.
+	int exponent = 0;
+	bool hasDigits = false;
+
+	for ( ; position < end && isDigit( *position ); ++position )
+	{
+		hasDigits = true;
+		if ( digitCount == 0 && *position == '0' ) continue;
+
+		significand = significand * 10 + quint64( *position - '0' );
+		++digitCount;
+	}
+
+	if ( position < end && *position == '.' )
+	{
+		for ( ++position; position < end && isDigit( *position ); ++position )
+		{
+			hasDigits = true;
+			--exponent;
+			if ( digitCount == 0 && *position == '0' ) continue;
+
+			significand = significand * 10 + quint64( *position - '0' );
+			++digitCount;
+		}
+	}
+
+	bool isPlain = hasDigits && digitCount <= kMaximumDigitCount;
+
+	if ( isPlain && position < end && ( *position | 0x20 ) == 'e' )
+	{
+		++position;
+		bool isExponentNegative = position < end && *position == '-';
+		if ( position < end && ( *position == '-' || *position == '+' ) ) ++position;
+
+		int exponentValue = 0;
+		isPlain = position < end && isDigit( *position );
+		for ( ; position < end && isDigit( *position ); ++position )
+		{
+			if ( exponentValue < 100000 ) exponentValue = exponentValue * 10 + ( *position - '0' );
+		}
+
+		exponent += isExponentNegative ? -exponentValue : exponentValue;
+	}
+
+	if ( isPlain && position == end )
+	{
+		if ( significand == 0 )
+		{
+			aValue = isNegative ? -0.0 : 0.0;
+			return true;
+		}
+
+		// Clinger: both the significand and the power of ten are exact doubles, so is the correctly rounded product.
+		if ( exponent >= -22 && exponent <= 22 && significand <= ( quint64( 1 ) << 53 ) )
+		{
+			double value = double( significand );
+			value = exponent < 0 ? value / kExactPowersOfTen[ -exponent ] : value * kExactPowersOfTen[ exponent ];
+			aValue = isNegative ? -value : value;
+			return true;
+		}
+
+		if ( computeDouble( significand, exponent, isNegative, aValue ) ) return true;
+	}
+
+	// Everything else is left to Qt.
+	bool isNumber = false;
+	double value = QString::fromUtf8( aText, aSize ).toDouble( &isNumber );
+	if ( isNumber ) aValue = value;
+	return isNumber;
+}
+
+//-----------------------------------------------------------------------------
+
+bool parseInteger( const char* aText, int aSize, qint64& aValue )
+{
+	const char* position = aText;
+	const char* end = aText + aSize;
+
+	bool isNegative = position < end && *position == '-';
+	if ( position < end && ( *position == '-' || *position == '+' ) ) ++position;
+
+	// 18 digits never overflow.
+	if ( position < end && end - position <= 18 )
+	{
+		qint64 value = 0;
+		for ( ; position < end && isDigit( *position ); ++position )
+		{
+			value = value * 10 + ( *position - '0' );
+		}
+
+		if ( position == end )
+		{
+			aValue = isNegative ? -value : value;
+			return true;
+		}
+	}
+
+	bool isNumber = false;
+	qint64 value = QString::fromUtf8( aText, aSize ).toLongLong( &isNumber );
+	if ( isNumber ) aValue = value;
+	return isNumber;
+}
+
+//-----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,47 @@
+/*!
+* \file This file is part of Datarepresentation module.
+* Locale-independent, allocation-free parsing of decimal numbers from UTF-8 text, e.g. the fields of a CSV file.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#pragma once
+
+#include <DataRepresentation/Export.h>
+#include <QtGlobal>
+
+namespace lpmldata
+{
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Parses a decimal floating point number, rounding it correctly (to nearest, ties to even).
+*
+* \details Plain numbers of the form [+-]digits[.digits][(e|E)[+-]digits] with at most 19 significant digits are parsed
+* without allocating: exactly in double arithmetic if the significand and the power of ten fit into a double (Clinger),
+* otherwise by the Eisel-Lemire algorithm with 128 bit approximations of the powers of five. Every other text (surrounding
+* spaces, inf, more digits, results out of the normal range) goes through QString::toDouble, so the accepted texts and the
+* results are the same as that of QString::toDouble in every case.
+* \param [in] aText The text, not necessarily null-terminated.
+* \param [in] aSize The size of the text in bytes.
+* \param [out] aValue The parsed number, untouched if the text is not a number.
+* \return True if the text is a number.
+*/
+DataRepresentation_API bool parseDouble( const char* aText, int aSize, double& aValue );
+
+/*!
+* \brief Parses a decimal 64 bit integer the way QString::toLongLong does, plain [+-]digits text without allocating.
+* \param [in] aText The text, not necessarily null-terminated.
+* \param [in] aSize The size of the text in bytes.
+* \param [out] aValue The parsed number, untouched if the text is not an integer.
+* \return True if the text is an integer which fits into 64 bits.
+*/
+DataRepresentation_API bool parseInteger( const char* aText, int aSize, qint64& aValue );
+
+//-----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,72 @@
+/*!
+* \file
+* Member function definitions for SymbolPool class. This file is part of DataRepresentation module.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#include <DataRepresentation/SymbolPool.h>
+
+namespace lpmldata
+{
+
+//-----------------------------------------------------------------------------
+
+SymbolPool::SymbolPool()
+:
+	mData( new SymbolPoolData )
+{
+}
+
+//-----------------------------------------------------------------------------
+
+SymbolPool::SymbolPool( const SymbolPool& aOther )
+:
+	mData( aOther.mData )
+{
+}
+
+//-----------------------------------------------------------------------------
+
+SymbolPool::~SymbolPool()
+{
+}
+
+//-----------------------------------------------------------------------------
+
+SymbolPool& SymbolPool::operator=( const SymbolPool& aOther )
+{
+	mData = aOther.mData;
+	return *this;
+}
+
+//-----------------------------------------------------------------------------
+
+Symbol SymbolPool::intern( const QString& aString )
+{
+	// A string already in the pool is found without detaching a shared pool.
+	const SymbolPoolData* data = mData.constData();
+	auto symbolIt = data->symbols.constFind( aString );
+	if ( symbolIt != data->symbols.constEnd() ) return symbolIt.value();
+
+	Symbol symbol = data->strings.size();
+	mData->symbols.insert( aString, symbol );
+	mData->strings.push_back( aString );
+
+	return symbol;
+}
+
+//-----------------------------------------------------------------------------
+
+void SymbolPool::reserve( int aSize )
+{
+	mData->symbols.reserve( aSize );
+	mData->strings.reserve( aSize );
+}
+
+//-----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,107 @@
+/*!
+* \file This file is part of Datarepresentation module.
+* The SymbolPool class interns strings, e.g. row keys and column names, and identifies them with integer symbols.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#pragma once
+
+#include <DataRepresentation/Export.h>
+#include <QString>
+#include <QHash>
+#include <QVector>
+#include <QSharedData>
+#include <QSharedDataPointer>
+
+namespace lpmldata
+{
+
+//-----------------------------------------------------------------------------
+
+typedef int                            Symbol;
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief The strings of a SymbolPool, shared by its copies.
+*/
+class SymbolPoolData : public QSharedData
+{
+
+public:
+	QHash< QString, Symbol >   symbols;   //!< The symbol of each interned string.
+	QVector< QString >         strings;   //!< The interned strings in symbol order.
+
+};
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief String interning pool. Each distinct string is stored once and gets a dense, non-negative integer symbol.
+*
+* \details The pool is implicitly shared like the Qt containers: copies share the strings until one of them interns a new
+* string, which copies its pool first with the same symbols. The strings are released with the last copy, e.g. with the
+* last table holding the pool of its keys. Symbols of two pools are comparable if the pools are shared, see isSharedWith().
+* Lookups take no lock; like the Qt containers a pool may be read from several threads but not changed concurrently.
+*/
+class DataRepresentation_API SymbolPool
+{
+
+public:
+	/*!
+	* \brief Default constructor, creates an empty pool.
+	*/
+	SymbolPool();
+
+	/*!
+	* \brief Copy constructor, the copy shares the strings of the pool.
+	*/
+	SymbolPool( const SymbolPool& aOther );
+
+	/*!
+	* \brief Destructor.
+	*/
+	~SymbolPool();
+
+	SymbolPool& operator=( const SymbolPool& aOther );
+
+	/*!
+	* \brief Returns with the symbol of the string, the string is added to the pool if it is not yet there.
+	*/
+	Symbol intern( const QString& aString );
+
+	/*!
+	* \brief Returns with the symbol of the string without adding it.
+	* \return The symbol or -1 if the string is not in the pool.
+	*/
+	Symbol find( const QString& aString ) const { return mData->symbols.value( aString, -1 ); }
+
+	/*!
+	* \brief Returns with the interned string of a symbol returned by intern().
+	*/
+	const QString& string( Symbol aSymbol ) const { return mData->strings.at( aSymbol ); }
+
+	int size() const { return mData->strings.size(); }
+
+	/*!
+	* \brief Reserves room for the given number of strings.
+	*/
+	void reserve( int aSize );
+
+	/*!
+	* \brief Returns true if the pools share their strings, i.e. equal symbols of them identify equal strings.
+	*/
+	bool isSharedWith( const SymbolPool& aOther ) const { return mData == aOther.mData; }
+
+private:
+	QSharedDataPointer< lpmldata::SymbolPoolData > mData;   //!< The strings, shared by the copies of the pool.
+
+};
+
+//-----------------------------------------------------------------------------
+
+}
@@ -10,6 +10,8 @@
 
 #include <DataRepresentation/TabularData.h>
 #include <QDebug>
+#include <QPair>
+#include <algorithm>
 
 namespace lpmldata
 {
@@ -18,9 +20,15 @@ namespace lpmldata
 
 TabularData::TabularData()
 	:
-	mTable(),
+	mKeys(),
+	mKeySymbols(),
+	mKeyPool(),
+	mRowIndices(),
+	mColumns(),
 	mHeader(),
-	mName()
+	mSchema(),
+	mName(),
+	mArena()
 {
 }
 
@@ -28,9 +36,15 @@ TabularData::TabularData()
 
 TabularData::TabularData( const QString& aName )
 :
-	mTable(),
+	mKeys(),
+	mKeySymbols(),
+	mKeyPool(),
+	mRowIndices(),
+	mColumns(),
 	mHeader(),
-	mName( aName )
+	mSchema(),
+	mName( aName ),
+	mArena()
 {
 }
 
@@ -38,9 +52,15 @@ TabularData::TabularData( const QString& aName )
 
 TabularData::TabularData( const TabularData& aOther )
 : 
-	mTable( aOther.mTable ),
+	mKeys( aOther.mKeys ),
+	mKeySymbols( aOther.mKeySymbols ),
+	mKeyPool( aOther.mKeyPool ),
+	mRowIndices( aOther.mRowIndices ),
+	mColumns( aOther.mColumns ),
 	mHeader( aOther.mHeader ),
-	mName( aOther.mName ) 
+	mSchema( aOther.mSchema ),
+	mName( aOther.mName ),
+	mArena()
 {
 }
 
@@ -48,9 +68,15 @@ TabularData::TabularData( const TabularData& aOther )
 
 TabularData::TabularData( TabularData&& aOther )
 : 
-	mTable( std::move( aOther.mTable ) ),
-	mHeader( aOther.mHeader ),
-	mName( aOther.mName )
+	mKeys( std::move( aOther.mKeys ) ),
+	mKeySymbols( std::move( aOther.mKeySymbols ) ),
+	mKeyPool( aOther.mKeyPool ),
+	mRowIndices( std::move( aOther.mRowIndices ) ),
+	mColumns( std::move( aOther.mColumns ) ),
+	mHeader( std::move( aOther.mHeader ) ),
+	mSchema( std::move( aOther.mSchema ) ),
+	mName( std::move( aOther.mName ) ),
+	mArena( std::move( aOther.mArena ) )
 {
 }
 
@@ -58,9 +84,91 @@ TabularData::TabularData( TabularData&& aOther )
 
 TabularData::~TabularData()
 {
-
-	mTable.clear();
+	mKeys.clear();
+	mKeySymbols.clear();
+	mRowIndices.clear();
+	mColumns.clear();
 	mHeader.clear();
+	mSchema.clear();
+}
+
+//-----------------------------------------------------------------------------
+
+lpmldata::TabularData& TabularData::operator=( const lpmldata::TabularData& aRight )
+{
+	mKeys       = aRight.mKeys;
+	mKeySymbols = aRight.mKeySymbols;
+	mKeyPool    = aRight.mKeyPool;
+	mRowIndices = aRight.mRowIndices;
+	mColumns    = aRight.mColumns;
+	mHeader     = aRight.mHeader;
+	mSchema     = aRight.mSchema;
+	mName       = aRight.mName;
+	return *this;
+}
+
+//-----------------------------------------------------------------------------
+
+lpmldata::TabularData& TabularData::operator=( lpmldata::TabularData&& aRight )
+{
+	mKeys       = std::move( aRight.mKeys );
+	mKeySymbols = std::move( aRight.mKeySymbols );
+	mKeyPool    = aRight.mKeyPool;
+	mRowIndices = std::move( aRight.mRowIndices );
+	mColumns    = std::move( aRight.mColumns );
+	mHeader     = std::move( aRight.mHeader );
+	mSchema     = std::move( aRight.mSchema );
+	mName       = std::move( aRight.mName );
+	mArena      = std::move( aRight.mArena );
+	return *this;
+}
+
+//-----------------------------------------------------------------------------
+
+TabularDataTable TabularData::table() const
+{
+	TabularDataTable table;
+	table.reserve( mKeys.size() );
+
+	for ( int rowIndex = 0; rowIndex < mKeys.size(); ++rowIndex )
+	{
+		QVariantList row;
+		row.reserve( mColumns.size() );
+		for ( int columnIndex = 0; columnIndex < mColumns.size(); ++columnIndex )
+		{
+			row.push_back( mColumns.at( columnIndex ).value( rowIndex ) );
+		}
+
+		table.insert( mKeys.at( rowIndex ), row );
+	}
+
+	return table;
+}
+
+//-----------------------------------------------------------------------------
+
+TabularDataReference< TabularDataTable > TabularData::table()
+{
+	return TabularDataReference< TabularDataTable >( static_cast< const TabularData& >( *this ).table(), [this]( const TabularDataTable& aTable ) { assignTable( aTable ); } );
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularData::assignTable( const TabularDataTable& aTable )
+{
+	clear();
+	reserve( aTable.size() );
+	for ( auto rowIt = aTable.constBegin(); rowIt != aTable.constEnd(); ++rowIt )
+	{
+		insert( rowIt.key(), rowIt.value() );
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+TabularDataReference< TabularDataHeader > TabularData::header()
+{
+	return TabularDataReference< TabularDataHeader >( mHeader, [this]( const TabularDataHeader& aHeader ) { setHeader( aHeader ); } );
 }
 
 //-----------------------------------------------------------------------------
@@ -77,124 +185,398 @@ void TabularData::setHeader( QStringList aHeaderNames )
 		header.insert( QString::number( headerIndex ), headerValue );
 	}
 
-	mHeader = header;
+	setHeader( header );
 }
 
 //-----------------------------------------------------------------------------
 
-QVariantList TabularData::column( unsigned int aColumnIndex )
+void TabularData::setHeader( const TabularDataHeader& aHeader )
 {
-	QVariantList column;
+	mHeader = aHeader;
+	mSchema = TabularDataSchema( mHeader );
+
+	// The header is the schema of the columns: create the missing ones with the declared types.
+	int previousColumnCount = mColumns.size();
+	resizeColumns( mSchema.size() );
 
-	QStringList keys = mTable.keys();
+	for ( int columnIndex = previousColumnCount; columnIndex < mColumns.size(); ++columnIndex )
+	{
+		mColumns[ columnIndex ] = TabularDataColumn( mSchema.type( columnIndex ), mArena );
+		mColumns[ columnIndex ].resize( mKeys.size() );
+	}
+}
 
-	for ( int keyIndex = 0; keyIndex < keys.count(); ++keyIndex )
+//-----------------------------------------------------------------------------
+
+void TabularData::resizeColumns( int aColumnCount )
+{
+	int previousColumnCount = mColumns.size();
+	mColumns.resize( aColumnCount );
+
+	for ( int columnIndex = previousColumnCount; columnIndex < aColumnCount; ++columnIndex )
 	{
-		column << mTable.value( keys.at( keyIndex ) ).at( aColumnIndex );
+		if ( mArena )
+		{
+			mColumns[ columnIndex ] = TabularDataColumn( TabularDataColumnType::Float, mArena );
+		}
+
+		mColumns[ columnIndex ].resize( mKeys.size() );
+
+		if ( !mHeader.contains( QString::number( columnIndex ) ) )
+		{
+			QVariantList headerValue = { QString(), QString( "Float" ) };
+			mHeader.insert( QString::number( columnIndex ), headerValue );
+			mSchema.append( QString() );
+		}
 	}
 
-	return column;
+	if ( aColumnCount < previousColumnCount )
+	{
+		for ( int columnIndex = aColumnCount; columnIndex < previousColumnCount; ++columnIndex )
+		{
+			mHeader.remove( QString::number( columnIndex ) );
+		}
+
+		mSchema = TabularDataSchema( mHeader );
+	}
 }
 
 //-----------------------------------------------------------------------------
 
-QVariantList TabularData::column( QString aColumnName )
+void TabularData::assign( const TabularDataHeader& aHeader, const QList< QString >& aKeys, QVector< lpmldata::TabularDataColumn > aColumns )
 {
-	QStringList headerNames = this->headerNames();
+	mKeys.clear();
+	mKeySymbols.clear();
+	mKeyPool = SymbolPool();
+	mRowIndices.clear();
+	mKeys.reserve( aKeys.size() );
+	mKeySymbols.reserve( aKeys.size() );
+	mKeyPool.reserve( aKeys.size() );
+	mRowIndices.reserve( aKeys.size() );
+
+	for ( const QString& key : aKeys )
+	{
+		appendKey( mKeyPool.intern( key ) );
+	}
 
-	int headerIndex = headerNames.indexOf( aColumnName );
+	mColumns = std::move( aColumns );
+	mHeader  = aHeader;
+	mSchema  = TabularDataSchema( mHeader );
+}
 
-	return column( headerNames.indexOf( aColumnName ) );
+//-----------------------------------------------------------------------------
+
+void TabularData::appendKey( Symbol aKeySymbol )
+{
+	// The symbols are dense, the row indices cover the whole pool.
+	int symbolCount = mRowIndices.size();
+	if ( symbolCount < mKeyPool.size() )
+	{
+		mRowIndices.resize( mKeyPool.size() );
+		std::fill( mRowIndices.begin() + symbolCount, mRowIndices.end(), -1 );
+	}
 
+	mRowIndices[ aKeySymbol ] = mKeys.size();
+	mKeys.push_back( mKeyPool.string( aKeySymbol ) );
+	mKeySymbols.push_back( aKeySymbol );
 }
 
 //-----------------------------------------------------------------------------
 
-const QStringList TabularData::headerNames()
+QVector< Symbol > TabularData::keySymbolsOf( const lpmldata::TabularData& aTabularData, bool aIsInterned )
 {
-	QStringList headerNames;
+	if ( aTabularData.mKeyPool.isSharedWith( mKeyPool ) ) return aTabularData.mKeySymbols;
 
-	for ( int headerIndex = 0; headerIndex < mHeader.size(); ++headerIndex )
+	QVector< Symbol > keySymbols( aTabularData.mKeys.size() );
+	for ( int rowIndex = 0; rowIndex < keySymbols.size(); ++rowIndex )
 	{
-		headerNames << mHeader.value( QString::number( headerIndex ) ).toStringList().at( 0 );
+		const QString& key = aTabularData.mKeys.at( rowIndex );
+		keySymbols[ rowIndex ] = aIsInterned ? mKeyPool.intern( key ) : mKeyPool.find( key );
 	}
 
-	return headerNames;
+	return keySymbols;
 }
 
 //-----------------------------------------------------------------------------
 
-double TabularData::mean( unsigned int aColumnIndex )
+QVariantList TabularData::value( const QString& aKey ) const
 {
-	QVariantList col = column( aColumnIndex );
+	QVariantList row;
 
-	double mean = 0.0;
+	int rowIndex = this->rowIndex( aKey );
+	if ( rowIndex < 0 ) return row;
 
-	for ( int rowIndex = 0; rowIndex < col.size(); ++rowIndex )
+	row.reserve( mColumns.size() );
+	for ( int columnIndex = 0; columnIndex < mColumns.size(); ++columnIndex )
 	{
-		mean += col.at( rowIndex ).toDouble();
+		row.push_back( mColumns.at( columnIndex ).value( rowIndex ) );
 	}
 
-	return mean / col.size();
+	return row;
 }
 
 //-----------------------------------------------------------------------------
 
-double TabularData::deviation( unsigned int aColumnIndex )
+QVariant TabularData::valueAt( const QString& aKey, int aColumnIndex ) const
 {
-	QVariantList col = column( aColumnIndex );
-	double deviation = 0.0;
-	double meanOfColumn = mean( aColumnIndex );
+	int rowIndex = this->rowIndex( aKey );
+	if ( rowIndex < 0 ) return QVariant();
 
-	for ( int rowIndex = 0; rowIndex < col.size(); ++rowIndex )
+	return mColumns.at( aColumnIndex ).value( rowIndex );
+}
+
+//-----------------------------------------------------------------------------
+
+TabularDataReference< QVariantList > TabularData::value( const QString& aKey )
+{
+	return TabularDataReference< QVariantList >( static_cast< const TabularData& >( *this ).value( aKey ), [this, aKey]( const QVariantList& aRow ) { insert( aKey, aRow ); } );
+}
+
+//-----------------------------------------------------------------------------
+
+TabularDataReference< QVariant > TabularData::valueAt( const QString& aKey, int aColumnIndex )
+{
+	return TabularDataReference< QVariant >( static_cast< const TabularData& >( *this ).valueAt( aKey, aColumnIndex ), [this, aKey, aColumnIndex]( const QVariant& aValue )
 	{
-		deviation += ( col.at( rowIndex ).toDouble() - meanOfColumn ) * ( col.at( rowIndex ).toDouble() - meanOfColumn );
+		if ( aColumnIndex >= mColumns.size() ) resizeColumns( aColumnIndex + 1 );
+		insertRow( aKey );
+		setValueAt( aKey, aColumnIndex, aValue );
+	} );
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularData::setValueAt( const QString& aKey, int aColumnIndex, const QVariant& aValue )
+{
+	int rowIndex = this->rowIndex( aKey );
+	if ( rowIndex < 0 ) return;
+
+	mColumns[ aColumnIndex ].setValue( rowIndex, aValue );
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularData::insert( const QString& aKey, const QVariantList& aValue )
+{
+	if ( aValue.size() > mColumns.size() )
+	{
+		resizeColumns( aValue.size() );
 	}
 
-	return sqrt( deviation / col.size() );
+	Symbol keySymbol = mKeyPool.intern( aKey );
+	int rowIndex = this->rowIndex( keySymbol );
+
+	if ( rowIndex < 0 )
+	{
+		rowIndex = mKeys.size();
+		appendKey( keySymbol );
+
+		for ( int columnIndex = 0; columnIndex < mColumns.size(); ++columnIndex )
+		{
+			mColumns[ columnIndex ].append( columnIndex < aValue.size() ? aValue.at( columnIndex ) : QVariant() );
+		}
+	}
+	else
+	{
+		for ( int columnIndex = 0; columnIndex < mColumns.size(); ++columnIndex )
+		{
+			mColumns[ columnIndex ].setValue( rowIndex, columnIndex < aValue.size() ? aValue.at( columnIndex ) : QVariant() );
+		}
+	}
 }
 
 //-----------------------------------------------------------------------------
 
-double TabularData::min( unsigned int aColumnIndex )
+int TabularData::insertRow( const QString& aKey )
 {
-	QVariantList col = column( aColumnIndex );
-	double min = DBL_MAX;
+	Symbol keySymbol = mKeyPool.intern( aKey );
+	int rowIndex = this->rowIndex( keySymbol );
+	if ( rowIndex >= 0 ) return rowIndex;
+
+	rowIndex = mKeys.size();
+	appendKey( keySymbol );
 
-	for ( int rowIndex = 0; rowIndex < col.size(); ++rowIndex )
+	for ( int columnIndex = 0; columnIndex < mColumns.size(); ++columnIndex )
 	{
-		double actVal = col.at( rowIndex ).toDouble();
-		if ( actVal < min ) min = actVal;
+		mColumns[ columnIndex ].resize( rowIndex + 1 );
 	}
 
-	return min;
+	return rowIndex;
 }
 
 //-----------------------------------------------------------------------------
 
-double TabularData::max( unsigned int aColumnIndex )
+QVector< int > TabularData::insertRows( const QVector< QString >& aKeys )
 {
-	QVariantList col = column( aColumnIndex );
-	double max = -DBL_MAX;
+	QVector< int > rowIndices( aKeys.size() );
+	mKeys.reserve( mKeys.size() + aKeys.size() );
+	mKeySymbols.reserve( mKeySymbols.size() + aKeys.size() );
+	mRowIndices.reserve( mRowIndices.size() + aKeys.size() );
+
+	for ( int keyIndex = 0; keyIndex < aKeys.size(); ++keyIndex )
+	{
+		Symbol keySymbol = mKeyPool.intern( aKeys.at( keyIndex ) );
+		int rowIndex = this->rowIndex( keySymbol );
+		if ( rowIndex < 0 )
+		{
+			rowIndex = mKeys.size();
+			appendKey( keySymbol );
+		}
+
+		rowIndices[ keyIndex ] = rowIndex;
+	}
+
+	for ( int columnIndex = 0; columnIndex < mColumns.size(); ++columnIndex )
+	{
+		mColumns[ columnIndex ].resize( mKeys.size() );
+	}
+
+	return rowIndices;
+}
+
+//-----------------------------------------------------------------------------
+
+int TabularData::remove( const QString& aKey )
+{
+	int rowIndex = this->rowIndex( aKey );
+	if ( rowIndex < 0 ) return 0;
+
+	for ( int columnIndex = 0; columnIndex < mColumns.size(); ++columnIndex )
+	{
+		mColumns[ columnIndex ].remove( rowIndex );
+	}
+
+	mRowIndices[ mKeySymbols.at( rowIndex ) ] = -1;
+	mKeys.removeAt( rowIndex );
+	mKeySymbols.remove( rowIndex );
+
+	// Rows after the removed one move up by one.
+	for ( int keyIndex = rowIndex; keyIndex < mKeySymbols.size(); ++keyIndex )
+	{
+		mRowIndices[ mKeySymbols.at( keyIndex ) ] = keyIndex;
+	}
+
+	return 1;
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularData::clear()
+{
+	mKeys.clear();
+	mKeySymbols.clear();
+	mKeyPool = SymbolPool();
+	mRowIndices.clear();
+
+	for ( int columnIndex = 0; columnIndex < mColumns.size(); ++columnIndex )
+	{
+		mColumns[ columnIndex ].clear();
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularData::reserve( int aRowCount )
+{
+	mKeys.reserve( aRowCount );
+	mKeySymbols.reserve( aRowCount );
+	mKeyPool.reserve( aRowCount );
+	mRowIndices.reserve( aRowCount );
+
+	for ( int columnIndex = 0; columnIndex < mColumns.size(); ++columnIndex )
+	{
+		mColumns[ columnIndex ].reserve( aRowCount );
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+QVariantList TabularData::column( unsigned int aColumnIndex ) const
+{
+	QVariantList column;
+
+	const TabularDataColumn& columnData = mColumns.at( aColumnIndex );
+	column.reserve( columnData.size() );
+
+	for ( int rowIndex = 0; rowIndex < columnData.size(); ++rowIndex )
+	{
+		column << columnData.value( rowIndex );
+	}
+
+	return column;
+}
+
+//-----------------------------------------------------------------------------
+
+QVariantList TabularData::column( const QString& aColumnName ) const
+{
+	return column( mSchema.indexOf( aColumnName ) );
+}
+
+//-----------------------------------------------------------------------------
+
+ColumnView< double > TabularData::columnView( const QString& aColumnName ) const
+{
+	int columnIndex = mSchema.indexOf( aColumnName );
+	if ( columnIndex < 0 ) return ColumnView< double >();
+
+	return columnView( columnIndex );
+}
+
+//-----------------------------------------------------------------------------
+
+QVector< lpmldata::TabularDataColumnSummary > TabularData::summary() const
+{
+	QVector< lpmldata::TabularDataColumnSummary > summaries( mColumns.size() );
+
+	int columnCount = mColumns.size();
 
-	for ( int rowIndex = 0; rowIndex < col.size(); ++rowIndex )
+#pragma omp parallel for schedule( dynamic, 1 )
+	for ( int columnIndex = 0; columnIndex < columnCount; ++columnIndex )
 	{
-		double actVal = col.at( rowIndex ).toDouble();
-		if ( actVal > max ) max = actVal;
+		summaries[ columnIndex ] = mColumns.at( columnIndex ).summary();
 	}
 
-	return max;
+	return summaries;
 }
 
 //-----------------------------------------------------------------------------
 
-QVector< double > TabularData::mins()
+double TabularData::mean( unsigned int aColumnIndex ) const
+{
+	return mColumns.at( aColumnIndex ).summary().mean;
+}
+
+//-----------------------------------------------------------------------------
+
+double TabularData::deviation( unsigned int aColumnIndex ) const
+{
+	return sqrt( mColumns.at( aColumnIndex ).summary().variance );
+}
+
+//-----------------------------------------------------------------------------
+
+double TabularData::min( unsigned int aColumnIndex ) const
+{
+	return mColumns.at( aColumnIndex ).summary().min;
+}
+
+//-----------------------------------------------------------------------------
+
+double TabularData::max( unsigned int aColumnIndex ) const
+{
+	return mColumns.at( aColumnIndex ).summary().max;
+}
+
+//-----------------------------------------------------------------------------
+
+QVector< double > TabularData::mins() const
 {
 	QVector< double > mins;
 
-	for ( int colIndex = 0; colIndex < columnCount(); ++colIndex )
+	for ( auto columnSummary : summary() )
 	{
-		mins.push_back( this->min( colIndex ) );
+		mins.push_back( columnSummary.min );
 	}
 
 	return mins;
@@ -202,13 +584,13 @@ QVector< double > TabularData::mins()
 
 //-----------------------------------------------------------------------------
 
-QVector< double > TabularData::maxs()
+QVector< double > TabularData::maxs() const
 {
 	QVector< double > maxs;
 
-	for ( int colIndex = 0; colIndex < columnCount(); ++colIndex )
+	for ( auto columnSummary : summary() )
 	{
-		maxs.push_back( this->max( colIndex ) );
+		maxs.push_back( columnSummary.max );
 	}
 
 	return maxs;
@@ -216,13 +598,13 @@ QVector< double > TabularData::maxs()
 
 //-----------------------------------------------------------------------------
 
-QVariantList TabularData::means()
+QVariantList TabularData::means() const
 {
 	QVariantList meanList;
 
-	for ( unsigned int headerIndex = 0; headerIndex < mHeader.size(); ++headerIndex )
+	for ( auto columnSummary : summary() )
 	{
-		meanList.push_back( mean( headerIndex ) );
+		meanList.push_back( columnSummary.mean );
 	}
 
 	return meanList;
@@ -230,13 +612,13 @@ QVariantList TabularData::means()
 
 //-----------------------------------------------------------------------------
 
-QVariantList TabularData::deviations()
+QVariantList TabularData::deviations() const
 {
 	QVariantList deviationList;
 
-	for ( unsigned int headerIndex = 0; headerIndex < mHeader.size(); ++headerIndex )
+	for ( auto columnSummary : summary() )
 	{
-		deviationList.push_back( deviation( headerIndex ) );
+		deviationList.push_back( sqrt( columnSummary.variance ) );
 	}
 
 	return deviationList;
@@ -244,34 +626,179 @@ QVariantList TabularData::deviations()
 
 //-----------------------------------------------------------------------------
 
-void TabularData::mergeRecords( lpmldata::TabularData aTabularData )
+double TabularData::correlation( unsigned int aFirstColumnIndex, unsigned int aSecondColumnIndex, TabularDataCorrelation aCorrelation ) const
 {
-	auto inputHeaderNames = aTabularData.headerNames();
-	auto selfHeaderNames  = this->headerNames();
+	return TabularDataColumn::correlation( mColumns.at( aFirstColumnIndex ), mColumns.at( aSecondColumnIndex ), aCorrelation );
+}
 
-	QStringList commonFeatures = inputHeaderNames.toSet().intersect( selfHeaderNames.toSet() ).toList();
-	if ( commonFeatures.size() != inputHeaderNames.size() )
+//-----------------------------------------------------------------------------
+
+void TabularData::mergeRecords( const lpmldata::TabularData& aTabularData )
+{
+	const QStringList& inputHeaderNames = aTabularData.headerNames();
+
+	for ( const QString& inputHeaderName : inputHeaderNames )
 	{
-		qDebug() << "TabularData merge - ERROR: Input and current features are not the same: ";
-		qDebug() << "Input header names: " << inputHeaderNames;
-		qDebug() << "Self header names: " << selfHeaderNames;
-		return;
+		if ( !mSchema.contains( inputHeaderName ) )
+		{
+			qDebug() << "TabularData merge - ERROR: Input and current features are not the same: ";
+			qDebug() << "Input header names: " << inputHeaderNames;
+			qDebug() << "Self header names: " << headerNames();
+			return;
+		}
 	}
 
-	QStringList keys = aTabularData.keys();
-	
-	for ( int keyIndex = 0; keyIndex < keys.size(); ++keyIndex )
+	appendRows( { &aTabularData } );
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularData::appendRows( const QList< const lpmldata::TabularData* >& aTabularDatas )
+{
+	// Reconcile the schemas once: the n-th column of a name goes to the n-th column of that name, unknown ones are added.
+	QHash< QString, QVector< int > > columnIndicesByName;
+	for ( int columnIndex = 0; columnIndex < mSchema.size(); ++columnIndex )
+	{
+		columnIndicesByName[ mSchema.name( columnIndex ) ].push_back( columnIndex );
+	}
+
+	int previousColumnCount = mColumns.size();
+	QStringList newColumnNames;
+	QVector< QVector< int > > targetColumnsPerTabularData( aTabularDatas.size() );
+
+	for ( int tableIndex = 0; tableIndex < aTabularDatas.size(); ++tableIndex )
+	{
+		const lpmldata::TabularDataSchema& schema = aTabularDatas.at( tableIndex )->mSchema;
+		QHash< QString, int > occurrences;
+
+		for ( int columnIndex = 0; columnIndex < schema.size(); ++columnIndex )
+		{
+			const QString& name = schema.name( columnIndex );
+			int occurrence = occurrences[ name ]++;
+			QVector< int >& columnIndices = columnIndicesByName[ name ];
+
+			if ( occurrence == columnIndices.size() )
+			{
+				columnIndices.push_back( previousColumnCount + newColumnNames.size() );
+				newColumnNames.push_back( name );
+			}
+
+			targetColumnsPerTabularData[ tableIndex ].push_back( columnIndices.at( occurrence ) );
+		}
+	}
+
+	int columnCount = previousColumnCount + newColumnNames.size();
+	resizeColumns( columnCount );
+
+	QVector< QVector< int > > sourceColumnsPerTabularData( aTabularDatas.size() );
+	for ( int tableIndex = 0; tableIndex < aTabularDatas.size(); ++tableIndex )
+	{
+		const QVector< int >& targetColumns = targetColumnsPerTabularData.at( tableIndex );
+		QVector< int >& sourceColumns = sourceColumnsPerTabularData[ tableIndex ];
+		sourceColumns.fill( -1, columnCount );
+
+		for ( int columnIndex = 0; columnIndex < targetColumns.size(); ++columnIndex )
+		{
+			sourceColumns[ targetColumns.at( columnIndex ) ] = columnIndex;
+		}
+	}
+
+	// An empty table takes over the key pool of the first table, whose keys then need no interning.
+	if ( mKeys.isEmpty() && !aTabularDatas.isEmpty() )
+	{
+		mKeyPool = aTabularDatas.first()->mKeyPool;
+		mRowIndices.clear();
+	}
+
+	// Assign the rows: new keys are appended, a key seen again takes the row of its last table.
+	int previousRowCount = mKeys.size();
+	QVector< int > sourceIndices;
+	QVector< int > sourceRows;
+	QVector< QPair< int, QPair< int, int > > > overwrites;  // Existing row, table index, source row.
+
+	for ( int tableIndex = 0; tableIndex < aTabularDatas.size(); ++tableIndex )
+	{
+		// Keys of a table with another pool are interned into the pool of this one.
+		QVector< Symbol > keySymbols = keySymbolsOf( *aTabularDatas.at( tableIndex ), true );
+		mKeySymbols.reserve( mKeySymbols.size() + keySymbols.size() );
+
+		for ( int rowIndex = 0; rowIndex < keySymbols.size(); ++rowIndex )
+		{
+			int targetRowIndex = this->rowIndex( keySymbols.at( rowIndex ) );
+
+			if ( targetRowIndex < 0 )
+			{
+				appendKey( keySymbols.at( rowIndex ) );
+				sourceIndices.push_back( tableIndex );
+				sourceRows.push_back( rowIndex );
+			}
+			else if ( targetRowIndex >= previousRowCount )
+			{
+				sourceIndices[ targetRowIndex - previousRowCount ] = tableIndex;
+				sourceRows[ targetRowIndex - previousRowCount ]    = rowIndex;
+			}
+			else
+			{
+				overwrites.push_back( qMakePair( targetRowIndex, qMakePair( tableIndex, rowIndex ) ) );
+			}
+		}
+	}
+
+	// Append the new rows column by column, each column reserved once and filled by block copies.
+	int appendedRowCount = sourceRows.size();
+	lpmldata::TabularDataColumn* columns = mColumns.data();
+
+#pragma omp parallel for schedule( dynamic, 1 )
+	for ( int columnIndex = 0; columnIndex < columnCount; ++columnIndex )
+	{
+		QVector< const lpmldata::TabularDataColumn* > sources( aTabularDatas.size(), nullptr );
+		for ( int tableIndex = 0; tableIndex < aTabularDatas.size(); ++tableIndex )
+		{
+			int sourceColumnIndex = sourceColumnsPerTabularData.at( tableIndex ).at( columnIndex );
+			if ( sourceColumnIndex >= 0 )
+			{
+				sources[ tableIndex ] = &aTabularDatas.at( tableIndex )->mColumns.at( sourceColumnIndex );
+			}
+		}
+
+		columns[ columnIndex ].append( sources, sourceIndices.constData(), sourceRows.constData(), appendedRowCount );
+	}
+
+	// Rows of keys which were already in the table are overwritten one by one, like insert() does.
+	for ( const auto& overwrite : overwrites )
+	{
+		const lpmldata::TabularData* tabularData = aTabularDatas.at( overwrite.second.first );
+		const QVector< int >& sourceColumns = sourceColumnsPerTabularData.at( overwrite.second.first );
+
+		for ( int columnIndex = 0; columnIndex < columnCount; ++columnIndex )
+		{
+			int sourceColumnIndex = sourceColumns.at( columnIndex );
+			QVariant value = sourceColumnIndex < 0 ? QVariant() : tabularData->mColumns.at( sourceColumnIndex ).value( overwrite.second.second );
+			mColumns[ columnIndex ].setValue( overwrite.first, value );
+		}
+	}
+
+	// The added columns are named in the header, and every column gets the type it ended up with.
+	bool isHeaderChanged = false;
+	for ( int columnIndex = 0; columnIndex < columnCount; ++columnIndex )
 	{
-		QString key = keys.at( keyIndex );
-		QVariantList values = aTabularData.value( key );
+		bool isNew = columnIndex >= previousColumnCount;
+		if ( !isNew && mSchema.type( columnIndex ) == mColumns.at( columnIndex ).type() ) continue;
 
-		this->insert( key, values );
+		QVariantList headerValue = { isNew ? newColumnNames.at( columnIndex - previousColumnCount ) : mSchema.name( columnIndex ), TabularDataSchema::typeName( mColumns.at( columnIndex ).type() ) };
+		mHeader.insert( QString::number( columnIndex ), headerValue );
+		isHeaderChanged = true;
+	}
+
+	if ( isHeaderChanged )
+	{
+		mSchema = TabularDataSchema( mHeader );
 	}
 }
 
 //-----------------------------------------------------------------------------
 
-lpmldata::TabularData TabularData::mergeFeatures( QList< lpmldata::TabularData > aTabularDatas, TabularDataMerge aMerge )
+lpmldata::TabularData TabularData::mergeFeatures( const QList< lpmldata::TabularData >& aTabularDatas, TabularDataMerge aMerge, TabularDataJoin aJoin )
 {
 	lpmldata::TabularData mergedTabularData;
 
@@ -279,62 +806,202 @@ lpmldata::TabularData TabularData::mergeFeatures( QList< lpmldata::TabularData >
 	{
 	case TabularDataMerge::Rows:
 	{
+		QList< const lpmldata::TabularData* > tabularDatas;
+		for ( const lpmldata::TabularData& tabularData : aTabularDatas )
+		{
+			tabularDatas.push_back( &tabularData );
+		}
+
+		mergedTabularData.appendRows( tabularDatas );
 		break;
 	}
 	case TabularDataMerge::Columns:
 	{
-		// Read out the keys and the feature names.
-		QList< QStringList > keysPerTabularData;
-		QList< QStringList > featuresPerTabularData;
-		for ( auto tabularData : aTabularDatas )
+		mergedTabularData = joinColumns( aTabularDatas, aJoin, nullptr );
+		break;
+	}
+	}
+
+	return mergedTabularData;
+}
+
+//-----------------------------------------------------------------------------
+
+lpmldata::TabularData TabularData::mergeFeatures( QList< lpmldata::TabularData >&& aTabularDatas, TabularDataMerge aMerge, TabularDataJoin aJoin )
+{
+	if ( aMerge == TabularDataMerge::Columns )
+	{
+		return joinColumns( aTabularDatas, aJoin, &aTabularDatas );
+	}
+
+	if ( aTabularDatas.isEmpty() ) return lpmldata::TabularData();
+
+	lpmldata::TabularData mergedTabularData = std::move( aTabularDatas.first() );
+	mergedTabularData.mName.clear();
+
+	QList< const lpmldata::TabularData* > tabularDatas;
+	for ( int tableIndex = 1; tableIndex < aTabularDatas.size(); ++tableIndex )
+	{
+		tabularDatas.push_back( &aTabularDatas.at( tableIndex ) );
+	}
+
+	mergedTabularData.appendRows( tabularDatas );
+	return mergedTabularData;
+}
+
+//-----------------------------------------------------------------------------
+
+lpmldata::TabularData TabularData::joinColumns( const QList< lpmldata::TabularData >& aTabularDatas, TabularDataJoin aJoin, QList< lpmldata::TabularData >* aMovableTabularDatas )
+{
+	lpmldata::TabularData mergedTabularData;
+	if ( aTabularDatas.isEmpty() ) return mergedTabularData;
+
+	// Build the key dictionary of the merged table in the key pool of the first table.
+	const lpmldata::TabularData& firstTabularData = aTabularDatas.first();
+	mergedTabularData.mKeyPool = firstTabularData.mKeyPool;
+
+	switch ( aJoin )
+	{
+	case TabularDataJoin::Inner:
+	{
+		QVector< char > isSharedPerTabularData( aTabularDatas.size() );
+		for ( int tableIndex = 0; tableIndex < aTabularDatas.size(); ++tableIndex )
 		{
-			keysPerTabularData.push_back( tabularData.keys() );
-			featuresPerTabularData.push_back( tabularData.headerNames() );
+			isSharedPerTabularData[ tableIndex ] = aTabularDatas.at( tableIndex ).mKeyPool.isSharedWith( firstTabularData.mKeyPool ) ? 1 : 0;
 		}
 
-		// Determine merged list of keys.
-		QStringList mergedKeys;
-		for ( auto keys : keysPerTabularData )
+		for ( int rowIndex = 0; rowIndex < firstTabularData.mKeys.size(); ++rowIndex )
 		{
-			mergedKeys += keys;
-			mergedKeys.removeDuplicates();
-		}
+			bool isInEveryTable = true;
+			for ( int tableIndex = 1; tableIndex < aTabularDatas.size() && isInEveryTable; ++tableIndex )
+			{
+				const lpmldata::TabularData& tabularData = aTabularDatas.at( tableIndex );
+				isInEveryTable = isSharedPerTabularData.at( tableIndex ) ? tabularData.rowIndex( firstTabularData.mKeySymbols.at( rowIndex ) ) >= 0 : tabularData.contains( firstTabularData.mKeys.at( rowIndex ) );
+			}
 
-		// Read merged list of feature names and set up the header of the merged table.
-		QStringList mergedFeatureNames;
-		for ( auto featureNames : featuresPerTabularData )
+			if ( isInEveryTable )
+			{
+				mergedTabularData.appendKey( firstTabularData.mKeySymbols.at( rowIndex ) );
+			}
+		}
+		break;
+	}
+	case TabularDataJoin::Left:
+	{
+		mergedTabularData.mKeys       = firstTabularData.mKeys;
+		mergedTabularData.mKeySymbols = firstTabularData.mKeySymbols;
+		mergedTabularData.mRowIndices = firstTabularData.mRowIndices;
+		break;
+	}
+	case TabularDataJoin::Outer:
+	{
+		int keyCount = 0;
+		for ( const lpmldata::TabularData& tabularData : aTabularDatas )
 		{
-			mergedFeatureNames += featureNames;
+			keyCount = std::max( keyCount, tabularData.mKeys.size() );
 		}
-		mergedTabularData.setHeader( mergedFeatureNames );
+		mergedTabularData.mRowIndices.reserve( keyCount );
 
-		// Create merged tabular data.
-		for ( auto key : mergedKeys )
+		for ( const lpmldata::TabularData& tabularData : aTabularDatas )
 		{
-			QVariantList mergedFeatureVector;
-			for ( auto tabularData : aTabularDatas )
+			for ( Symbol key : mergedTabularData.keySymbolsOf( tabularData, true ) )
 			{
-				int featureCount = tabularData.columnCount();
-				auto featureVector = tabularData.value( key );
-
-				if ( featureVector.size() == 0 )  // This key is not in the given table
+				if ( mergedTabularData.rowIndex( key ) < 0 )
 				{
-					for ( int i = 0; i < featureCount; ++i )
-					{
-						featureVector.push_back( "NA" );
-					}
+					mergedTabularData.appendKey( key );
 				}
+			}
+		}
+		break;
+	}
+	}
+
+	int mergedRowCount = mergedTabularData.mKeys.size();
 
-				mergedFeatureVector += featureVector;  // Merge the actual feature vector into the large feature vector.
+	// Look up the source row of each merged row, once per table. A table whose rows match the merged rows needs no gather.
+	QVector< QVector< int > > sourceRowsPerTabularData( aTabularDatas.size() );
+	QVector< bool > isIdentityPerTabularData( aTabularDatas.size() );
+	int mergedColumnCount = 0;
+
+	for ( int tableIndex = 0; tableIndex < aTabularDatas.size(); ++tableIndex )
+	{
+		const lpmldata::TabularData& tabularData = aTabularDatas.at( tableIndex );
+		QVector< int >& sourceRows = sourceRowsPerTabularData[ tableIndex ];
+		sourceRows.fill( -1, mergedRowCount );
+
+		QVector< Symbol > keySymbols = mergedTabularData.keySymbolsOf( tabularData, false );
+		for ( int rowIndex = 0; rowIndex < tabularData.mKeys.size(); ++rowIndex )
+		{
+			int mergedRowIndex = mergedTabularData.rowIndex( keySymbols.at( rowIndex ) );
+			if ( mergedRowIndex >= 0 )
+			{
+				sourceRows[ mergedRowIndex ] = rowIndex;
 			}
+		}
 
-			mergedTabularData.insert( key, mergedFeatureVector );
+		bool isIdentity = tabularData.mKeys.size() == mergedRowCount;
+		for ( int rowIndex = 0; rowIndex < mergedRowCount && isIdentity; ++rowIndex )
+		{
+			isIdentity = sourceRows.at( rowIndex ) == rowIndex;
+		}
+
+		isIdentityPerTabularData[ tableIndex ] = isIdentity;
+		mergedColumnCount += tabularData.mColumns.size();
+	}
+
+	// Pre-size the merged columns, then move or gather each of them.
+	mergedTabularData.mColumns.resize( mergedColumnCount );
+
+	QVector< int > tableIndices;
+	QVector< int > sourceColumnIndices;
+	tableIndices.reserve( mergedColumnCount );
+	sourceColumnIndices.reserve( mergedColumnCount );
+
+	for ( int tableIndex = 0; tableIndex < aTabularDatas.size(); ++tableIndex )
+	{
+		for ( int columnIndex = 0; columnIndex < aTabularDatas.at( tableIndex ).mColumns.size(); ++columnIndex )
+		{
+			tableIndices.push_back( tableIndex );
+			sourceColumnIndices.push_back( columnIndex );
 		}
-		
-		break;
 	}
+
+	if ( aMovableTabularDatas != nullptr )
+	{
+		for ( int mergedColumnIndex = 0; mergedColumnIndex < mergedColumnCount; ++mergedColumnIndex )
+		{
+			int tableIndex = tableIndices.at( mergedColumnIndex );
+			if ( isIdentityPerTabularData.at( tableIndex ) )
+			{
+				lpmldata::TabularDataColumn& sourceColumn = ( *aMovableTabularDatas )[ tableIndex ].mColumns[ sourceColumnIndices.at( mergedColumnIndex ) ];
+				mergedTabularData.mColumns[ mergedColumnIndex ] = std::move( sourceColumn );
+			}
+		}
+	}
+
+	lpmldata::TabularDataColumn* mergedColumns = mergedTabularData.mColumns.data();
+
+#pragma omp parallel for schedule( dynamic, 1 )
+	for ( int mergedColumnIndex = 0; mergedColumnIndex < mergedColumnCount; ++mergedColumnIndex )
+	{
+		int tableIndex = tableIndices.at( mergedColumnIndex );
+		if ( aMovableTabularDatas != nullptr && isIdentityPerTabularData.at( tableIndex ) ) continue;
+
+		const lpmldata::TabularDataColumn& sourceColumn = aTabularDatas.at( tableIndex ).mColumns.at( sourceColumnIndices.at( mergedColumnIndex ) );
+		mergedColumns[ mergedColumnIndex ].gather( sourceColumn, sourceRowsPerTabularData.at( tableIndex ).constData(), mergedRowCount );
 	}
 
+	// The header follows the columns, with the types they ended up with.
+	lpmldata::TabularDataSchema mergedSchema;
+	for ( int mergedColumnIndex = 0; mergedColumnIndex < mergedColumnCount; ++mergedColumnIndex )
+	{
+		const lpmldata::TabularData& tabularData = aTabularDatas.at( tableIndices.at( mergedColumnIndex ) );
+		mergedSchema.append( tabularData.mSchema.name( sourceColumnIndices.at( mergedColumnIndex ) ), mergedTabularData.mColumns.at( mergedColumnIndex ).type() );
+	}
+
+	mergedTabularData.mHeader = mergedSchema.toHeader();
+	mergedTabularData.mSchema = mergedSchema;
+
 	return mergedTabularData;
 }
 
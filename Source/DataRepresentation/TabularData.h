@@ -12,20 +12,24 @@
 
 #include <DataRepresentation/Export.h>
 #include <DataRepresentation/Types.h>
+#include <DataRepresentation/TabularDataColumn.h>
+#include <DataRepresentation/TabularDataSchema.h>
 #include <QString>
+#include <QStringList>
 #include <QVariant>
 #include <QHash>
 #include <QList>
 #include <QFile>
 #include <QDataStream>
 #include <QVector>
+#include <functional>
+#include <utility>
 
 namespace lpmldata
 {
 
 //-----------------------------------------------------------------------------
 
-typedef QMap< QString , QVariant >      TabularDataHeader;
 typedef QHash< QString, QVariantList >  TabularDataTable;
 
 enum class TabularDataMerge
@@ -34,12 +38,61 @@ enum class TabularDataMerge
 	Columns
 };
 
+/*!
+* \brief Selects the keys of a column-wise merge.
+*/
+enum class TabularDataJoin
+{
+	Inner = 0,  //!< Keys present in every table, in the row order of the first table.
+	Left,       //!< Keys of the first table.
+	Outer       //!< Keys present in any table, in order of first appearance.
+};
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief A copy of a part of a table, e.g. a row or the header, which behaves like a reference to it: when it goes out of scope
+* and its value differs from the copied one, the new value is written back to the table.
+* \details It is returned by the non-const row and header accessors of TabularData so that code written against the former
+* hash-based interface, e.g. tabularData.valueAt( key, 0 ) = value or tabularData[ key ].append( value ), keeps working.
+* Binding it to a plain value, e.g. QVariantList row = tabularData.value( key ), takes a detached copy. New code should use the
+* const accessors and setValueAt(), insert() or setHeader() instead, which avoid the copy and the comparison.
+*/
+template< typename Value >
+class TabularDataReference : public Value
+{
+
+public:
+	TabularDataReference( const Value& aValue, std::function< void( const Value& ) > aWriteBack ) : Value( aValue ), mOriginal( aValue ), mWriteBack( std::move( aWriteBack ) ) {}
+
+	TabularDataReference( TabularDataReference&& aOther ) : Value( std::move( static_cast< Value& >( aOther ) ) ), mOriginal( std::move( aOther.mOriginal ) ), mWriteBack( std::move( aOther.mWriteBack ) ) { aOther.mWriteBack = nullptr; }
+
+	TabularDataReference( const TabularDataReference& ) = delete;
+
+	~TabularDataReference() { if ( mWriteBack && static_cast< const Value& >( *this ) != mOriginal ) mWriteBack( *this ); }
+
+	TabularDataReference& operator=( const Value& aValue ) { Value::operator=( aValue ); return *this; }
+
+	TabularDataReference& operator=( const TabularDataReference& aOther ) { Value::operator=( aOther ); return *this; }
+
+private:
+	Value                                  mOriginal;   //!< The value as it was read from the table.
+	std::function< void( const Value& ) >  mWriteBack;  //!< Writes a changed value back to the table, null once moved from.
+};
+
 //-----------------------------------------------------------------------------
 
 /*!
 * \brief Tabular data class for storing key-value list pairs.
 *
-* \details 
+* \details The values are stored column-wise in typed, contiguous TabularDataColumn buffers. Keys are interned in a SymbolPool
+* owned by the table and its copies, and a vector indexed by their symbols gives the row indices. Tables sharing the pool, e.g.
+* copies and merges of a table, compare key symbols in joins; keys of other tables are looked up by string. The pool is released
+* with the last table sharing it, clear() starts a new one.
+* Rows are kept in insertion order: a new key is appended as the last row, overwriting an existing key keeps its row, and removing
+* a key moves the following rows up by one. keys(), column() and the column views all follow this row order.
+* The row-based interface (table, header, value, valueAt, insert) is a compatibility layer on top of the columns, its non-const
+* accessors return TabularDataReference copies which write the changes back.
 */
 class DataRepresentation_API TabularData
 {
@@ -74,145 +127,344 @@ public:
 	~TabularData();
 
 	/*!
-	* \brief Returns with the hash representing the table itself.
-	* \return The Qhash containing the table.
+	* \brief Returns with a hash representing the table itself. The hash is built from the columns on each call.
+	* \return The QHash containing the table.
 	*/
-	TabularDataTable& table() { return mTable; }
+	TabularDataTable table() const;
 
-	const TabularDataTable& table() const { return mTable; }
+	/*!
+	* \brief Returns with the hash representing the table for editing it, see TabularDataReference. A changed hash replaces the
+	* whole table when the returned object goes out of scope, the rows then follow the iteration order of the hash.
+	*/
+	TabularDataReference< TabularDataTable > table();
 
 	/*!
 	* \brief Returns with the map representing the table header.
 	* \return The QMap containing the header.
 	*/
-	TabularDataHeader& header() { return mHeader; }
-
 	const TabularDataHeader& header() const { return mHeader; }
 
+	/*!
+	* \brief Returns with the header for editing it, a changed header is set by setHeader() when the returned object goes out of scope.
+	*/
+	TabularDataReference< TabularDataHeader > header();
+
+	/*!
+	* \brief Returns with the schema of the table, the typed and indexed form of the header.
+	* \details The schema is rebuilt when the header is set and is not touched by row operations.
+	*/
+	const TabularDataSchema& schema() const { return mSchema; }
+
 	void setHeader( QStringList aHeaderNames );
 
+	void setHeader( const TabularDataHeader& aHeader );
+
 	//QMap< int, QList< QString > > headerIndexable();
 
-	const QStringList headerNames();
+	/*!
+	* \brief Returns with the column names in column order. The list is cached in the schema.
+	*/
+	const QStringList& headerNames() const { return mSchema.names(); }
+
+	/*!
+	* \brief Returns with the index of the column in constant time.
+	* \param [in] aColumnName The name of the column.
+	* \return The column index or -1 if there is no column with the given name.
+	*/
+	int columnIndex( const QString& aColumnName ) const { return mSchema.indexOf( aColumnName ); }
+
+	int columnIndex( Symbol aColumnSymbol ) const { return mSchema.indexOf( aColumnSymbol ); }
+
+	/*!
+	* \brief Replaces the content of the table with ready columns, e.g. columns mapped from a file, without copying them.
+	* \param [in] aHeader The header describing the columns.
+	* \param [in] aKeys The unique keys in row order, one per row of the columns.
+	* \param [in] aColumns The columns, all of them of the same size.
+	*/
+	void assign( const TabularDataHeader& aHeader, const QList< QString >& aKeys, QVector< lpmldata::TabularDataColumn > aColumns );
 
 	/*!
 	* \brief Returns with the row of the respected key.
 	* \param [in] aKey The key of the requested value.
-	* \return The value list of the key.
+	* \return The value list of the key, empty if the key is not in the table.
 	*/
-	const QVariantList value( const QString& aKey ) const { return mTable.value( aKey ); }
+	QVariantList value( const QString& aKey ) const;
 
-	QVariantList& value( const QString& aKey ) { return mTable[ aKey ]; }
+	/*!
+	* \brief Returns with the row of the key for editing it, a changed row is inserted when the returned object goes out of scope.
+	* \details The key gets a row only if the returned row is changed.
+	*/
+	TabularDataReference< QVariantList > value( const QString& aKey );
 
-	QVariantList& operator[]( const QString& aKey ) { return mTable[ aKey ]; }
+	QVariantList operator[]( const QString& aKey ) const { return value( aKey ); }
 
-	lpmldata::TabularData& operator=(const lpmldata::TabularData& aRight)
-	{
-		mTable  = aRight.mTable;
-		mHeader = aRight.mHeader;
-		mName   = aRight.mName;
-		return *this;
-	}
+	TabularDataReference< QVariantList > operator[]( const QString& aKey ) { return value( aKey ); }
+
+	lpmldata::TabularData& operator=( const lpmldata::TabularData& aRight );
+
+	lpmldata::TabularData& operator=( lpmldata::TabularData&& aRight );
 
 	/*!
 	* \brief Returns with the value of the respected key and column index.
 	* \param [in] aKey The key of the requested value.
 	* \param [in] aColumnIndex The column index of the requested value.
-	* \return The value of the key at the given column index.
+	* \return The value of the key at the given column index, invalid if the key is not in the table.
 	*/
-	const QVariant valueAt( QString aKey, int aColumnIndex ) const { return mTable.value( aKey ).at( aColumnIndex ); }
+	QVariant valueAt( const QString& aKey, int aColumnIndex ) const;
 
-	QVariant& valueAt( QString aKey, int aColumnIndex ) { return mTable[ aKey ][ aColumnIndex ];
-}
+	/*!
+	* \brief Returns with the value of the key and column index for editing it, a changed value is set by setValueAt() when the
+	* returned object goes out of scope.
+	*/
+	TabularDataReference< QVariant > valueAt( const QString& aKey, int aColumnIndex );
+
+	/*!
+	* \brief Overwrites the value of the respected key and column index.
+	* \param [in] aKey The key of the value to overwrite.
+	* \param [in] aColumnIndex The column index of the value to overwrite.
+	* \param [in] aValue The new value.
+	*/
+	void setValueAt( const QString& aKey, int aColumnIndex, const QVariant& aValue );
 
 	/*!
-	* \brief Inserts a new value identified with the key.
+	* \brief Inserts a new value identified with the key. An existing row of the key is overwritten.
 	* \param [in] aKey The key of the value to insert.
 	* \param [in] aValue the value of the key to insert.
 	*/
-	void insert( const QString& aKey, const QVariantList& aValue ) { mTable.insert( aKey, aValue ); }
+	void insert( const QString& aKey, const QVariantList& aValue );
+
+	/*!
+	* \brief Returns with the row of the key. A new key gets a new last row in which every value is missing.
+	* \param [in] aKey The key of the row.
+	* \return The row index.
+	*/
+	int insertRow( const QString& aKey );
+
+	/*!
+	* \brief Returns with the row of each key, the new keys get new last rows in one go in which every value is missing.
+	* \param [in] aKeys The keys, a key may occur more than once.
+	* \return The row index of each key.
+	*/
+	QVector< int > insertRows( const QVector< QString >& aKeys );
+
+	/*!
+	* \brief Overwrites a value with UTF-8 text, e.g. a field of a file, which is handled like a text QVariant.
+	* \param [in] aRowIndex The row index.
+	* \param [in] aColumnIndex The column index.
+	* \param [in] aText The text, not necessarily null-terminated.
+	* \param [in] aSize The size of the text in bytes.
+	*/
+	void setValueAt( int aRowIndex, int aColumnIndex, const char* aText, int aSize ) { mColumns[ aColumnIndex ].setValue( aRowIndex, aText, aSize ); }
 
 	/*!
 	* \brief Removes all values associated with the input key.
 	* \param [in] aKey The key of the value to remove.
 	* \return The number of values removed.
 	*/
-	int remove( const QString& aKey ) { return mTable.remove( aKey ); }
+	int remove( const QString& aKey );
+
+	/*!
+	* \brief Returns true if the key is located in the table.
+	*/
+	bool contains( const QString& aKey ) const { return rowIndex( aKey ) >= 0; }
 
 	/*!
 	* \brief Returns with the unique keys located in the table.
-	* \return The list of the unique keys.
+	* \return The list of the unique keys in row (insertion) order.
+	*/
+	QList< QString > keys() const { return mKeys; }
+
+	/*!
+	* \brief Returns with the symbols of the keys in row order, see keyPool().
+	*/
+	const QVector< Symbol >& keySymbols() const { return mKeySymbols; }
+
+	/*!
+	* \brief Returns with the pool the keys are interned in.
+	*/
+	const SymbolPool& keyPool() const { return mKeyPool; }
+
+	/*!
+	* \brief Returns with the row index of the key.
+	* \return The row index or -1 if the key is not in the table.
+	*/
+	int rowIndex( const QString& aKey ) const { return rowIndex( mKeyPool.find( aKey ) ); }
+
+	int rowIndex( Symbol aKeySymbol ) const { return aKeySymbol >= 0 && aKeySymbol < mRowIndices.size() ? mRowIndices.at( aKeySymbol ) : -1; }
+
+	const TabularDataColumn& columnData( int aColumnIndex ) const { return mColumns.at( aColumnIndex ); }
+
+	/*!
+	* \brief Returns with the column for filling it in place, e.g. by a loader. Its size must stay the row count.
 	*/
-	QList< QString > keys() const { return mTable.uniqueKeys(); }
+	TabularDataColumn& mutableColumnData( int aColumnIndex ) { return mColumns[ aColumnIndex ]; }
 
-	QVariantList column( unsigned int aColumnIndex );
+	/*!
+	* \brief Returns with a view over the values of a Float column without copying them.
+	* \param [in] aColumnIndex The column index.
+	* \return The view in row order, empty if the column is not a Float column. See ColumnView for its lifetime.
+	*/
+	ColumnView< double > columnView( int aColumnIndex ) const { return mColumns.at( aColumnIndex ).floatView(); }
 
-	QVariantList column( QString aColumnName );
+	ColumnView< double > columnView( const QString& aColumnName ) const;
 
-	QString columnName( int aColumnIndex ) const { return mHeader.value( QString::number( aColumnIndex ) ).toStringList().at( 0 ); }
+	/*!
+	* \brief Returns with a view over the values of an Integer column without copying them.
+	* \param [in] aColumnIndex The column index.
+	* \return The view in row order, empty if the column is not an Integer column.
+	*/
+	ColumnView< qint64 > integerColumnView( int aColumnIndex ) const { return mColumns.at( aColumnIndex ).integerView(); }
+
+	QVariantList column( unsigned int aColumnIndex ) const;
+
+	QVariantList column( const QString& aColumnName ) const;
+
+	QString columnName( int aColumnIndex ) const { return mSchema.name( aColumnIndex ); }
 
 	/*!
-	* \brief Clears the table.
+	* \brief Clears the table. The header and the column types are kept.
 	*/
-	void clear() { mTable.clear(); }
+	void clear();
 
-	unsigned int rowCount() const { return mTable.count(); }
+	/*!
+	* \brief Reserves room for the given number of rows in the keys and in every column, so that appending them allocates nothing.
+	*/
+	void reserve( int aRowCount );
 
-	unsigned int columnCount() const { return mHeader.size(); }
+	/*!
+	* \brief Sets the arena the columns created from now on allocate their buffers from, null for the heap.
+	* \details The arena is freed at once when the last column allocated from it is gone. Copies of the table do not take it over.
+	*/
+	void setArena( std::shared_ptr< lpmldata::Arena > aArena ) { mArena = std::move( aArena ); }
+
+	const std::shared_ptr< lpmldata::Arena >& arena() const { return mArena; }
+
+	unsigned int rowCount() const { return mKeys.size(); }
+
+	unsigned int columnCount() const { return mColumns.size(); }
 
 	const QString& name() const { return mName; }
 
 	QString& name() { return mName; }
 
 
+	/*!
+	* \brief Computes the statistics of all columns in one scan, columns are processed in parallel.
+	* \return The summary of each column.
+	*/
+	QVector< lpmldata::TabularDataColumnSummary > summary() const;
+
 	/*!
 	* \brief ...
 	* \param [in] ...
 	*/
-	double mean( unsigned int aColumnIndex );
+	double mean( unsigned int aColumnIndex ) const;
 
 	/*!
 	* \brief ...
 	* \param [in] ...
 	*/
-	double deviation( unsigned int aColumnIndex );
+	double deviation( unsigned int aColumnIndex ) const;
 
-	double min( unsigned int aColumnIndex );
-	double max( unsigned int aColumnIndex );
+	double min( unsigned int aColumnIndex ) const;
+	double max( unsigned int aColumnIndex ) const;
 
-	QVector< double > mins();
-	QVector< double > maxs();
+	QVector< double > mins() const;
+	QVector< double > maxs() const;
 
-	QVariantList means();
+	QVariantList means() const;
 
-	QVariantList deviations();
+	QVariantList deviations() const;
 
-	void mergeRecords( lpmldata::TabularData aTabularData );
-	static lpmldata::TabularData mergeFeatures( QList< lpmldata::TabularData > aTabularDatas, TabularDataMerge aMerge );
+	/*!
+	* \brief Computes the correlation of two columns over the rows where both have a value.
+	* \param [in] aFirstColumnIndex The index of the first column.
+	* \param [in] aSecondColumnIndex The index of the second column.
+	* \param [in] aCorrelation Pearson or Spearman.
+	* \return The correlation coefficient, NaN if it is undefined.
+	*/
+	double correlation( unsigned int aFirstColumnIndex, unsigned int aSecondColumnIndex, TabularDataCorrelation aCorrelation = TabularDataCorrelation::Pearson ) const;
 
-	friend QDataStream& TabularData::operator<<( QDataStream &out, TabularData& aTabularData )
+	/*!
+	* \brief Appends the rows of a table with the same features. Columns are matched by name, existing keys are overwritten.
+	* \param [in] aTabularData The table to append.
+	*/
+	void mergeRecords( const lpmldata::TabularData& aTabularData );
+
+	/*!
+	* \brief Merges tables either by appending their rows or by joining their columns on the keys.
+	* \details Row merge matches the columns by name, columns missing from a table are missing for its rows, and a key found in
+	* several tables gets the row of the last one. The merged columns are reserved once and filled by block copies in parallel.
+	* Column merge is a hash join: the merged keys are collected into one dictionary, the source row of every merged row
+	* is looked up once per table, then the merged columns are gathered in parallel. Values of keys missing from a table are missing.
+	* \param [in] aTabularDatas The tables to merge.
+	* \param [in] aMerge Rows or Columns.
+	* \param [in] aJoin The keys of a column merge, ignored when merging rows.
+	* \return The merged table.
+	*/
+	static lpmldata::TabularData mergeFeatures( const QList< lpmldata::TabularData >& aTabularDatas, TabularDataMerge aMerge, TabularDataJoin aJoin = TabularDataJoin::Outer );
+
+	/*!
+	* \brief Merges tables, reusing the storage of the inputs where possible. Row merge appends to the columns of the first table,
+	* column merge moves the columns of the tables whose rows already match the merged rows.
+	*/
+	static lpmldata::TabularData mergeFeatures( QList< lpmldata::TabularData >&& aTabularDatas, TabularDataMerge aMerge, TabularDataJoin aJoin = TabularDataJoin::Outer );
+
+	friend QDataStream& operator<<( QDataStream &out, const TabularData& aTabularData )
 	{
-		out << aTabularData.mTable
+		out << aTabularData.table()
 			<< aTabularData.mHeader
 			<< aTabularData.mName;
 
 		return out;
 	}
 
-	friend QDataStream& TabularData::operator>>( QDataStream &in, TabularData& aTabularData )
+	friend QDataStream& operator>>( QDataStream &in, TabularData& aTabularData )
 	{
-		in  >> aTabularData.mTable
-			>> aTabularData.mHeader
+		TabularDataTable table;
+		TabularDataHeader header;
+
+		in  >> table
+			>> header
 			>> aTabularData.mName;
 
+		aTabularData.mColumns.clear();
+		aTabularData.setHeader( header );
+		aTabularData.assignTable( table );
+
 		return in;
 	}
 
+private:
+	void resizeColumns( int aColumnCount );
+
+	/*!
+	* \brief Replaces the rows of the table with the rows of the hash, the header is kept.
+	*/
+	void assignTable( const TabularDataTable& aTable );
+
+	void appendKey( Symbol aKeySymbol );
+
+	/*!
+	* \brief Returns with the symbols of the keys of a table in the key pool of this table. Keys missing from the pool are
+	* interned if aIsInterned, -1 otherwise.
+	*/
+	QVector< Symbol > keySymbolsOf( const lpmldata::TabularData& aTabularData, bool aIsInterned );
+
+	void appendRows( const QList< const lpmldata::TabularData* >& aTabularDatas );
+
+	static lpmldata::TabularData joinColumns( const QList< lpmldata::TabularData >& aTabularDatas, TabularDataJoin aJoin, QList< lpmldata::TabularData >* aMovableTabularDatas );
 
 private:
-	lpmldata::TabularDataTable   mTable;        //!< The table containing the key and a respective variant list.
-	lpmldata::TabularDataHeader  mHeader;       //!< The table header containing the names and types of the columns. Key column is not taken into account.
-	QString                      mName;         //!< The name of the tabular data.
+	QList< QString >                      mKeys;         //!< The interned keys of the rows in row order.
+	QVector< lpmldata::Symbol >           mKeySymbols;   //!< The symbols of the keys in row order.
+	lpmldata::SymbolPool                  mKeyPool;      //!< The pool of the keys, shared by the copies of the table.
+	QVector< int >                        mRowIndices;   //!< The row index of each symbol of the pool, -1 for those which are no key.
+	QVector< lpmldata::TabularDataColumn > mColumns;      //!< The typed columns holding the values.
+	lpmldata::TabularDataHeader           mHeader;       //!< The table header containing the names and types of the columns. Key column is not taken into account.
+	lpmldata::TabularDataSchema           mSchema;       //!< The schema built from the header.
+	QString                               mName;         //!< The name of the tabular data.
+	std::shared_ptr< lpmldata::Arena >    mArena;        //!< The arena of the columns created by the table, null for the heap.
 
 };
 
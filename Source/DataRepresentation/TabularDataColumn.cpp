@@ -0,0 +1,1371 @@
+/*!
+* \file
+* Member function definitions for TabularDataColumn class. This file is part of DataRepresentation module.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#include <DataRepresentation/TabularDataColumn.h>
+#include <DataRepresentation/NumberParser.h>
+#include <QDebug>
+#include <QLocale>
+#include <QMetaType>
+#include <QVector>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+#if defined( CC_MSVC )
+#include <intrin.h>
+#endif
+
+namespace lpmldata
+{
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+const size_t kBufferAlignment = 64;
+const quint64 kMaxTextSize = std::numeric_limits< quint32 >::max(); // The text cells hold 32 bit offsets.
+
+void* allocateBuffer( size_t aSize )
+{
+	// aligned_alloc requires the size to be a multiple of the alignment.
+	size_t size = ( ( aSize + kBufferAlignment - 1 ) / kBufferAlignment ) * kBufferAlignment;
+	return aligned_malloc( kBufferAlignment, size == 0 ? kBufferAlignment : size );
+}
+
+void freeBuffer( void* aBuffer )
+{
+	if ( aBuffer != nullptr )
+	{
+		aligned_free( aBuffer );
+	}
+}
+
+int validityWordCount( int aRowCount )
+{
+	return ( aRowCount + 63 ) / 64;
+}
+
+int countTrailingZeros( quint64 aWord )
+{
+#if defined( CC_MSVC )
+	unsigned long index = 0;
+	_BitScanForward64( &index, aWord );
+	return int( index );
+#else
+	return __builtin_ctzll( aWord );
+#endif
+}
+
+void copyValidity( const quint64* aSource, int aSourceStart, quint64* aTarget, int aTargetStart, int aCount )
+{
+	for ( int bitIndex = 0; bitIndex < aCount; ++bitIndex )
+	{
+		int sourceBit = aSourceStart + bitIndex;
+		int targetBit = aTargetStart + bitIndex;
+		quint64 bit  = ( aSource[ sourceBit >> 6 ] >> ( sourceBit & 63 ) ) & 1;
+		quint64 mask = quint64( 1 ) << ( targetBit & 63 );
+		aTarget[ targetBit >> 6 ] = ( aTarget[ targetBit >> 6 ] & ~mask ) | ( bit << ( targetBit & 63 ) );
+	}
+}
+
+void removeBit( quint64* aWords, int aBit, int aBitCount )
+{
+	// Bits above the removed one move down by one, word by word.
+	int wordIndex = aBit >> 6;
+	int wordCount = validityWordCount( aBitCount );
+	quint64 lowMask = ( quint64( 1 ) << ( aBit & 63 ) ) - 1;
+	quint64 word = aWords[ wordIndex ];
+
+	aWords[ wordIndex ] = ( word & lowMask ) | ( ( word >> 1 ) & ~lowMask );
+	for ( ; wordIndex + 1 < wordCount; ++wordIndex )
+	{
+		aWords[ wordIndex ] |= aWords[ wordIndex + 1 ] << 63;
+		aWords[ wordIndex + 1 ] >>= 1;
+	}
+}
+
+bool isIntegral( const QVariant& aValue )
+{
+	switch ( aValue.userType() )
+	{
+	case QMetaType::Bool:
+	case QMetaType::Int:
+	case QMetaType::UInt:
+	case QMetaType::LongLong:
+	case QMetaType::ULongLong:
+	case QMetaType::Long:
+	case QMetaType::ULong:
+	case QMetaType::Short:
+	case QMetaType::UShort:
+	case QMetaType::Char:
+	case QMetaType::UChar:
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool isFloating( const QVariant& aValue )
+{
+	return aValue.userType() == QMetaType::Double || aValue.userType() == QMetaType::Float;
+}
+
+const int kSummaryBlockSize = 1024;  // Values per block; a block of doubles stays in L1 between its two sweeps.
+
+/*!
+* \brief Accumulates the summary of the valid values of a contiguous range.
+* \details The range is processed in blocks of 16 validity words. Every 64 values are handled according to their validity word:
+* fully valid words take a dense loop without any test, empty words are only counted and mixed words mask the values bit by bit.
+* Count, sum, minimum and maximum are accumulated branch-free in four independent lanes so that the compiler can vectorize the loops.
+* The squared deviations are then summed around the block mean while the block is still in cache, and the block is merged into the
+* running moments with the pairwise update of Chan et al., which is the blocked form of Welford's algorithm.
+*/
+template< typename T >
+void accumulateSummary( const T* aValues, const quint64* aValidity, int aSize, TabularDataColumnSummary& aSummary )
+{
+	double m2 = aSummary.variance * double( aSummary.count );
+
+	for ( int blockStart = 0; blockStart < aSize; blockStart += kSummaryBlockSize )
+	{
+		const T* block = aValues + blockStart;
+		const quint64* blockValidity = aValidity + ( blockStart >> 6 );
+		int blockSize = std::min( kSummaryBlockSize, aSize - blockStart );
+
+		double laneSum[ 4 ]   = { 0.0, 0.0, 0.0, 0.0 };
+		double laneCount[ 4 ] = { 0.0, 0.0, 0.0, 0.0 };
+		double laneMin[ 4 ]   = { DBL_MAX, DBL_MAX, DBL_MAX, DBL_MAX };
+		double laneMax[ 4 ]   = { -DBL_MAX, -DBL_MAX, -DBL_MAX, -DBL_MAX };
+
+		for ( int wordStart = 0; wordStart < blockSize; wordStart += 64 )
+		{
+			const T* values = block + wordStart;
+			int wordSize = std::min( 64, blockSize - wordStart );
+			quint64 word = blockValidity[ wordStart >> 6 ];
+
+			if ( wordSize == 64 && word == ~quint64( 0 ) )
+			{
+				for ( int index = 0; index < 64; index += 4 )
+				{
+					for ( int lane = 0; lane < 4; ++lane )
+					{
+						double value = double( values[ index + lane ] );
+						laneSum[ lane ]   += value;
+						laneCount[ lane ] += 1.0;
+						laneMin[ lane ]    = value < laneMin[ lane ] ? value : laneMin[ lane ];
+						laneMax[ lane ]    = value > laneMax[ lane ] ? value : laneMax[ lane ];
+					}
+				}
+			}
+			else if ( word != 0 )
+			{
+				for ( int index = 0; index < wordSize; ++index )
+				{
+					int lane = index & 3;
+					double value = double( values[ index ] );
+					bool isValid = ( ( word >> index ) & 1 ) != 0;
+					laneSum[ lane ]   += isValid ? value : 0.0;
+					laneCount[ lane ] += isValid ? 1.0 : 0.0;
+					laneMin[ lane ]    = isValid && value < laneMin[ lane ] ? value : laneMin[ lane ];
+					laneMax[ lane ]    = isValid && value > laneMax[ lane ] ? value : laneMax[ lane ];
+				}
+			}
+		}
+
+		double blockSum   = ( laneSum[ 0 ] + laneSum[ 1 ] ) + ( laneSum[ 2 ] + laneSum[ 3 ] );
+		double blockCount = ( laneCount[ 0 ] + laneCount[ 1 ] ) + ( laneCount[ 2 ] + laneCount[ 3 ] );
+		aSummary.min       = std::min( aSummary.min, std::min( std::min( laneMin[ 0 ], laneMin[ 1 ] ), std::min( laneMin[ 2 ], laneMin[ 3 ] ) ) );
+		aSummary.max       = std::max( aSummary.max, std::max( std::max( laneMax[ 0 ], laneMax[ 1 ] ), std::max( laneMax[ 2 ], laneMax[ 3 ] ) ) );
+		aSummary.nanCount += blockSize - qint64( blockCount );
+
+		if ( blockCount == 0.0 ) continue;
+
+		double blockMean = blockSum / blockCount;
+		double blockM2   = 0.0;
+		for ( int wordStart = 0; wordStart < blockSize; wordStart += 64 )
+		{
+			const T* values = block + wordStart;
+			int wordSize = std::min( 64, blockSize - wordStart );
+			quint64 word = blockValidity[ wordStart >> 6 ];
+
+			if ( wordSize == 64 && word == ~quint64( 0 ) )
+			{
+				for ( int index = 0; index < 64; ++index )
+				{
+					double deviation = double( values[ index ] ) - blockMean;
+					blockM2 += deviation * deviation;
+				}
+			}
+			else if ( word != 0 )
+			{
+				for ( int index = 0; index < wordSize; ++index )
+				{
+					double deviation = ( ( word >> index ) & 1 ) != 0 ? double( values[ index ] ) - blockMean : 0.0;
+					blockM2 += deviation * deviation;
+				}
+			}
+		}
+
+		// Merge the block into the running moments.
+		double runningCount = double( aSummary.count );
+		double totalCount   = runningCount + blockCount;
+		double delta        = blockMean - aSummary.mean;
+		aSummary.mean      += delta * blockCount / totalCount;
+		m2                 += blockM2 + delta * delta * runningCount * blockCount / totalCount;
+		aSummary.sum       += blockSum;
+		aSummary.count     += qint64( blockCount );
+	}
+
+	aSummary.variance = aSummary.count > 0 ? m2 / double( aSummary.count ) : 0.0;
+}
+
+/*!
+* \brief Computes the fractional ranks of the values selected by the mask, ties get their average rank. Other ranks are NaN.
+* \details The selected rows are collected by walking the set bits of the mask words.
+*/
+void rankValues( const double* aValues, const quint64* aMask, int aSize, double* aRanks )
+{
+	std::fill( aRanks, aRanks + aSize, std::numeric_limits< double >::quiet_NaN() );
+
+	std::vector< int > rows;
+	rows.reserve( aSize );
+	for ( int wordIndex = 0; wordIndex < validityWordCount( aSize ); ++wordIndex )
+	{
+		quint64 word = aMask[ wordIndex ];
+		if ( wordIndex == ( aSize >> 6 ) )
+		{
+			word &= ( quint64( 1 ) << ( aSize & 63 ) ) - 1;
+		}
+
+		while ( word != 0 )
+		{
+			rows.push_back( ( wordIndex << 6 ) + countTrailingZeros( word ) );
+			word &= word - 1;
+		}
+	}
+
+	std::sort( rows.begin(), rows.end(), [ aValues ]( int aLeft, int aRight ) { return aValues[ aLeft ] < aValues[ aRight ]; } );
+
+	for ( size_t tieStart = 0; tieStart < rows.size(); )
+	{
+		size_t tieEnd = tieStart + 1;
+		while ( tieEnd < rows.size() && aValues[ rows[ tieEnd ] ] == aValues[ rows[ tieStart ] ] )
+		{
+			++tieEnd;
+		}
+
+		double rank = 0.5 * double( tieStart + 1 + tieEnd );
+		for ( size_t index = tieStart; index < tieEnd; ++index )
+		{
+			aRanks[ rows[ index ] ] = rank;
+		}
+
+		tieStart = tieEnd;
+	}
+}
+
+/*!
+* \brief Computes the Pearson correlation of the value pairs selected by the mask, NaN if it is undefined.
+* \details Two passes, means first, then the centered sums. Words without a selected pair are skipped in the second pass.
+*/
+double pearsonCorrelation( const double* aFirst, const double* aSecond, const quint64* aMask, int aSize )
+{
+	double firstSum = 0.0, secondSum = 0.0, count = 0.0;
+
+	for ( int wordStart = 0; wordStart < aSize; wordStart += 64 )
+	{
+		int wordSize = std::min( 64, aSize - wordStart );
+		quint64 word = aMask[ wordStart >> 6 ];
+
+		for ( int index = 0; index < wordSize; ++index )
+		{
+			bool isValid = ( ( word >> index ) & 1 ) != 0;
+			firstSum  += isValid ? aFirst[ wordStart + index ] : 0.0;
+			secondSum += isValid ? aSecond[ wordStart + index ] : 0.0;
+			count     += isValid ? 1.0 : 0.0;
+		}
+	}
+
+	if ( count < 2.0 ) return std::numeric_limits< double >::quiet_NaN();
+
+	double firstMean = firstSum / count;
+	double secondMean = secondSum / count;
+	double covariance = 0.0, firstVariance = 0.0, secondVariance = 0.0;
+
+	for ( int wordStart = 0; wordStart < aSize; wordStart += 64 )
+	{
+		int wordSize = std::min( 64, aSize - wordStart );
+		quint64 word = aMask[ wordStart >> 6 ];
+		if ( word == 0 ) continue;
+
+		for ( int index = 0; index < wordSize; ++index )
+		{
+			bool isValid = ( ( word >> index ) & 1 ) != 0;
+			double firstDeviation = isValid ? aFirst[ wordStart + index ] - firstMean : 0.0;
+			double secondDeviation = isValid ? aSecond[ wordStart + index ] - secondMean : 0.0;
+			covariance     += firstDeviation * secondDeviation;
+			firstVariance  += firstDeviation * firstDeviation;
+			secondVariance += secondDeviation * secondDeviation;
+		}
+	}
+
+	if ( firstVariance == 0.0 || secondVariance == 0.0 ) return std::numeric_limits< double >::quiet_NaN();
+
+	return covariance / std::sqrt( firstVariance * secondVariance );
+}
+
+}
+
+//-----------------------------------------------------------------------------
+
+TabularDataColumn::TabularDataColumn( TabularDataColumnType aType, std::shared_ptr< lpmldata::Arena > aArena )
+:
+	mType( aType ),
+	mSize( 0 ),
+	mCapacity( 0 ),
+	mCells( nullptr ),
+	mValidity( nullptr ),
+	mText( nullptr ),
+	mTextSize( 0 ),
+	mTextCapacity( 0 ),
+	mStorage(),
+	mArena( std::move( aArena ) )
+{
+}
+
+//-----------------------------------------------------------------------------
+
+TabularDataColumn::TabularDataColumn( TabularDataColumnType aType, int aSize, const void* aCells, const quint64* aValidity, const char* aText, quint32 aTextSize, std::shared_ptr< const void > aStorage )
+:
+	mType( aType ),
+	mSize( aSize ),
+	mCapacity( aSize ),
+	mCells( const_cast< void* >( aCells ) ),
+	mValidity( const_cast< quint64* >( aValidity ) ),
+	mText( const_cast< char* >( aText ) ),
+	mTextSize( aTextSize ),
+	mTextCapacity( aTextSize ),
+	mStorage( std::move( aStorage ) ),
+	mArena()
+{
+}
+
+//-----------------------------------------------------------------------------
+
+TabularDataColumn::TabularDataColumn( const TabularDataColumn& aOther )
+:
+	mType( aOther.mType ),
+	mSize( aOther.mSize ),
+	mCapacity( aOther.mSize ),
+	mCells( nullptr ),
+	mValidity( nullptr ),
+	mText( nullptr ),
+	mTextSize( aOther.mTextSize ),
+	mTextCapacity( aOther.mTextSize ),
+	mStorage( aOther.mStorage ),
+	mArena()
+{
+	if ( mStorage )
+	{
+		// External buffers are read-only, the copy refers to the same ones.
+		mCells    = aOther.mCells;
+		mValidity = aOther.mValidity;
+		mText     = aOther.mText;
+		return;
+	}
+
+	if ( mSize > 0 )
+	{
+		mCells = allocate( size_t( mSize ) * sizeof( double ) );
+		std::memcpy( mCells, aOther.mCells, size_t( mSize ) * sizeof( double ) );
+
+		mValidity = static_cast< quint64* >( allocate( size_t( validityWordCount( mSize ) ) * sizeof( quint64 ) ) );
+		std::memcpy( mValidity, aOther.mValidity, size_t( validityWordCount( mSize ) ) * sizeof( quint64 ) );
+	}
+
+	if ( mTextSize > 0 )
+	{
+		mText = static_cast< char* >( allocate( mTextSize ) );
+		std::memcpy( mText, aOther.mText, mTextSize );
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+TabularDataColumn::TabularDataColumn( TabularDataColumn&& aOther )
+:
+	mType( aOther.mType ),
+	mSize( aOther.mSize ),
+	mCapacity( aOther.mCapacity ),
+	mCells( aOther.mCells ),
+	mValidity( aOther.mValidity ),
+	mText( aOther.mText ),
+	mTextSize( aOther.mTextSize ),
+	mTextCapacity( aOther.mTextCapacity ),
+	mStorage( std::move( aOther.mStorage ) ),
+	mArena( std::move( aOther.mArena ) )
+{
+	aOther.mSize         = 0;
+	aOther.mCapacity     = 0;
+	aOther.mCells        = nullptr;
+	aOther.mValidity     = nullptr;
+	aOther.mText         = nullptr;
+	aOther.mTextSize     = 0;
+	aOther.mTextCapacity = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+TabularDataColumn::~TabularDataColumn()
+{
+	releaseBuffers();
+}
+
+//-----------------------------------------------------------------------------
+
+TabularDataColumn& TabularDataColumn::operator=( const TabularDataColumn& aRight )
+{
+	if ( this != &aRight )
+	{
+		TabularDataColumn copy( aRight );
+		*this = std::move( copy );
+	}
+
+	return *this;
+}
+
+//-----------------------------------------------------------------------------
+
+TabularDataColumn& TabularDataColumn::operator=( TabularDataColumn&& aRight )
+{
+	if ( this != &aRight )
+	{
+		releaseBuffers();
+
+		mType         = aRight.mType;
+		mSize         = aRight.mSize;
+		mCapacity     = aRight.mCapacity;
+		mCells        = aRight.mCells;
+		mValidity     = aRight.mValidity;
+		mText         = aRight.mText;
+		mTextSize     = aRight.mTextSize;
+		mTextCapacity = aRight.mTextCapacity;
+		mStorage      = std::move( aRight.mStorage );
+		mArena        = std::move( aRight.mArena );
+
+		aRight.mSize         = 0;
+		aRight.mCapacity     = 0;
+		aRight.mCells        = nullptr;
+		aRight.mValidity     = nullptr;
+		aRight.mText         = nullptr;
+		aRight.mTextSize     = 0;
+		aRight.mTextCapacity = 0;
+	}
+
+	return *this;
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataColumn::reserve( int aCapacity )
+{
+	detach();
+
+	if ( aCapacity > mCapacity )
+	{
+		void* cells = allocate( size_t( aCapacity ) * sizeof( double ) );
+		if ( mSize > 0 )
+		{
+			std::memcpy( cells, mCells, size_t( mSize ) * sizeof( double ) );
+		}
+
+		// The validity words beyond the current ones start out cleared.
+		int wordCount = validityWordCount( aCapacity );
+		int previousWordCount = validityWordCount( mCapacity );
+		quint64* validity = static_cast< quint64* >( allocate( size_t( wordCount ) * sizeof( quint64 ) ) );
+		if ( previousWordCount > 0 )
+		{
+			std::memcpy( validity, mValidity, size_t( previousWordCount ) * sizeof( quint64 ) );
+		}
+		std::memset( validity + previousWordCount, 0, size_t( wordCount - previousWordCount ) * sizeof( quint64 ) );
+
+		release( mCells );
+		release( mValidity );
+		mCells    = cells;
+		mValidity = validity;
+		mCapacity = aCapacity;
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataColumn::grow( int aMinimumCapacity )
+{
+	if ( aMinimumCapacity > mCapacity )
+	{
+		reserve( std::max( aMinimumCapacity, mCapacity < 64 ? 64 : mCapacity * 2 ) );
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataColumn::resize( int aSize )
+{
+	detach();
+	grow( aSize );
+
+	for ( int rowIndex = mSize; rowIndex < aSize; ++rowIndex )
+	{
+		setMissing( rowIndex );
+	}
+
+	mSize = aSize;
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataColumn::clear()
+{
+	if ( mStorage )
+	{
+		releaseBuffers();
+		mCapacity     = 0;
+		mTextCapacity = 0;
+	}
+
+	mSize     = 0;
+	mTextSize = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+QVariant TabularDataColumn::value( int aRow ) const
+{
+	if ( !isValid( aRow ) ) return QString( "NA" );
+
+	switch ( mType )
+	{
+	case TabularDataColumnType::Float:
+		return static_cast< const double* >( mCells )[ aRow ];
+	case TabularDataColumnType::Integer:
+		return qlonglong( static_cast< const qint64* >( mCells )[ aRow ] );
+	case TabularDataColumnType::String:
+		return toString( aRow );
+	}
+
+	return QVariant();
+}
+
+//-----------------------------------------------------------------------------
+
+double TabularDataColumn::toDouble( int aRow ) const
+{
+	if ( !isValid( aRow ) ) return std::numeric_limits< double >::quiet_NaN();
+
+	switch ( mType )
+	{
+	case TabularDataColumnType::Float:
+		return static_cast< const double* >( mCells )[ aRow ];
+	case TabularDataColumnType::Integer:
+		return double( static_cast< const qint64* >( mCells )[ aRow ] );
+	case TabularDataColumnType::String:
+	{
+		bool isNumber = false;
+		double number = toString( aRow ).toDouble( &isNumber );
+		return isNumber ? number : std::numeric_limits< double >::quiet_NaN();
+	}
+	}
+
+	return std::numeric_limits< double >::quiet_NaN();
+}
+
+//-----------------------------------------------------------------------------
+
+QString TabularDataColumn::toString( int aRow ) const
+{
+	if ( !isValid( aRow ) ) return QString( "NA" );
+
+	switch ( mType )
+	{
+	case TabularDataColumnType::Float:
+		return QString::number( static_cast< const double* >( mCells )[ aRow ], 'g', QLocale::FloatingPointShortest );
+	case TabularDataColumnType::Integer:
+		return QString::number( static_cast< const qint64* >( mCells )[ aRow ] );
+	case TabularDataColumnType::String:
+	{
+		const TextCell& cell = static_cast< const TextCell* >( mCells )[ aRow ];
+		return QString::fromUtf8( mText + cell.offset, int( cell.length ) );
+	}
+	}
+
+	return QString();
+}
+
+//-----------------------------------------------------------------------------
+
+TabularDataColumnSummary TabularDataColumn::summary() const
+{
+	TabularDataColumnSummary summary = { 0, 0, 0.0, 0.0, 0.0, DBL_MAX, -DBL_MAX };
+
+	switch ( mType )
+	{
+	case TabularDataColumnType::Float:
+		accumulateSummary( static_cast< const double* >( mCells ), mValidity, mSize, summary );
+		break;
+	case TabularDataColumnType::Integer:
+		accumulateSummary( static_cast< const qint64* >( mCells ), mValidity, mSize, summary );
+		break;
+	case TabularDataColumnType::String:
+	{
+		QVector< double > numberBuffer;
+		QVector< quint64 > validityBuffer;
+		const quint64* validity = nullptr;
+		const double* numbers = toNumbers( numberBuffer, validityBuffer, validity );
+		accumulateSummary( numbers, validity, mSize, summary );
+		break;
+	}
+	}
+
+	if ( summary.count == 0 )
+	{
+		summary.mean = std::numeric_limits< double >::quiet_NaN();
+	}
+
+	return summary;
+}
+
+//-----------------------------------------------------------------------------
+
+QVector< double > TabularDataColumn::ranks() const
+{
+	QVector< double > numberBuffer;
+	QVector< quint64 > validityBuffer;
+	const quint64* validity = nullptr;
+	const double* numbers = toNumbers( numberBuffer, validityBuffer, validity );
+
+	QVector< double > ranks( mSize );
+	rankValues( numbers, validity, mSize, ranks.data() );
+
+	return ranks;
+}
+
+//-----------------------------------------------------------------------------
+
+double TabularDataColumn::correlation( const TabularDataColumn& aFirst, const TabularDataColumn& aSecond, TabularDataCorrelation aCorrelation )
+{
+	int size = std::min( aFirst.mSize, aSecond.mSize );
+
+	QVector< double > firstBuffer, secondBuffer;
+	QVector< quint64 > firstValidityBuffer, secondValidityBuffer;
+	const quint64* firstValidity = nullptr;
+	const quint64* secondValidity = nullptr;
+	const double* firstNumbers = aFirst.toNumbers( firstBuffer, firstValidityBuffer, firstValidity );
+	const double* secondNumbers = aSecond.toNumbers( secondBuffer, secondValidityBuffer, secondValidity );
+
+	// Only the rows valid in both columns take part.
+	QVector< quint64 > mask( validityWordCount( size ) );
+	for ( int wordIndex = 0; wordIndex < mask.size(); ++wordIndex )
+	{
+		mask[ wordIndex ] = firstValidity[ wordIndex ] & secondValidity[ wordIndex ];
+	}
+	if ( ( size & 63 ) != 0 )
+	{
+		mask.last() &= ( quint64( 1 ) << ( size & 63 ) ) - 1;
+	}
+
+	if ( aCorrelation == TabularDataCorrelation::Spearman )
+	{
+		QVector< double > firstRanks( size ), secondRanks( size );
+		rankValues( firstNumbers, mask.constData(), size, firstRanks.data() );
+		rankValues( secondNumbers, mask.constData(), size, secondRanks.data() );
+
+		return pearsonCorrelation( firstRanks.constData(), secondRanks.constData(), mask.constData(), size );
+	}
+
+	return pearsonCorrelation( firstNumbers, secondNumbers, mask.constData(), size );
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataColumn::setValue( int aRow, const QVariant& aValue )
+{
+	detach();
+
+	if ( !aValue.isValid() )
+	{
+		setMissing( aRow );
+		return;
+	}
+
+	switch ( mType )
+	{
+	case TabularDataColumnType::Integer:
+	{
+		if ( isIntegral( aValue ) )
+		{
+			static_cast< qint64* >( mCells )[ aRow ] = aValue.toLongLong();
+			setValid( aRow );
+			return;
+		}
+
+		if ( !isFloating( aValue ) )
+		{
+			QString text = aValue.toString();
+			if ( isMissing( text ) )
+			{
+				setMissing( aRow );
+				return;
+			}
+
+			bool isInteger = false;
+			qint64 integer = text.toLongLong( &isInteger );
+			if ( isInteger )
+			{
+				static_cast< qint64* >( mCells )[ aRow ] = integer;
+				setValid( aRow );
+				return;
+			}
+		}
+
+		// Fractional value: continue as a Float column.
+		convert( TabularDataColumnType::Float );
+		setValue( aRow, aValue );
+		return;
+	}
+	case TabularDataColumnType::Float:
+	{
+		if ( isFloating( aValue ) || isIntegral( aValue ) )
+		{
+			double number = aValue.toDouble();
+			if ( number != number )
+			{
+				setMissing( aRow );
+				return;
+			}
+
+			static_cast< double* >( mCells )[ aRow ] = number;
+			setValid( aRow );
+			return;
+		}
+
+		QString text = aValue.toString();
+		if ( isMissing( text ) )
+		{
+			setMissing( aRow );
+			return;
+		}
+
+		bool isNumber = false;
+		double number = text.toDouble( &isNumber );
+		if ( isNumber )
+		{
+			static_cast< double* >( mCells )[ aRow ] = number;
+			setValid( aRow );
+			return;
+		}
+
+		// Not a number: the column holds text.
+		convert( TabularDataColumnType::String );
+		setText( aRow, text );
+		return;
+	}
+	case TabularDataColumnType::String:
+	{
+		if ( isFloating( aValue ) && aValue.toDouble() != aValue.toDouble() )
+		{
+			setMissing( aRow );
+			return;
+		}
+
+		QString text = aValue.toString();
+		if ( isMissing( text ) )
+		{
+			setMissing( aRow );
+			return;
+		}
+
+		setText( aRow, text );
+		return;
+	}
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataColumn::setValue( int aRow, const char* aText, int aSize )
+{
+	detach();
+
+	if ( isMissing( aText, aSize ) )
+	{
+		setMissing( aRow );
+		return;
+	}
+
+	switch ( mType )
+	{
+	case TabularDataColumnType::Integer:
+	{
+		qint64 integer = 0;
+		if ( parseInteger( aText, aSize, integer ) )
+		{
+			static_cast< qint64* >( mCells )[ aRow ] = integer;
+			setValid( aRow );
+			return;
+		}
+
+		double number = 0.0;
+		if ( parseDouble( aText, aSize, number ) )
+		{
+			// Fractional value: continue as a Float column.
+			convert( TabularDataColumnType::Float );
+			setValue( aRow, aText, aSize );
+			return;
+		}
+
+		convert( TabularDataColumnType::String );
+		setText( aRow, aText, quint32( aSize ) );
+		return;
+	}
+	case TabularDataColumnType::Float:
+	{
+		double number = 0.0;
+		if ( parseDouble( aText, aSize, number ) )
+		{
+			if ( number != number )
+			{
+				setMissing( aRow );
+				return;
+			}
+
+			static_cast< double* >( mCells )[ aRow ] = number;
+			setValid( aRow );
+			return;
+		}
+
+		// Not a number: the column holds text.
+		convert( TabularDataColumnType::String );
+		setText( aRow, aText, quint32( aSize ) );
+		return;
+	}
+	case TabularDataColumnType::String:
+	{
+		setText( aRow, aText, quint32( aSize ) );
+		return;
+	}
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataColumn::append( const QVariant& aValue )
+{
+	detach();
+	grow( mSize + 1 );
+	setMissing( mSize );
+	++mSize;
+	setValue( mSize - 1, aValue );
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataColumn::gather( const TabularDataColumn& aSource, const int* aSourceRows, int aCount )
+{
+	clear();
+	mType = aSource.mType;
+
+	QVector< const TabularDataColumn* > sources( 1, &aSource );
+	append( sources, nullptr, aSourceRows, aCount );
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataColumn::append( const QVector< const TabularDataColumn* >& aSources, const int* aSourceIndices, const int* aSourceRows, int aCount )
+{
+	detach();
+
+	// Determine the type holding every value and the size of the text to be copied. An empty column takes the type of its sources.
+	TabularDataColumnType type = mType;
+	bool isTyped = mSize > 0;
+	quint64 textSize = 0;
+
+	for ( int rowIndex = 0; rowIndex < aCount; ++rowIndex )
+	{
+		const TabularDataColumn* source = aSources.at( aSourceIndices == nullptr ? 0 : aSourceIndices[ rowIndex ] );
+		int sourceRow = aSourceRows[ rowIndex ];
+
+		if ( source == nullptr || sourceRow < 0 ) continue;
+
+		if ( !isTyped )
+		{
+			type    = source->mType;
+			isTyped = true;
+		}
+
+		if ( source->mType == TabularDataColumnType::String )
+		{
+			type = TabularDataColumnType::String;
+			textSize += static_cast< const TextCell* >( source->mCells )[ sourceRow ].length;
+		}
+		else if ( source->mType != type && type != TabularDataColumnType::String )
+		{
+			type = TabularDataColumnType::Float;
+		}
+	}
+
+	convert( type );
+	reserve( mSize + aCount );
+	if ( mType == TabularDataColumnType::String )
+	{
+		// Above the text limit only the values which still fit are copied, see below.
+		growText( std::min( quint64( mTextSize ) + textSize, kMaxTextSize ) );
+	}
+
+	int rowIndex = 0;
+	while ( rowIndex < aCount )
+	{
+		int sourceIndex = aSourceIndices == nullptr ? 0 : aSourceIndices[ rowIndex ];
+		const TabularDataColumn* source = aSources.at( sourceIndex );
+		int sourceRow = aSourceRows[ rowIndex ];
+		int row = mSize + rowIndex;
+
+		if ( source == nullptr || sourceRow < 0 || !source->isValid( sourceRow ) )
+		{
+			setMissing( row );
+			++rowIndex;
+			continue;
+		}
+
+		// Numeric runs of the same type are copied as a block, together with their validity.
+		if ( source->mType == mType && mType != TabularDataColumnType::String )
+		{
+			int runEnd = rowIndex + 1;
+			while ( runEnd < aCount && ( aSourceIndices == nullptr || aSourceIndices[ runEnd ] == sourceIndex ) && aSourceRows[ runEnd ] == sourceRow + ( runEnd - rowIndex ) )
+			{
+				++runEnd;
+			}
+
+			std::memcpy( static_cast< char* >( mCells ) + size_t( row ) * sizeof( double ), static_cast< const char* >( source->mCells ) + size_t( sourceRow ) * sizeof( double ), size_t( runEnd - rowIndex ) * sizeof( double ) );
+			copyValidity( source->mValidity, sourceRow, mValidity, row, runEnd - rowIndex );
+			rowIndex = runEnd;
+			continue;
+		}
+
+		switch ( mType )
+		{
+		case TabularDataColumnType::Float:
+		{
+			double number = source->toDouble( sourceRow );
+			static_cast< double* >( mCells )[ row ] = number;
+			number == number ? setValid( row ) : setMissing( row );
+			break;
+		}
+		case TabularDataColumnType::Integer:
+			static_cast< qint64* >( mCells )[ row ] = static_cast< const qint64* >( source->mCells )[ sourceRow ];
+			setValid( row );
+			break;
+		case TabularDataColumnType::String:
+		{
+			if ( source->mType == TabularDataColumnType::String )
+			{
+				const TextCell& sourceCell = static_cast< const TextCell* >( source->mCells )[ sourceRow ];
+				if ( !growText( quint64( mTextSize ) + sourceCell.length ) )
+				{
+					qDebug() << "TabularDataColumn - ERROR: Text above 4 GB, the value is left missing.";
+					setMissing( row );
+					break;
+				}
+
+				TextCell& cell = static_cast< TextCell* >( mCells )[ row ];
+				if ( sourceCell.length > 0 )
+				{
+					std::memcpy( mText + mTextSize, source->mText + sourceCell.offset, sourceCell.length );
+				}
+				cell.offset = mTextSize;
+				cell.length = sourceCell.length;
+				mTextSize  += sourceCell.length;
+				setValid( row );
+			}
+			else
+			{
+				setText( row, source->toString( sourceRow ) );
+			}
+			break;
+		}
+		}
+
+		++rowIndex;
+	}
+
+	mSize += aCount;
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataColumn::remove( int aRow )
+{
+	detach();
+
+	char* cells = static_cast< char* >( mCells );
+	std::memmove( cells + size_t( aRow ) * sizeof( double ), cells + size_t( aRow + 1 ) * sizeof( double ), size_t( mSize - aRow - 1 ) * sizeof( double ) );
+	removeBit( mValidity, aRow, mSize );
+	--mSize;
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataColumn::convert( TabularDataColumnType aType )
+{
+	if ( aType == mType ) return;
+
+	detach();
+
+	if ( aType == TabularDataColumnType::String )
+	{
+		// Render the numbers before the cells get reinterpreted as text cells.
+		QStringList texts;
+		texts.reserve( mSize );
+		for ( int rowIndex = 0; rowIndex < mSize; ++rowIndex )
+		{
+			texts.push_back( isValid( rowIndex ) ? toString( rowIndex ) : QString() );
+		}
+
+		// Every cell is cleared first, so that no number is taken for the text of a row.
+		mType     = aType;
+		mTextSize = 0;
+		for ( int rowIndex = 0; rowIndex < mSize; ++rowIndex )
+		{
+			setMissing( rowIndex );
+		}
+
+		for ( int rowIndex = 0; rowIndex < mSize; ++rowIndex )
+		{
+			if ( !texts.at( rowIndex ).isNull() ) setText( rowIndex, texts.at( rowIndex ) );
+		}
+
+		return;
+	}
+
+	if ( aType == TabularDataColumnType::Float )
+	{
+		double* cells = static_cast< double* >( mCells );
+		for ( int rowIndex = 0; rowIndex < mSize; ++rowIndex )
+		{
+			double number = toDouble( rowIndex );
+			cells[ rowIndex ] = number;
+			if ( number != number )
+			{
+				clearValid( rowIndex );  // Text which is not a number.
+			}
+		}
+	}
+	else
+	{
+		qint64* cells = static_cast< qint64* >( mCells );
+		for ( int rowIndex = 0; rowIndex < mSize; ++rowIndex )
+		{
+			double number = toDouble( rowIndex );
+			cells[ rowIndex ] = number != number ? 0 : qint64( number );
+			if ( number != number )
+			{
+				clearValid( rowIndex );
+			}
+		}
+	}
+
+	mType     = aType;
+	mTextSize = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataColumn::reset( TabularDataColumnType aType, quint32 aTextCapacity )
+{
+	detach();
+
+	mType     = aType;
+	mTextSize = 0;
+	for ( int rowIndex = 0; rowIndex < mSize; ++rowIndex )
+	{
+		setMissing( rowIndex );
+	}
+
+	if ( aTextCapacity > 0 )
+	{
+		growText( aTextCapacity );
+		std::memset( mText, 0, aTextCapacity );
+		mTextSize = aTextCapacity;
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataColumn::fill( int aRow, const char* aText, quint32 aSize, quint32 aOffset )
+{
+	std::memcpy( mText + aOffset, aText, aSize );
+
+	TextCell& cell = static_cast< TextCell* >( mCells )[ aRow ];
+	cell.offset = aOffset;
+	cell.length = aSize;
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataColumn::fillValidity( int aWordIndex, quint64 aBits )
+{
+#if defined( CC_MSVC )
+	_InterlockedOr64( reinterpret_cast< volatile __int64* >( mValidity + aWordIndex ), __int64( aBits ) );
+#else
+	__atomic_fetch_or( mValidity + aWordIndex, aBits, __ATOMIC_RELAXED );
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+const double* TabularDataColumn::toNumbers( QVector< double >& aNumberBuffer, QVector< quint64 >& aValidityBuffer, const quint64*& aValidity ) const
+{
+	aValidity = mValidity;
+	if ( mType == TabularDataColumnType::Float ) return static_cast< const double* >( mCells );
+
+	aNumberBuffer.resize( mSize );
+	for ( int rowIndex = 0; rowIndex < mSize; ++rowIndex )
+	{
+		aNumberBuffer[ rowIndex ] = toDouble( rowIndex );
+	}
+
+	if ( mType == TabularDataColumnType::String )
+	{
+		// Text which is not a number is not valid as a number.
+		aValidityBuffer.fill( 0, validityWordCount( mSize ) );
+		for ( int rowIndex = 0; rowIndex < mSize; ++rowIndex )
+		{
+			double number = aNumberBuffer.at( rowIndex );
+			aValidityBuffer[ rowIndex >> 6 ] |= quint64( number == number ? 1 : 0 ) << ( rowIndex & 63 );
+		}
+		aValidity = aValidityBuffer.constData();
+	}
+
+	return aNumberBuffer.constData();
+}
+
+//-----------------------------------------------------------------------------
+
+bool TabularDataColumn::isMissing( const QString& aText )
+{
+	return aText.isEmpty() || aText == "NA" || aText.compare( "nan", Qt::CaseInsensitive ) == 0;
+}
+
+//-----------------------------------------------------------------------------
+
+bool TabularDataColumn::isMissing( const char* aText, int aSize )
+{
+	switch ( aSize )
+	{
+	case 0:
+		return true;
+	case 2:
+		return aText[ 0 ] == 'N' && aText[ 1 ] == 'A';
+	case 3:
+		return ( aText[ 0 ] | 0x20 ) == 'n' && ( aText[ 1 ] | 0x20 ) == 'a' && ( aText[ 2 ] | 0x20 ) == 'n';
+	default:
+		return false;
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataColumn::detach()
+{
+	if ( !mStorage ) return;
+
+	void* cells = nullptr;
+	quint64* validity = nullptr;
+	char* text = nullptr;
+
+	if ( mSize > 0 )
+	{
+		cells = allocate( size_t( mSize ) * sizeof( double ) );
+		std::memcpy( cells, mCells, size_t( mSize ) * sizeof( double ) );
+
+		validity = static_cast< quint64* >( allocate( size_t( validityWordCount( mSize ) ) * sizeof( quint64 ) ) );
+		std::memcpy( validity, mValidity, size_t( validityWordCount( mSize ) ) * sizeof( quint64 ) );
+	}
+
+	if ( mTextSize > 0 )
+	{
+		text = static_cast< char* >( allocate( mTextSize ) );
+		std::memcpy( text, mText, mTextSize );
+	}
+
+	mStorage.reset();
+	mCells        = cells;
+	mValidity     = validity;
+	mText         = text;
+	mCapacity     = mSize;
+	mTextCapacity = mTextSize;
+}
+
+//-----------------------------------------------------------------------------
+
+void* TabularDataColumn::allocate( size_t aSize )
+{
+	return mArena ? mArena->allocate( aSize ) : allocateBuffer( aSize );
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataColumn::release( void* aBuffer )
+{
+	// Arena blocks are freed with the arena.
+	if ( !mArena )
+	{
+		freeBuffer( aBuffer );
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataColumn::releaseBuffers()
+{
+	if ( !mStorage )
+	{
+		release( mCells );
+		release( mValidity );
+		release( mText );
+	}
+
+	mStorage.reset();
+	mCells    = nullptr;
+	mValidity = nullptr;
+	mText     = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+
+bool TabularDataColumn::growText( quint64 aMinimumCapacity )
+{
+	if ( aMinimumCapacity > kMaxTextSize ) return false;
+
+	if ( aMinimumCapacity > mTextCapacity )
+	{
+		quint64 capacity = std::min( std::max( aMinimumCapacity, mTextCapacity < 4096 ? quint64( 4096 ) : quint64( mTextCapacity ) * 2 ), kMaxTextSize );
+		char* text = static_cast< char* >( allocate( size_t( capacity ) ) );
+		if ( mTextSize > 0 )
+		{
+			std::memcpy( text, mText, mTextSize );
+		}
+
+		release( mText );
+		mText         = text;
+		mTextCapacity = quint32( capacity );
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataColumn::setText( int aRow, const QString& aText )
+{
+	QByteArray utf8 = aText.toUtf8();
+	setText( aRow, utf8.constData(), quint32( utf8.size() ) );
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataColumn::setText( int aRow, const char* aText, quint32 aSize )
+{
+	TextCell& cell = static_cast< TextCell* >( mCells )[ aRow ];
+
+	// Text which fits in the place of the text it replaces is written over it; cells never share text.
+	if ( aRow < mSize && isValid( aRow ) && aSize <= cell.length )
+	{
+		std::memmove( mText + cell.offset, aText, aSize );
+		cell.length = aSize;
+		return;
+	}
+
+	// Otherwise the replaced text is left behind and dropped when the full buffer is repacked.
+	clearValid( aRow );
+	if ( quint64( mTextSize ) + aSize > mTextCapacity && !compactText( std::max( mSize, aRow ), aSize ) )
+	{
+		qDebug() << "TabularDataColumn - ERROR: Text above 4 GB, the value is left missing.";
+		return;
+	}
+
+	std::memcpy( mText + mTextSize, aText, aSize );
+	cell.offset = mTextSize;
+	cell.length = aSize;
+
+	mTextSize += aSize;
+	setValid( aRow );
+}
+
+//-----------------------------------------------------------------------------
+
+bool TabularDataColumn::compactText( int aRowCount, quint32 aExtraSize )
+{
+	TextCell* cells = static_cast< TextCell* >( mCells );
+
+	quint64 liveSize = 0;
+	for ( int rowIndex = 0; rowIndex < aRowCount; ++rowIndex )
+	{
+		if ( isValid( rowIndex ) ) liveSize += cells[ rowIndex ].length;
+	}
+
+	if ( liveSize + aExtraSize > kMaxTextSize ) return false;
+
+	// The text of the valid rows is packed into a buffer twice its size, so that repacking is amortized like growth.
+	quint64 capacity = std::min( std::max( ( liveSize + aExtraSize ) * 2, quint64( 4096 ) ), kMaxTextSize );
+	char* text = static_cast< char* >( allocate( size_t( capacity ) ) );
+	quint32 textSize = 0;
+	for ( int rowIndex = 0; rowIndex < aRowCount; ++rowIndex )
+	{
+		if ( !isValid( rowIndex ) ) continue;
+
+		TextCell& cell = cells[ rowIndex ];
+		std::memcpy( text + textSize, mText + cell.offset, cell.length );
+		cell.offset = textSize;
+		textSize   += cell.length;
+	}
+
+	release( mText );
+	mText         = text;
+	mTextSize     = textSize;
+	mTextCapacity = quint32( capacity );
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataColumn::setMissing( int aRow )
+{
+	clearValid( aRow );
+
+	switch ( mType )
+	{
+	case TabularDataColumnType::Float:
+		static_cast< double* >( mCells )[ aRow ] = std::numeric_limits< double >::quiet_NaN();
+		break;
+	case TabularDataColumnType::Integer:
+		static_cast< qint64* >( mCells )[ aRow ] = 0;
+		break;
+	case TabularDataColumnType::String:
+		static_cast< TextCell* >( mCells )[ aRow ] = { 0, 0 };
+		break;
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+}
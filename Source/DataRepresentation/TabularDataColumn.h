@@ -0,0 +1,385 @@
+/*!
+* \file This file is part of Datarepresentation module.
+* The TabularDataColumn class is the typed, contiguous storage of one column of a TabularData.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#pragma once
+
+#include <DataRepresentation/Export.h>
+#include <DataRepresentation/Types.h>
+#include <DataRepresentation/ColumnView.h>
+#include <DataRepresentation/Arena.h>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+#include <memory>
+
+namespace lpmldata
+{
+
+//-----------------------------------------------------------------------------
+
+enum class TabularDataColumnType
+{
+	Float = 0,
+	Integer,
+	String
+};
+
+enum class TabularDataCorrelation
+{
+	Pearson = 0,
+	Spearman
+};
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Descriptive statistics of a column. Missing values are counted but excluded from the statistics.
+*/
+struct TabularDataColumnSummary
+{
+	qint64  count;      //!< The number of valid values.
+	qint64  nanCount;   //!< The number of missing values.
+	double  sum;        //!< The sum of the valid values.
+	double  mean;       //!< The mean of the valid values.
+	double  variance;   //!< The population variance of the valid values.
+	double  min;        //!< The minimum of the valid values, DBL_MAX if there is none.
+	double  max;        //!< The maximum of the valid values, -DBL_MAX if there is none.
+};
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Typed column storage of tabular data.
+*
+* \details Every row occupies one 8 byte cell in a single 64 byte aligned buffer. The cell holds a double for Float columns,
+* a 64 bit integer for Integer columns and an offset-length pair into the UTF-8 text buffer of the column for String columns.
+* Whether a row holds a value is tracked in a validity bitmap, one bit per row, least significant bit first, in 64 bit words.
+* Missing rows keep a neutral cell (NaN, 0 or empty text), the kernels skip them by the bitmap and never look at text.
+* Text replaced by text of the same size or shorter is overwritten in place; longer text is appended and the replaced text
+* is dropped when the full text buffer is repacked instead of grown. The text offsets are 32 bit, so the text buffer of a column
+* is limited to 4 GB; text which does not fit any more is refused and its row is left missing.
+* A column is promoted (Integer -> Float -> String) when a value does not fit its type.
+* The buffers can also be external, e.g. mapped from a file: such a column is read-only until its first modification, which
+* copies the buffers. Copies of an external column share its buffers.
+* A column constructed with an arena allocates its buffers from the arena and never frees them one by one; the memory is
+* released with the arena, which the column keeps alive. Copies of such a column allocate from the heap.
+*/
+class DataRepresentation_API TabularDataColumn
+{
+
+public:
+	/*!
+	* \brief Constructor.
+	* \param [in] aType Type of the column.
+	* \param [in] aArena The arena to allocate the buffers from, null for the heap.
+	*/
+	TabularDataColumn( TabularDataColumnType aType = TabularDataColumnType::Float, std::shared_ptr< lpmldata::Arena > aArena = nullptr );
+
+	/*!
+	* \brief Constructor over external buffers, which are not copied until the column is modified.
+	* \param [in] aType Type of the column.
+	* \param [in] aSize Number of rows.
+	* \param [in] aCells Buffer of aSize 8 byte cells; String cells are ( 32 bit offset, 32 bit length ) pairs into aText.
+	* \param [in] aValidity Validity bitmap of at least ( aSize + 63 ) / 64 words.
+	* \param [in] aText UTF-8 text buffer of a String column, nullptr otherwise.
+	* \param [in] aTextSize Size of the text buffer in bytes.
+	* \param [in] aStorage Owner of the buffers, kept alive as long as a column refers to them.
+	*/
+	TabularDataColumn( TabularDataColumnType aType, int aSize, const void* aCells, const quint64* aValidity, const char* aText, quint32 aTextSize, std::shared_ptr< const void > aStorage );
+
+	/*!
+	* \brief Copy constructor.
+	* \param [in] aOther Object to copy.
+	*/
+	TabularDataColumn( const TabularDataColumn& aOther );
+
+	/*!
+	* \brief Move constructor.
+	* \param [in] aOther Object to move.
+	*/
+	TabularDataColumn( TabularDataColumn&& aOther );
+
+	/*!
+	* \brief Destructor.
+	*/
+	~TabularDataColumn();
+
+	TabularDataColumn& operator=( const TabularDataColumn& aRight );
+
+	TabularDataColumn& operator=( TabularDataColumn&& aRight );
+
+	TabularDataColumnType type() const { return mType; }
+
+	/*!
+	* \brief Returns with the number of rows stored in the column.
+	*/
+	int size() const { return mSize; }
+
+	/*!
+	* \brief Preallocates storage for the given number of rows.
+	* \param [in] aCapacity The number of rows to preallocate.
+	*/
+	void reserve( int aCapacity );
+
+	/*!
+	* \brief Resizes the column. New rows are filled up with missing values.
+	* \param [in] aSize The new number of rows.
+	*/
+	void resize( int aSize );
+
+	/*!
+	* \brief Removes all rows but keeps the type of the column.
+	*/
+	void clear();
+
+	/*!
+	* \brief Returns with the contiguous cell buffer of a Float column. Values written through it are not marked valid.
+	* \return Pointer to the first cell or nullptr in case the column is not a Float column.
+	*/
+	const double* floats() const { return mType == TabularDataColumnType::Float ? static_cast< const double* >( mCells ) : nullptr; }
+
+	double* floats() { detach(); return mType == TabularDataColumnType::Float ? static_cast< double* >( mCells ) : nullptr; }
+
+	/*!
+	* \brief Returns with the contiguous cell buffer of an Integer column.
+	* \return Pointer to the first cell or nullptr in case the column is not an Integer column.
+	*/
+	const qint64* integers() const { return mType == TabularDataColumnType::Integer ? static_cast< const qint64* >( mCells ) : nullptr; }
+
+	qint64* integers() { detach(); return mType == TabularDataColumnType::Integer ? static_cast< qint64* >( mCells ) : nullptr; }
+
+	/*!
+	* \brief Returns with the raw cell buffer of size() 8 byte cells in the layout of the column type.
+	*/
+	const void* cells() const { return mCells; }
+
+	/*!
+	* \brief Returns with the UTF-8 text buffer the cells of a String column refer to.
+	*/
+	const char* text() const { return mText; }
+
+	quint32 textSize() const { return mTextSize; }
+
+	/*!
+	* \brief Returns with the UTF-8 text of a row of a String column, without copying it.
+	* \param [in] aRow The row index.
+	* \param [out] aSize The size of the text in bytes.
+	*/
+	const char* textAt( int aRow, int& aSize ) const
+	{
+		const TextCell& cell = static_cast< const TextCell* >( mCells )[ aRow ];
+		aSize = int( cell.length );
+		return mText + cell.offset;
+	}
+
+	/*!
+	* \brief Returns true if the column refers to external buffers.
+	*/
+	bool isExternal() const { return mStorage != nullptr; }
+
+	/*!
+	* \brief Returns with the arena the buffers are allocated from, null if they come from the heap.
+	*/
+	const std::shared_ptr< lpmldata::Arena >& arena() const { return mArena; }
+
+	/*!
+	* \brief Returns with a view over the values of a Float column, empty for other column types.
+	*/
+	ColumnView< double > floatView() const { return ColumnView< double >( floats(), mSize ); }
+
+	/*!
+	* \brief Returns with a view over the values of an Integer column, empty for other column types.
+	*/
+	ColumnView< qint64 > integerView() const { return ColumnView< qint64 >( integers(), mSize ); }
+
+	/*!
+	* \brief Returns true if the row holds a value, false if it is missing.
+	*/
+	bool isValid( int aRow ) const { return ( ( mValidity[ aRow >> 6 ] >> ( aRow & 63 ) ) & 1 ) != 0; }
+
+	/*!
+	* \brief Returns with the validity bitmap: bit ( aRow & 63 ) of word ( aRow >> 6 ) is set if the row holds a value.
+	*/
+	const quint64* validity() const { return mValidity; }
+
+	/*!
+	* \brief Returns with the value of the given row in its variant form, "NA" for a missing row, as toString() gives it.
+	* \param [in] aRow The row index.
+	*/
+	QVariant value( int aRow ) const;
+
+	/*!
+	* \brief Returns with the value of the given row as double. Text is converted, missing values are NaN.
+	* \param [in] aRow The row index.
+	*/
+	double toDouble( int aRow ) const;
+
+	/*!
+	* \brief Returns with the value of the given row as text, NA for a missing row.
+	* \param [in] aRow The row index.
+	*/
+	QString toString( int aRow ) const;
+
+	/*!
+	* \brief Computes count, sum, mean, variance, minimum and maximum of the column in a single pass.
+	* \return The summary of the column. Text cells which are not numbers count as missing.
+	*/
+	TabularDataColumnSummary summary() const;
+
+	/*!
+	* \brief Computes the rank of each value, ties get their average rank.
+	* \return The ranks starting from 1, NaN for missing rows and for text which is not a number.
+	*/
+	QVector< double > ranks() const;
+
+	/*!
+	* \brief Computes the correlation of two columns over the rows valid in both. The validity bitmaps are combined word by word.
+	* \param [in] aFirst The first column.
+	* \param [in] aSecond The second column.
+	* \param [in] aCorrelation Pearson or Spearman (Pearson of the ranks of the commonly valid rows).
+	* \return The correlation coefficient, NaN if there are less than two common values or one of the columns is constant.
+	*/
+	static double correlation( const TabularDataColumn& aFirst, const TabularDataColumn& aSecond, TabularDataCorrelation aCorrelation = TabularDataCorrelation::Pearson );
+
+	/*!
+	* \brief Overwrites the value of the given row. The column gets promoted if the value does not fit its type.
+	* \param [in] aRow The row index.
+	* \param [in] aValue The new value.
+	*/
+	void setValue( int aRow, const QVariant& aValue );
+
+	/*!
+	* \brief Overwrites the value of the given row with UTF-8 text, which is handled like a text QVariant.
+	* \details Numbers are parsed by parseDouble() and parseInteger(), text of a String column is copied as is; neither goes
+	* through QString.
+	* \param [in] aRow The row index.
+	* \param [in] aText The text, not necessarily null-terminated.
+	* \param [in] aSize The size of the text in bytes.
+	*/
+	void setValue( int aRow, const char* aText, int aSize );
+
+	/*!
+	* \brief Appends a new row holding the given value.
+	* \param [in] aValue The value to append.
+	*/
+	void append( const QVariant& aValue );
+
+	/*!
+	* \brief Replaces the rows of the column with rows gathered from another column, taking over its type.
+	* \details Text is copied into a text buffer allocated once. Missing rows stay missing without changing the type.
+	* \param [in] aSource The column to gather from, must not be this column.
+	* \param [in] aSourceRows The source row index of each row, negative for a missing row.
+	* \param [in] aCount The number of rows to gather.
+	*/
+	void gather( const TabularDataColumn& aSource, const int* aSourceRows, int aCount );
+
+	/*!
+	* \brief Appends rows gathered from several columns. The column is promoted once to a type that holds all appended values.
+	* \details Runs of consecutive rows of a source with the same type are copied as blocks.
+	* \param [in] aSources The columns to gather from, nullptr for a column that does not exist in its table.
+	* \param [in] aSourceIndices The index into aSources of each appended row, nullptr if every row comes from the first source.
+	* \param [in] aSourceRows The source row index of each appended row, negative for a missing row.
+	* \param [in] aCount The number of rows to append.
+	*/
+	void append( const QVector< const TabularDataColumn* >& aSources, const int* aSourceIndices, const int* aSourceRows, int aCount );
+
+	/*!
+	* \brief Removes the given row, keeping the order of the remaining rows.
+	* \param [in] aRow The row index.
+	*/
+	void remove( int aRow );
+
+	/*!
+	* \brief Converts all values of the column to the given type.
+	* \param [in] aType The target type.
+	*/
+	void convert( TabularDataColumnType aType );
+
+	/*!
+	* \brief Makes every row missing and changes the type of the column without converting the values.
+	* \details Prepares the column to be filled by fill() and fillValidity(), which never reallocate or promote, so that
+	* several threads can fill distinct rows at the same time. The text of the column is aTextCapacity zero bytes.
+	* \param [in] aType The new type.
+	* \param [in] aTextCapacity The size of the text buffer the String cells get their text placed in.
+	*/
+	void reset( TabularDataColumnType aType, quint32 aTextCapacity = 0 );
+
+	/*!
+	* \brief Stores a number in a row of a Float column. The row becomes valid only through fillValidity().
+	*/
+	void fill( int aRow, double aValue ) { static_cast< double* >( mCells )[ aRow ] = aValue; }
+
+	/*!
+	* \brief Stores a number in a row of an Integer column. The row becomes valid only through fillValidity().
+	*/
+	void fill( int aRow, qint64 aValue ) { static_cast< qint64* >( mCells )[ aRow ] = aValue; }
+
+	/*!
+	* \brief Stores text at the given offset of the text buffer of a String column. The row becomes valid only through fillValidity().
+	* \param [in] aRow The row index.
+	* \param [in] aText The UTF-8 text.
+	* \param [in] aSize The size of the text in bytes.
+	* \param [in] aOffset The offset of the text in the text buffer, the text must fit into the capacity given to reset().
+	*/
+	void fill( int aRow, const char* aText, quint32 aSize, quint32 aOffset );
+
+	/*!
+	* \brief Atomically marks the rows of a validity word valid, rows sharing a word may be filled by different threads.
+	* \param [in] aWordIndex The index of the validity word, it covers the rows from 64 * aWordIndex.
+	* \param [in] aBits The bits of the rows to mark valid.
+	*/
+	void fillValidity( int aWordIndex, quint64 aBits );
+
+	/*!
+	* \brief Returns true if the text represents a missing value (empty, NA or nan).
+	*/
+	static bool isMissing( const QString& aText );
+
+	static bool isMissing( const char* aText, int aSize );
+
+private:
+
+	struct TextCell
+	{
+		quint32 offset;
+		quint32 length;
+	};
+
+	void detach();
+	void* allocate( size_t aSize );
+	void release( void* aBuffer );
+	void releaseBuffers();
+	const double* toNumbers( QVector< double >& aNumberBuffer, QVector< quint64 >& aValidityBuffer, const quint64*& aValidity ) const;
+	void grow( int aMinimumCapacity );
+	bool growText( quint64 aMinimumCapacity );
+	bool compactText( int aRowCount, quint32 aExtraSize );
+	void setText( int aRow, const QString& aText );
+	void setText( int aRow, const char* aText, quint32 aSize );
+	void setMissing( int aRow );
+	void setValid( int aRow ) { mValidity[ aRow >> 6 ] |= quint64( 1 ) << ( aRow & 63 ); }
+	void clearValid( int aRow ) { mValidity[ aRow >> 6 ] &= ~( quint64( 1 ) << ( aRow & 63 ) ); }
+
+private:
+	TabularDataColumnType         mType;            //!< The type of the values stored in the column.
+	int                           mSize;            //!< The number of rows.
+	int                           mCapacity;        //!< The number of rows the cell buffer can hold.
+	void*                         mCells;           //!< Aligned buffer of 8 byte cells, one per row.
+	quint64*                      mValidity;        //!< Validity bitmap, one bit per row of the capacity.
+	char*                         mText;            //!< Aligned UTF-8 buffer of String columns.
+	quint32                       mTextSize;        //!< The number of used bytes in the text buffer.
+	quint32                       mTextCapacity;    //!< The capacity of the text buffer in bytes.
+	std::shared_ptr< const void > mStorage;         //!< The owner of external buffers, null if the column owns its buffers.
+	std::shared_ptr< Arena >      mArena;           //!< The arena of the buffers, null if they are allocated from the heap.
+
+};
+
+//-----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,130 @@
+/*!
+* \file
+* Member function definitions for TabularDataSchema class. This file is part of DataRepresentation module.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#include <DataRepresentation/TabularDataSchema.h>
+
+namespace lpmldata
+{
+
+//-----------------------------------------------------------------------------
+
+TabularDataSchema::TabularDataSchema()
+:
+	mNames(),
+	mSymbols(),
+	mTypes(),
+	mNamePool(),
+	mIndices()
+{
+}
+
+//-----------------------------------------------------------------------------
+
+TabularDataSchema::TabularDataSchema( const TabularDataHeader& aHeader )
+:
+	mNames(),
+	mSymbols(),
+	mTypes(),
+	mNamePool(),
+	mIndices()
+{
+	mNames.reserve( aHeader.size() );
+	mSymbols.reserve( aHeader.size() );
+	mTypes.reserve( aHeader.size() );
+	mNamePool.reserve( aHeader.size() );
+	mIndices.reserve( aHeader.size() );
+
+	for ( int headerIndex = 0; headerIndex < aHeader.size(); ++headerIndex )
+	{
+		QStringList headerColumnDescriptor = aHeader.value( QString::number( headerIndex ) ).toStringList();
+		QString name = headerColumnDescriptor.isEmpty() ? QString() : headerColumnDescriptor.at( 0 );
+		QString type = headerColumnDescriptor.size() > 1 ? headerColumnDescriptor.at( 1 ) : QString( "Float" );
+
+		append( name, typeFromName( type ) );
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataSchema::append( const QString& aColumnName, TabularDataColumnType aType )
+{
+	// Symbols are dense: a new name gets the next one.
+	Symbol symbol = mNamePool.intern( aColumnName );
+
+	if ( symbol == mIndices.size() )
+	{
+		mIndices.push_back( mNames.size() );
+	}
+
+	mNames.push_back( mNamePool.string( symbol ) );
+	mSymbols.push_back( symbol );
+	mTypes.push_back( aType );
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataSchema::clear()
+{
+	mNames.clear();
+	mSymbols.clear();
+	mTypes.clear();
+	mNamePool = SymbolPool();
+	mIndices.clear();
+}
+
+//-----------------------------------------------------------------------------
+
+TabularDataHeader TabularDataSchema::toHeader() const
+{
+	TabularDataHeader header;
+
+	for ( int columnIndex = 0; columnIndex < mNames.size(); ++columnIndex )
+	{
+		QVariantList headerValue = { mNames.at( columnIndex ), typeName( mTypes.at( columnIndex ) ) };
+		header.insert( QString::number( columnIndex ), headerValue );
+	}
+
+	return header;
+}
+
+//-----------------------------------------------------------------------------
+
+TabularDataColumnType TabularDataSchema::typeFromName( const QString& aTypeName )
+{
+	if ( aTypeName == "Integer" )
+	{
+		return TabularDataColumnType::Integer;
+	}
+	else if ( aTypeName == "String" )
+	{
+		return TabularDataColumnType::String;
+	}
+
+	return TabularDataColumnType::Float;
+}
+
+//-----------------------------------------------------------------------------
+
+QString TabularDataSchema::typeName( TabularDataColumnType aType )
+{
+	switch ( aType )
+	{
+	case TabularDataColumnType::Integer:
+		return "Integer";
+	case TabularDataColumnType::String:
+		return "String";
+	default:
+		return "Float";
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,122 @@
+/*!
+* \file This file is part of Datarepresentation module.
+* The TabularDataSchema class describes the names and types of the columns of a TabularData.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#pragma once
+
+#include <DataRepresentation/Export.h>
+#include <DataRepresentation/TabularDataColumn.h>
+#include <DataRepresentation/SymbolPool.h>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QHash>
+#include <QMap>
+#include <QVector>
+
+namespace lpmldata
+{
+
+//-----------------------------------------------------------------------------
+
+typedef QMap< QString , QVariant >      TabularDataHeader;
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Schema of tabular data: ordered column names with their types and a hashed name to index lookup.
+*
+* \details The schema is the typed, indexable form of TabularDataHeader, whose entries are { name, type } lists keyed by the
+* stringified column index. In case of duplicated column names the lookup returns the first column, like QStringList::indexOf.
+* Column names are interned in a SymbolPool of the schema, shared by its copies; the lookup is indexed by their symbols.
+*/
+class DataRepresentation_API TabularDataSchema
+{
+
+public:
+	/*!
+	* \brief Default constructor, creates an empty schema.
+	*/
+	TabularDataSchema();
+
+	/*!
+	* \brief Constructor.
+	* \param [in] aHeader The header to build the schema from. Missing types default to Float.
+	*/
+	TabularDataSchema( const TabularDataHeader& aHeader );
+
+	int size() const { return mNames.size(); }
+
+	bool isEmpty() const { return mNames.isEmpty(); }
+
+	const QString& name( int aColumnIndex ) const { return mNames.at( aColumnIndex ); }
+
+	TabularDataColumnType type( int aColumnIndex ) const { return mTypes.at( aColumnIndex ); }
+
+	/*!
+	* \brief Returns with the symbol of the column name in the pool of the schema.
+	*/
+	Symbol symbol( int aColumnIndex ) const { return mSymbols.at( aColumnIndex ); }
+
+	/*!
+	* \brief Returns with the pool of the column names.
+	*/
+	const SymbolPool& namePool() const { return mNamePool; }
+
+	/*!
+	* \brief Returns with the column names in column order.
+	*/
+	const QStringList& names() const { return mNames; }
+
+	/*!
+	* \brief Returns with the index of the column.
+	* \param [in] aColumnName The name of the column.
+	* \return The column index or -1 if there is no column with the given name.
+	*/
+	int indexOf( const QString& aColumnName ) const { return indexOf( mNamePool.find( aColumnName ) ); }
+
+	int indexOf( Symbol aColumnSymbol ) const { return aColumnSymbol >= 0 && aColumnSymbol < mIndices.size() ? mIndices.at( aColumnSymbol ) : -1; }
+
+	bool contains( const QString& aColumnName ) const { return indexOf( aColumnName ) != -1; }
+
+	bool contains( Symbol aColumnSymbol ) const { return indexOf( aColumnSymbol ) != -1; }
+
+	/*!
+	* \brief Appends a new column to the schema.
+	* \param [in] aColumnName The name of the column.
+	* \param [in] aType The type of the column.
+	*/
+	void append( const QString& aColumnName, TabularDataColumnType aType = TabularDataColumnType::Float );
+
+	void clear();
+
+	/*!
+	* \brief Converts the schema back to its header form.
+	*/
+	TabularDataHeader toHeader() const;
+
+	/*!
+	* \brief Returns with the column type of the type name used in the header ("Float", "Integer" or "String").
+	*/
+	static TabularDataColumnType typeFromName( const QString& aTypeName );
+
+	static QString typeName( TabularDataColumnType aType );
+
+private:
+	QStringList                              mNames;     //!< The interned column names in column order.
+	QVector< lpmldata::Symbol >              mSymbols;   //!< The symbols of the column names in column order.
+	QVector< lpmldata::TabularDataColumnType > mTypes;     //!< The declared column types in column order.
+	lpmldata::SymbolPool                     mNamePool;  //!< The pool of the column names.
+	QVector< int >                           mIndices;   //!< The index of the first column of each name, indexed by symbol.
+
+};
+
+//-----------------------------------------------------------------------------
+
+}
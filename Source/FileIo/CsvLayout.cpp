@@ -0,0 +1,144 @@
+/*!
+* \file
+* Function definitions of the CSV layout. This file is part of FileIo module.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#include <FileIo/CsvLayout.h>
+#include <DataRepresentation/NumberParser.h>
+#include <DataRepresentation/TabularDataColumn.h>
+#include <algorithm>
+
+namespace lpmlfio
+{
+
+//-----------------------------------------------------------------------------
+
+bool matchesWildcard( const QString& aText, const QString& aPattern )
+{
+	int textIndex = 0;
+	int patternIndex = 0;
+	int starIndex = -1;   // The last star of the pattern and the text it has taken so far.
+	int starTextIndex = 0;
+
+	while ( textIndex < aText.size() )
+	{
+		if ( patternIndex < aPattern.size() && ( aPattern.at( patternIndex ) == '?' || aPattern.at( patternIndex ) == aText.at( textIndex ) ) )
+		{
+			++textIndex;
+			++patternIndex;
+		}
+		else if ( patternIndex < aPattern.size() && aPattern.at( patternIndex ) == '*' )
+		{
+			starIndex = patternIndex++;
+			starTextIndex = textIndex;
+		}
+		else if ( starIndex >= 0 )
+		{
+			// Let the last star take one more character.
+			patternIndex = starIndex + 1;
+			textIndex = ++starTextIndex;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	while ( patternIndex < aPattern.size() && aPattern.at( patternIndex ) == '*' ) ++patternIndex;
+
+	return patternIndex == aPattern.size();
+}
+
+//-----------------------------------------------------------------------------
+
+CsvLayout layoutCsv( const QStringList& aHeaderNames, const TabularDataLoadOptions& aOptions )
+{
+	CsvLayout layout;
+	int lastFieldIndex = 0;
+
+	for ( int headerIndex = 0; headerIndex < aHeaderNames.size(); ++headerIndex )
+	{
+		bool isProjected = aOptions.columns.isEmpty();
+		for ( int patternIndex = 0; patternIndex < aOptions.columns.size() && !isProjected; ++patternIndex )
+		{
+			isProjected = matchesWildcard( aHeaderNames.at( headerIndex ), aOptions.columns.at( patternIndex ) );
+		}
+
+		if ( isProjected )
+		{
+			layout.fieldIndices.push_back( headerIndex + 1 );
+			lastFieldIndex = headerIndex + 1;
+		}
+	}
+
+	for ( const TabularDataRowCondition& rowCondition : aOptions.conditions )
+	{
+		int headerIndex = aHeaderNames.indexOf( rowCondition.columnName );
+
+		CsvCondition condition;
+		condition.fieldIndex = headerIndex < 0 ? -1 : headerIndex + 1;
+		condition.comparison = rowCondition.comparison;
+		condition.isNumeric  = rowCondition.value.type() != QVariant::String;
+		condition.number     = condition.isNumeric ? rowCondition.value.toDouble() : 0.0;
+		condition.text       = condition.isNumeric ? QByteArray() : rowCondition.value.toString().toUtf8();
+		layout.conditions.push_back( condition );
+
+		lastFieldIndex = std::max( lastFieldIndex, condition.fieldIndex );
+	}
+
+	// Without a projection every field is read, also those of unnamed columns. An empty line gives one field, so at least two
+	// are read to tell it from a record with an empty key.
+	layout.fieldLimit = aOptions.columns.isEmpty() ? -1 : std::max( lastFieldIndex + 1, 2 );
+
+	return layout;
+}
+
+//-----------------------------------------------------------------------------
+
+bool meetsConditions( const QVector< CsvField >& aFields, const QVector< CsvCondition >& aConditions )
+{
+	for ( const CsvCondition& condition : aConditions )
+	{
+		if ( condition.fieldIndex < 0 || condition.fieldIndex >= aFields.size() ) return false;
+
+		const CsvField& field = aFields.at( condition.fieldIndex );
+		QByteArray text = field.isEscaped ? CsvTokenizer::toUtf8( field ) : QByteArray::fromRawData( field.data, field.size );
+		if ( lpmldata::TabularDataColumn::isMissing( text.constData(), text.size() ) ) return false;
+
+		int order = 0;
+		if ( condition.isNumeric )
+		{
+			double number = 0.0;
+			if ( !lpmldata::parseDouble( text.constData(), text.size(), number ) || number != number ) return false;
+			order = number < condition.number ? -1 : ( number > condition.number ? 1 : 0 );
+		}
+		else
+		{
+			order = text < condition.text ? -1 : ( condition.text < text ? 1 : 0 );
+		}
+
+		bool isMet = false;
+		switch ( condition.comparison )
+		{
+			case TabularDataComparison::Equal:          isMet = order == 0; break;
+			case TabularDataComparison::NotEqual:       isMet = order != 0; break;
+			case TabularDataComparison::Less:           isMet = order < 0;  break;
+			case TabularDataComparison::LessOrEqual:    isMet = order <= 0; break;
+			case TabularDataComparison::Greater:        isMet = order > 0;  break;
+			case TabularDataComparison::GreaterOrEqual: isMet = order >= 0; break;
+		}
+
+		if ( !isMet ) return false;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,67 @@
+/*!
+* \file This file is part of FileIo module.
+* The CsvLayout struct tells which fields of the CSV records are loaded: the projected columns and the row conditions.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#pragma once
+
+#include <FileIo/CsvTokenizer.h>
+#include <FileIo/TabularDataFileIo.h>
+#include <QByteArray>
+#include <QStringList>
+#include <QVector>
+
+namespace lpmlfio
+{
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief A row condition resolved to a field of the records.
+*/
+struct CsvCondition
+{
+	int                      fieldIndex;   //!< The field compared, -1 if the file has no such column.
+	TabularDataComparison    comparison;   //!< How the field is compared with the value.
+	bool                     isNumeric;    //!< True to compare numbers, false to compare bytes.
+	double                   number;       //!< The value of a numeric condition.
+	QByteArray               text;         //!< The value of a text condition.
+};
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief The fields of the records which are loaded: the projected columns and the fields the conditions need.
+*/
+struct CsvLayout
+{
+	QVector< int >            fieldIndices;   //!< The field of each loaded column, the key is field 0.
+	int                       fieldLimit;     //!< The number of fields to tokenize, -1 for all.
+	QVector< CsvCondition >   conditions;     //!< The conditions a record has to meet.
+};
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Returns true if the text matches the pattern, in which * stands for any text and ? for any character.
+*/
+bool matchesWildcard( const QString& aText, const QString& aPattern );
+
+/*!
+* \brief Resolves the projection and the conditions of the options against the header names.
+*/
+CsvLayout layoutCsv( const QStringList& aHeaderNames, const TabularDataLoadOptions& aOptions );
+
+/*!
+* \brief Returns true if the fields of a record meet all conditions. A missing field fails every condition.
+*/
+bool meetsConditions( const QVector< CsvField >& aFields, const QVector< CsvCondition >& aConditions );
+
+//-----------------------------------------------------------------------------
+
+}
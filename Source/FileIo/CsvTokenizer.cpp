@@ -0,0 +1,238 @@
+/*!
+* \file
+* Member function definitions for CsvTokenizer class. This file is part of FileIo module.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#include <FileIo/CsvTokenizer.h>
+#include <DataRepresentation/System.h>
+#include <algorithm>
+#include <cstring>
+#include <emmintrin.h>
+#if defined( __AVX2__ )
+#include <immintrin.h>
+#endif
+#if defined( CC_MSVC )
+#include <intrin.h>
+#endif
+
+namespace lpmlfio
+{
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+int countTrailingZeros( unsigned int aMask )
+{
+#if defined( CC_MSVC )
+	unsigned long index = 0;
+	_BitScanForward( &index, aMask );
+	return int( index );
+#else
+	return __builtin_ctz( aMask );
+#endif
+}
+
+}
+
+//-----------------------------------------------------------------------------
+
+CsvTokenizer::CsvTokenizer( const char* aData, qint64 aSize, char aSeparator )
+:
+	mData( aData ),
+	mSize( aSize ),
+	mPosition( 0 ),
+	mSeparator( aSeparator )
+{
+}
+
+//-----------------------------------------------------------------------------
+
+CsvTokenizer::~CsvTokenizer()
+{
+}
+
+//-----------------------------------------------------------------------------
+
+bool CsvTokenizer::readRecord( QVector< lpmlfio::CsvField >& aFields, int aFieldLimit )
+{
+	aFields.clear();
+	if ( mPosition >= mSize ) return false;
+
+	const char* end = mData + mSize;
+	const char* position = mData + mPosition;
+
+	while ( true )
+	{
+		CsvField field = { position, 0, false };
+
+		if ( position < end && *position == '"' )
+		{
+			// Quoted field: runs to the closing quote.
+			const char* quote = closingQuote( position + 1, field.isEscaped );
+			field.data = position + 1;
+			field.size = int( quote - field.data );
+			position = findFirstOf( std::min( quote + 1, end ), end, mSeparator, '\n' );
+		}
+		else
+		{
+			const char* delimiter = findFirstOf( position, end, mSeparator, '\n' );
+			field.size = int( delimiter - position );
+			position = delimiter;
+
+			if ( ( position == end || *position == '\n' ) && field.size > 0 && field.data[ field.size - 1 ] == '\r' )
+			{
+				--field.size;
+			}
+		}
+
+		aFields.push_back( field );
+
+		if ( position == end )
+		{
+			mPosition = mSize;
+			return true;
+		}
+
+		if ( *position == '\n' )
+		{
+			mPosition = position + 1 - mData;
+			return true;
+		}
+
+		++position;  // Skip the separator.
+
+		if ( aFields.size() == aFieldLimit )
+		{
+			skipRecord( position );
+			return true;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void CsvTokenizer::skipRecord( const char* aPosition )
+{
+	// Only newlines and quotes matter: a quote right after a separator opens a quoted field, which is skipped as a whole.
+	const char* end = mData + mSize;
+	const char* position = aPosition;
+
+	if ( position < end && *position == '"' )
+	{
+		bool isEscaped = false;
+		position = std::min( closingQuote( position + 1, isEscaped ) + 1, end );
+	}
+
+	while ( position < end )
+	{
+		position = findFirstOf( position, end, '"', '\n' );
+		if ( position == end ) break;
+
+		if ( *position == '\n' )
+		{
+			mPosition = position + 1 - mData;
+			return;
+		}
+
+		bool isEscaped = false;
+		position = position[ -1 ] == mSeparator ? std::min( closingQuote( position + 1, isEscaped ) + 1, end ) : position + 1;
+	}
+
+	mPosition = mSize;
+}
+
+//-----------------------------------------------------------------------------
+
+const char* CsvTokenizer::closingQuote( const char* aBegin, bool& aIsEscaped ) const
+{
+	// A doubled quote is an escaped one.
+	const char* end = mData + mSize;
+	const char* quote = aBegin;
+
+	while ( quote < end )
+	{
+		quote = static_cast< const char* >( std::memchr( quote, '"', size_t( end - quote ) ) );
+		if ( quote == nullptr ) return end;
+
+		if ( quote + 1 < end && quote[ 1 ] == '"' )
+		{
+			aIsEscaped = true;
+			quote += 2;
+			continue;
+		}
+
+		return quote;
+	}
+
+	return end;
+}
+
+//-----------------------------------------------------------------------------
+
+QByteArray CsvTokenizer::toUtf8( const lpmlfio::CsvField& aField )
+{
+	QByteArray text( aField.data, aField.size );
+	if ( aField.isEscaped )
+	{
+		text.replace( "\"\"", "\"" );
+	}
+
+	return text;
+}
+
+//-----------------------------------------------------------------------------
+
+QString CsvTokenizer::toString( const lpmlfio::CsvField& aField )
+{
+	if ( !aField.isEscaped ) return QString::fromUtf8( aField.data, aField.size );
+
+	return QString::fromUtf8( toUtf8( aField ) );
+}
+
+//-----------------------------------------------------------------------------
+
+const char* CsvTokenizer::findFirstOf( const char* aBegin, const char* aEnd, char aFirst, char aSecond )
+{
+	const char* position = aBegin;
+
+#if defined( __AVX2__ )
+	const __m256i first32  = _mm256_set1_epi8( aFirst );
+	const __m256i second32 = _mm256_set1_epi8( aSecond );
+
+	for ( ; aEnd - position >= 32; position += 32 )
+	{
+		__m256i block = _mm256_loadu_si256( reinterpret_cast< const __m256i* >( position ) );
+		unsigned int mask = unsigned( _mm256_movemask_epi8( _mm256_or_si256( _mm256_cmpeq_epi8( block, first32 ), _mm256_cmpeq_epi8( block, second32 ) ) ) );
+		if ( mask != 0 ) return position + countTrailingZeros( mask );
+	}
+#endif
+
+	// SSE2 is part of x64, no check needed.
+	const __m128i first16  = _mm_set1_epi8( aFirst );
+	const __m128i second16 = _mm_set1_epi8( aSecond );
+
+	for ( ; aEnd - position >= 16; position += 16 )
+	{
+		__m128i block = _mm_loadu_si128( reinterpret_cast< const __m128i* >( position ) );
+		unsigned int mask = unsigned( _mm_movemask_epi8( _mm_or_si128( _mm_cmpeq_epi8( block, first16 ), _mm_cmpeq_epi8( block, second16 ) ) ) );
+		if ( mask != 0 ) return position + countTrailingZeros( mask );
+	}
+
+	for ( ; position < aEnd; ++position )
+	{
+		if ( *position == aFirst || *position == aSecond ) return position;
+	}
+
+	return aEnd;
+}
+
+//-----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,107 @@
+/*!
+* \file This file is part of FileIo module.
+* The CsvTokenizer class splits a CSV buffer, e.g. a mapped file, into records and fields without copying it.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#pragma once
+
+#include <FileIo/Export.h>
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+namespace lpmlfio
+{
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief A field of a CSV record, pointing into the tokenized buffer.
+*/
+struct CsvField
+{
+	const char* data;        //!< The first byte of the field, after the opening quote of a quoted field.
+	int         size;        //!< The size of the field in bytes, without the quotes.
+	bool        isEscaped;   //!< True if the field contains doubled quotes, which stand for one quote each.
+};
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Zero-copy CSV tokenizer.
+*
+* \details Records end with a newline, a carriage return before it is dropped. A field starting with a quote runs to the closing
+* quote, separators and newlines inside it belong to the field and a doubled quote stands for a quote; bytes between the
+* closing quote and the next delimiter are dropped. Quotes inside an unquoted field are plain characters.
+* The delimiters are searched 32 (AVX2 builds) or 16 (SSE2) bytes at a time.
+*/
+class FileIo_API CsvTokenizer
+{
+
+public:
+	/*!
+	* \brief Constructor.
+	* \param [in] aData The buffer to tokenize, it must outlive the tokenizer and the fields.
+	* \param [in] aSize The size of the buffer in bytes.
+	* \param [in] aSeparator The field separator.
+	*/
+	CsvTokenizer( const char* aData, qint64 aSize, char aSeparator );
+
+	~CsvTokenizer();
+
+	/*!
+	* \brief Reads the fields of the next record.
+	* \param [out] aFields The fields of the record, an empty line gives one empty field.
+	* \param [in] aFieldLimit The number of fields to read, the rest of the record is skipped by looking for its end only; -1 for all.
+	* \return False if there are no more records.
+	*/
+	bool readRecord( QVector< lpmlfio::CsvField >& aFields, int aFieldLimit = -1 );
+
+	/*!
+	* \brief Returns with the offset of the next record in the buffer.
+	*/
+	qint64 position() const { return mPosition; }
+
+	/*!
+	* \brief Continues with the record at the given offset, e.g. one found by an earlier pass.
+	*/
+	void setPosition( qint64 aPosition ) { mPosition = aPosition; }
+
+	bool atEnd() const { return mPosition >= mSize; }
+
+	/*!
+	* \brief Returns with the bytes of the field, doubled quotes collapsed.
+	*/
+	static QByteArray toUtf8( const lpmlfio::CsvField& aField );
+
+	/*!
+	* \brief Returns with the text of the field, doubled quotes collapsed.
+	*/
+	static QString toString( const lpmlfio::CsvField& aField );
+
+	/*!
+	* \brief Returns with the first byte in [ aBegin, aEnd ) equal to aFirst or aSecond, aEnd if there is none.
+	*/
+	static const char* findFirstOf( const char* aBegin, const char* aEnd, char aFirst, char aSecond );
+
+private:
+	void skipRecord( const char* aPosition );
+
+	const char* closingQuote( const char* aBegin, bool& aIsEscaped ) const;
+
+private:
+	const char*  mData;        //!< The tokenized buffer.
+	qint64       mSize;        //!< The size of the buffer in bytes.
+	qint64       mPosition;    //!< The offset of the next record.
+	char         mSeparator;   //!< The field separator.
+
+};
+
+//-----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,384 @@
+/*!
+* \file
+* Member function definitions for FlatBufferBuilder and FlatTable classes. This file is part of FileIo module.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#include <FileIo/FlatBuffer.h>
+#include <algorithm>
+#include <cstring>
+
+namespace lpmlfio
+{
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+void pad( QByteArray& aBuffer, int aAlignment )
+{
+	int size = ( aBuffer.size() + aAlignment - 1 ) / aAlignment * aAlignment;
+	aBuffer.append( QByteArray( size - aBuffer.size(), '\0' ) );
+}
+
+void append( QByteArray& aBuffer, quint64 aValue, int aSize )
+{
+	aBuffer.append( reinterpret_cast< const char* >( &aValue ), aSize );
+}
+
+/*!
+* \brief Stores the offset from a field to the object it refers to.
+*/
+void patch( QByteArray& aBuffer, qint64 aPosition, qint64 aTarget )
+{
+	quint32 offset = quint32( aTarget - aPosition );
+	std::memcpy( aBuffer.data() + aPosition, &offset, sizeof( offset ) );
+}
+
+}
+
+//-----------------------------------------------------------------------------
+
+FlatBufferBuilder::FlatBufferBuilder()
+{
+}
+
+//-----------------------------------------------------------------------------
+
+FlatBufferBuilder::~FlatBufferBuilder()
+{
+}
+
+//-----------------------------------------------------------------------------
+
+int FlatBufferBuilder::addTable()
+{
+	Node node;
+	node.kind  = Kind::Table;
+	node.count = 0;
+	mNodes.push_back( node );
+	return mNodes.size() - 1;
+}
+
+//-----------------------------------------------------------------------------
+
+void FlatBufferBuilder::setScalar( int aTable, int aSlot, quint64 aValue, int aSize )
+{
+	mNodes[ aTable ].fields.push_back( { aSlot, aSize, aValue, -1 } );
+}
+
+//-----------------------------------------------------------------------------
+
+void FlatBufferBuilder::setObject( int aTable, int aSlot, int aObject )
+{
+	mNodes[ aTable ].fields.push_back( { aSlot, 4, 0, aObject } );
+}
+
+//-----------------------------------------------------------------------------
+
+int FlatBufferBuilder::addString( const QByteArray& aText )
+{
+	Node node;
+	node.kind  = Kind::String;
+	node.bytes = aText;
+	node.count = aText.size();
+	mNodes.push_back( node );
+	return mNodes.size() - 1;
+}
+
+//-----------------------------------------------------------------------------
+
+int FlatBufferBuilder::addVector( const QVector< int >& aObjects )
+{
+	Node node;
+	node.kind    = Kind::Vector;
+	node.objects = aObjects;
+	node.count   = aObjects.size();
+	mNodes.push_back( node );
+	return mNodes.size() - 1;
+}
+
+//-----------------------------------------------------------------------------
+
+int FlatBufferBuilder::addStructVector( const void* aData, int aCount, int aStructSize )
+{
+	Node node;
+	node.kind  = Kind::StructVector;
+	node.bytes = QByteArray( static_cast< const char* >( aData ), aCount * aStructSize );
+	node.count = aCount;
+	mNodes.push_back( node );
+	return mNodes.size() - 1;
+}
+
+//-----------------------------------------------------------------------------
+
+QByteArray FlatBufferBuilder::finish( int aRoot ) const
+{
+	QByteArray buffer( 4, '\0' );
+	patch( buffer, 0, write( aRoot, buffer ) );
+	pad( buffer, 8 );
+	return buffer;
+}
+
+//-----------------------------------------------------------------------------
+
+qint64 FlatBufferBuilder::write( int aObject, QByteArray& aBuffer ) const
+{
+	const Node& node = mNodes.at( aObject );
+	qint64 position = 0;
+
+	switch ( node.kind )
+	{
+		case Kind::String:
+		{
+			pad( aBuffer, 4 );
+			position = aBuffer.size();
+			append( aBuffer, quint64( node.count ), 4 );
+			aBuffer.append( node.bytes );
+			aBuffer.append( '\0' );
+			break;
+		}
+
+		case Kind::StructVector:
+		{
+			// The length precedes the 8 byte aligned elements.
+			pad( aBuffer, 8 );
+			aBuffer.append( QByteArray( 4, '\0' ) );
+			position = aBuffer.size();
+			append( aBuffer, quint64( node.count ), 4 );
+			aBuffer.append( node.bytes );
+			break;
+		}
+
+		case Kind::Vector:
+		{
+			pad( aBuffer, 4 );
+			position = aBuffer.size();
+			append( aBuffer, quint64( node.count ), 4 );
+			aBuffer.append( QByteArray( node.count * 4, '\0' ) );
+
+			for ( int elementIndex = 0; elementIndex < node.count; ++elementIndex )
+			{
+				qint64 elementPosition = position + 4 + elementIndex * 4;
+				patch( aBuffer, elementPosition, write( node.objects.at( elementIndex ), aBuffer ) );
+			}
+			break;
+		}
+
+		case Kind::Table:
+		{
+			// Inline layout: the vtable offset, then the fields from the largest to the smallest, each aligned to its size.
+			QVector< Field > fields = node.fields;
+			std::stable_sort( fields.begin(), fields.end(), []( const Field& aLeft, const Field& aRight ) { return aRight.size < aLeft.size; } );
+
+			int slotCount = 0;
+			QVector< int > fieldOffsets( fields.size() );
+			int tableSize = 4;
+			for ( int fieldIndex = 0; fieldIndex < fields.size(); ++fieldIndex )
+			{
+				const Field& field = fields.at( fieldIndex );
+				tableSize = ( tableSize + field.size - 1 ) / field.size * field.size;
+				fieldOffsets[ fieldIndex ] = tableSize;
+				tableSize += field.size;
+				slotCount = std::max( slotCount, field.slot + 1 );
+			}
+
+			QVector< quint16 > vtable( 2 + slotCount, 0 );
+			vtable[ 0 ] = quint16( vtable.size() * 2 );
+			vtable[ 1 ] = quint16( tableSize );
+			for ( int fieldIndex = 0; fieldIndex < fields.size(); ++fieldIndex )
+			{
+				vtable[ 2 + fields.at( fieldIndex ).slot ] = quint16( fieldOffsets.at( fieldIndex ) );
+			}
+
+			// The vtable precedes the 8 byte aligned table.
+			pad( aBuffer, 2 );
+			qint64 vtablePosition = aBuffer.size();
+			aBuffer.append( reinterpret_cast< const char* >( vtable.constData() ), vtable.size() * 2 );
+			pad( aBuffer, 8 );
+			position = aBuffer.size();
+
+			QByteArray table( tableSize, '\0' );
+			qint32 vtableOffset = qint32( position - vtablePosition );
+			std::memcpy( table.data(), &vtableOffset, sizeof( vtableOffset ) );
+			for ( int fieldIndex = 0; fieldIndex < fields.size(); ++fieldIndex )
+			{
+				std::memcpy( table.data() + fieldOffsets.at( fieldIndex ), &fields.at( fieldIndex ).value, size_t( fields.at( fieldIndex ).size ) );
+			}
+
+			aBuffer.append( table );
+
+			for ( int fieldIndex = 0; fieldIndex < fields.size(); ++fieldIndex )
+			{
+				if ( fields.at( fieldIndex ).object < 0 ) continue;
+
+				qint64 fieldPosition = position + fieldOffsets.at( fieldIndex );
+				patch( aBuffer, fieldPosition, write( fields.at( fieldIndex ).object, aBuffer ) );
+			}
+			break;
+		}
+	}
+
+	return position;
+}
+
+//-----------------------------------------------------------------------------
+
+FlatTable::FlatTable()
+:
+	mData( nullptr ),
+	mSize( 0 ),
+	mPosition( 0 ),
+	mVtable( 0 ),
+	mVtableSize( 0 ),
+	mTableSize( 0 )
+{
+}
+
+//-----------------------------------------------------------------------------
+
+FlatTable::FlatTable( const char* aData, qint64 aSize, qint64 aPosition )
+:
+	FlatTable()
+{
+	if ( aPosition < 0 || aPosition + 4 > aSize ) return;
+
+	qint32 vtableOffset;
+	std::memcpy( &vtableOffset, aData + aPosition, sizeof( vtableOffset ) );
+	qint64 vtable = aPosition - vtableOffset;
+	if ( vtable < 0 || vtable + 4 > aSize ) return;
+
+	quint16 sizes[ 2 ];
+	std::memcpy( sizes, aData + vtable, sizeof( sizes ) );
+	if ( sizes[ 0 ] < 4 || vtable + sizes[ 0 ] > aSize || sizes[ 1 ] < 4 || aPosition + sizes[ 1 ] > aSize ) return;
+
+	mData       = aData;
+	mSize       = aSize;
+	mPosition   = aPosition;
+	mVtable     = vtable;
+	mVtableSize = sizes[ 0 ];
+	mTableSize  = sizes[ 1 ];
+}
+
+//-----------------------------------------------------------------------------
+
+FlatTable FlatTable::root( const char* aData, qint64 aSize )
+{
+	if ( aSize < 4 ) return FlatTable();
+
+	quint32 offset;
+	std::memcpy( &offset, aData, sizeof( offset ) );
+	return FlatTable( aData, aSize, qint64( offset ) );
+}
+
+//-----------------------------------------------------------------------------
+
+qint64 FlatTable::scalar( int aSlot, int aSize, qint64 aDefault ) const
+{
+	qint64 position = fieldPosition( aSlot, aSize );
+	if ( position < 0 ) return aDefault;
+
+	switch ( aSize )
+	{
+		case 1: { qint8 value; std::memcpy( &value, mData + position, 1 ); return value; }
+		case 2: { qint16 value; std::memcpy( &value, mData + position, 2 ); return value; }
+		case 4: { qint32 value; std::memcpy( &value, mData + position, 4 ); return value; }
+		default: { qint64 value; std::memcpy( &value, mData + position, 8 ); return value; }
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+FlatTable FlatTable::table( int aSlot ) const
+{
+	qint64 position = fieldPosition( aSlot, 4 );
+	return position < 0 ? FlatTable() : FlatTable( mData, mSize, target( position ) );
+}
+
+//-----------------------------------------------------------------------------
+
+QByteArray FlatTable::string( int aSlot ) const
+{
+	qint64 length = 0;
+	qint64 position = vector( aSlot, length );
+	if ( position < 0 || position + length > mSize ) return QByteArray();
+
+	return QByteArray( mData + position, int( length ) );
+}
+
+//-----------------------------------------------------------------------------
+
+int FlatTable::vectorSize( int aSlot ) const
+{
+	// The elements of the vectors read here are at least 4 bytes.
+	qint64 count = 0;
+	qint64 position = vector( aSlot, count );
+	return position < 0 || position + count * 4 > mSize ? -1 : int( count );
+}
+
+//-----------------------------------------------------------------------------
+
+FlatTable FlatTable::tableAt( int aSlot, int aIndex ) const
+{
+	qint64 count = 0;
+	qint64 position = vector( aSlot, count );
+	if ( position < 0 || aIndex < 0 || aIndex >= count || position + ( aIndex + 1 ) * 4 > mSize ) return FlatTable();
+
+	return FlatTable( mData, mSize, target( position + aIndex * 4 ) );
+}
+
+//-----------------------------------------------------------------------------
+
+const char* FlatTable::structAt( int aSlot, int aIndex, int aStructSize ) const
+{
+	qint64 count = 0;
+	qint64 position = vector( aSlot, count );
+	if ( position < 0 || aIndex < 0 || aIndex >= count || position + qint64( aIndex + 1 ) * aStructSize > mSize ) return nullptr;
+
+	return mData + position + qint64( aIndex ) * aStructSize;
+}
+
+//-----------------------------------------------------------------------------
+
+qint64 FlatTable::fieldPosition( int aSlot, int aSize ) const
+{
+	if ( mData == nullptr || 4 + 2 * aSlot + 2 > mVtableSize ) return -1;
+
+	quint16 offset;
+	std::memcpy( &offset, mData + mVtable + 4 + 2 * aSlot, sizeof( offset ) );
+	return offset == 0 || offset + aSize > mTableSize ? -1 : mPosition + offset;
+}
+
+//-----------------------------------------------------------------------------
+
+qint64 FlatTable::target( qint64 aPosition ) const
+{
+	quint32 offset;
+	std::memcpy( &offset, mData + aPosition, sizeof( offset ) );
+	return aPosition + offset;
+}
+
+//-----------------------------------------------------------------------------
+
+qint64 FlatTable::vector( int aSlot, qint64& aCount ) const
+{
+	qint64 position = fieldPosition( aSlot, 4 );
+	if ( position < 0 ) return -1;
+
+	position = target( position );
+	if ( position + 4 > mSize ) return -1;
+
+	quint32 count;
+	std::memcpy( &count, mData + position, sizeof( count ) );
+	aCount = count;
+	return position + 4;
+}
+
+//-----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,182 @@
+/*!
+* \file This file is part of FileIo module.
+* The FlatBufferBuilder and FlatTable classes write and read the FlatBuffers encoding of the Arrow IPC metadata.
+*
+* \remarks
+* Only what the Arrow metadata needs is covered: tables of scalars and objects, strings, vectors of tables or strings and
+* vectors of structs. Integers are little endian like the platforms we build for.
+*
+* \authors
+* lpapp
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QVector>
+
+namespace lpmlfio
+{
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Builds a FlatBuffers buffer. The objects are declared first and referred to by their handles; finish() lays them
+* out parents before children, so that every offset points forward as the encoding requires.
+*/
+class FlatBufferBuilder
+{
+
+public:
+
+	FlatBufferBuilder();
+
+	~FlatBufferBuilder();
+
+	/*!
+	* \brief Adds an empty table.
+	* \return The handle of the table.
+	*/
+	int addTable();
+
+	/*!
+	* \brief Sets a scalar field of a table.
+	* \param [in] aTable The handle of the table.
+	* \param [in] aSlot The index of the field in the schema.
+	* \param [in] aValue The value, its lower aSize bytes are stored.
+	* \param [in] aSize The size of the scalar, 1, 2, 4 or 8 bytes.
+	*/
+	void setScalar( int aTable, int aSlot, quint64 aValue, int aSize );
+
+	/*!
+	* \brief Sets a field of a table which refers to a table, a string or a vector.
+	*/
+	void setObject( int aTable, int aSlot, int aObject );
+
+	/*!
+	* \brief Adds a string.
+	* \return The handle of the string.
+	*/
+	int addString( const QByteArray& aText );
+
+	/*!
+	* \brief Adds a vector of tables or strings.
+	* \return The handle of the vector.
+	*/
+	int addVector( const QVector< int >& aObjects );
+
+	/*!
+	* \brief Adds a vector of structs, aligned to 8 bytes.
+	* \param [in] aData The structs, aCount * aStructSize bytes.
+	* \return The handle of the vector.
+	*/
+	int addStructVector( const void* aData, int aCount, int aStructSize );
+
+	/*!
+	* \brief Lays out the buffer of the given root table.
+	* \return The buffer, padded to a multiple of 8 bytes.
+	*/
+	QByteArray finish( int aRoot ) const;
+
+private:
+
+	enum class Kind
+	{
+		Table,
+		String,
+		Vector,
+		StructVector
+	};
+
+	struct Field
+	{
+		int      slot;     //!< The index of the field in the schema.
+		int      size;     //!< The size of the field in the table, 4 for an object.
+		quint64  value;    //!< The value of a scalar.
+		int      object;   //!< The handle of the object referred to, -1 for a scalar.
+	};
+
+	struct Node
+	{
+		Kind              kind;      //!< The kind of the object.
+		QVector< Field >  fields;    //!< The fields of a table.
+		QByteArray        bytes;     //!< The text of a string, the elements of a struct vector.
+		int               count;     //!< The number of elements of a vector.
+		QVector< int >    objects;   //!< The elements of a vector of tables or strings.
+	};
+
+	qint64 write( int aObject, QByteArray& aBuffer ) const;
+
+private:
+	QVector< Node >   mNodes;   //!< The declared objects, indexed by their handles.
+
+};
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Read access to a table of a FlatBuffers buffer, e.g. a part of a mapped file.
+*
+* \details Every access is checked against the buffer: an absent or out of bounds scalar reads as its default, an absent or
+* out of bounds object as an invalid table, an empty string or a vector of -1 elements.
+*/
+class FlatTable
+{
+
+public:
+
+	FlatTable();
+
+	/*!
+	* \brief Returns with the root table of a buffer.
+	* \param [in] aData The buffer, it must outlive the table.
+	* \param [in] aSize The size of the buffer in bytes.
+	*/
+	static FlatTable root( const char* aData, qint64 aSize );
+
+	bool isValid() const { return mData != nullptr; }
+
+	/*!
+	* \brief Returns with a scalar field, sign extended from aSize bytes.
+	*/
+	qint64 scalar( int aSlot, int aSize, qint64 aDefault = 0 ) const;
+
+	FlatTable table( int aSlot ) const;
+
+	QByteArray string( int aSlot ) const;
+
+	/*!
+	* \brief Returns with the number of elements of a vector field, -1 if it is absent or out of bounds.
+	*/
+	int vectorSize( int aSlot ) const;
+
+	/*!
+	* \brief Returns with an element of a vector of tables.
+	*/
+	FlatTable tableAt( int aSlot, int aIndex ) const;
+
+	/*!
+	* \brief Returns with an element of a vector of structs, nullptr if it is out of bounds.
+	*/
+	const char* structAt( int aSlot, int aIndex, int aStructSize ) const;
+
+private:
+	FlatTable( const char* aData, qint64 aSize, qint64 aPosition );
+
+	qint64 fieldPosition( int aSlot, int aSize ) const;
+	qint64 target( qint64 aPosition ) const;
+	qint64 vector( int aSlot, qint64& aCount ) const;
+
+private:
+	const char*  mData;         //!< The buffer, nullptr for an invalid table.
+	qint64       mSize;         //!< The size of the buffer.
+	qint64       mPosition;     //!< The offset of the table in the buffer.
+	qint64       mVtable;       //!< The offset of the vtable of the table.
+	int          mVtableSize;   //!< The size of the vtable in bytes.
+	int          mTableSize;    //!< The size of the inline part of the table in bytes.
+
+};
+
+//-----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,167 @@
+/*!
+* \file
+* Member function definitions for GzipInflater and GzipDeflater classes. This file is part of FileIo module.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#include <FileIo/GzipStream.h>
+#include <algorithm>
+#include <cstring>
+
+namespace lpmlfio
+{
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+const qint64 kMaximumPieceSize = qint64( 1 ) << 30;   //!< zlib counts the bytes of a call in 32 bits.
+const int kDeflateBufferSize = 1 << 20;
+
+}
+
+//-----------------------------------------------------------------------------
+
+GzipInflater::GzipInflater( const char* aData, qint64 aSize )
+:
+	mData( aData ),
+	mSize( aSize ),
+	mPosition( 0 ),
+	mIsAtEnd( false )
+{
+	std::memset( &mStream, 0, sizeof( mStream ) );
+	inflateInit2( &mStream, 15 + 16 );  // Gzip wrapper.
+}
+
+//-----------------------------------------------------------------------------
+
+GzipInflater::~GzipInflater()
+{
+	inflateEnd( &mStream );
+}
+
+//-----------------------------------------------------------------------------
+
+qint64 GzipInflater::inflate( char* aBuffer, qint64 aCapacity )
+{
+	qint64 produced = 0;
+
+	while ( produced < aCapacity && !mIsAtEnd )
+	{
+		if ( mStream.avail_in == 0 )
+		{
+			if ( mPosition >= mSize ) return -1;  // Truncated.
+
+			qint64 pieceSize = std::min( mSize - mPosition, kMaximumPieceSize );
+			mStream.next_in  = reinterpret_cast< Bytef* >( const_cast< char* >( mData + mPosition ) );
+			mStream.avail_in = uInt( pieceSize );
+			mPosition += pieceSize;
+		}
+
+		uInt room = uInt( std::min( aCapacity - produced, kMaximumPieceSize ) );
+		mStream.next_out  = reinterpret_cast< Bytef* >( aBuffer + produced );
+		mStream.avail_out = room;
+
+		int status = ::inflate( &mStream, Z_NO_FLUSH );
+		produced += room - mStream.avail_out;
+
+		if ( status == Z_STREAM_END )
+		{
+			// Another member may follow, anything else after a member is ignored.
+			qint64 next = mPosition - mStream.avail_in;
+			if ( !isGzip( mData + next, mSize - next ) )
+			{
+				mIsAtEnd = true;
+				break;
+			}
+
+			inflateReset( &mStream );
+		}
+		else if ( status != Z_OK )
+		{
+			return -1;
+		}
+	}
+
+	return produced;
+}
+
+//-----------------------------------------------------------------------------
+
+qint64 GzipInflater::sizeHint( const char* aData, qint64 aSize )
+{
+	if ( !isGzip( aData, aSize ) ) return -1;
+
+	const uchar* trailer = reinterpret_cast< const uchar* >( aData + aSize - 4 );
+	return qint64( trailer[ 0 ] ) | ( qint64( trailer[ 1 ] ) << 8 ) | ( qint64( trailer[ 2 ] ) << 16 ) | ( qint64( trailer[ 3 ] ) << 24 );
+}
+
+//-----------------------------------------------------------------------------
+
+GzipDeflater::GzipDeflater( QIODevice& aDevice, int aLevel )
+:
+	mDevice( aDevice ),
+	mBuffer( kDeflateBufferSize, Qt::Uninitialized )
+{
+	std::memset( &mStream, 0, sizeof( mStream ) );
+	deflateInit2( &mStream, aLevel, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY );  // Gzip wrapper.
+}
+
+//-----------------------------------------------------------------------------
+
+GzipDeflater::~GzipDeflater()
+{
+	deflateEnd( &mStream );
+}
+
+//-----------------------------------------------------------------------------
+
+bool GzipDeflater::write( const char* aData, qint64 aSize )
+{
+	for ( qint64 position = 0; position < aSize; position += kMaximumPieceSize )
+	{
+		mStream.next_in  = reinterpret_cast< Bytef* >( const_cast< char* >( aData + position ) );
+		mStream.avail_in = uInt( std::min( aSize - position, kMaximumPieceSize ) );
+		if ( !deflate( Z_NO_FLUSH ) ) return false;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool GzipDeflater::finish()
+{
+	mStream.next_in  = nullptr;
+	mStream.avail_in = 0;
+	return deflate( Z_FINISH );
+}
+
+//-----------------------------------------------------------------------------
+
+bool GzipDeflater::deflate( int aFlush )
+{
+	// zlib fills the whole buffer as long as it has output left.
+	do
+	{
+		mStream.next_out  = reinterpret_cast< Bytef* >( mBuffer.data() );
+		mStream.avail_out = uInt( mBuffer.size() );
+
+		if ( ::deflate( &mStream, aFlush ) == Z_STREAM_ERROR ) return false;
+
+		qint64 size = qint64( mBuffer.size() ) - mStream.avail_out;
+		if ( size > 0 && mDevice.write( mBuffer.constData(), size ) != size ) return false;
+	}
+	while ( mStream.avail_out == 0 );
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+
+}
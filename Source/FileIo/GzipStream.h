@@ -0,0 +1,117 @@
+/*!
+* \file This file is part of FileIo module.
+* The GzipInflater and GzipDeflater classes stream gzip data through zlib.
+*
+* \remarks
+* zlib is an explicit dependency of FileIo: the project takes its headers and its import library from $(ZlibDir), see
+* FileIo.vcxproj. Qt only bundles its own private copy, which is not part of its public interface.
+*
+* \authors
+* lpapp
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QIODevice>
+
+#if defined( __has_include )
+#if !__has_include( <zlib.h> )
+#error "FileIo needs zlib: set ZlibDir to a zlib installation with include and lib folders."
+#endif
+#endif
+#include <zlib.h>
+
+namespace lpmlfio
+{
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Inflates gzip data held in memory, e.g. a mapped file, a block at a time. Concatenated members are read one after
+* the other.
+*/
+class GzipInflater
+{
+
+public:
+	/*!
+	* \brief Constructor.
+	* \param [in] aData The gzip data, it must outlive the inflater.
+	* \param [in] aSize The size of the data in bytes.
+	*/
+	GzipInflater( const char* aData, qint64 aSize );
+
+	~GzipInflater();
+
+	/*!
+	* \brief Inflates the next bytes.
+	* \param [out] aBuffer The buffer to write to.
+	* \param [in] aCapacity The size of the buffer, the number of bytes written unless the data ends.
+	* \return The number of bytes written, 0 at the end of the data, -1 if the data is truncated or corrupt.
+	*/
+	qint64 inflate( char* aBuffer, qint64 aCapacity );
+
+	/*!
+	* \brief Returns true if the data starts with the gzip magic bytes.
+	*/
+	static bool isGzip( const char* aData, qint64 aSize ) { return aSize >= 18 && uchar( aData[ 0 ] ) == 0x1F && uchar( aData[ 1 ] ) == 0x8B; }
+
+	/*!
+	* \brief Returns with the uncompressed size stated by the trailer of the last member, modulo 2^32; the exact size of a
+	* single member of less than 4 GB.
+	*/
+	static qint64 sizeHint( const char* aData, qint64 aSize );
+
+private:
+	z_stream     mStream;     //!< The zlib state.
+	const char*  mData;       //!< The gzip data.
+	qint64       mSize;       //!< The size of the gzip data.
+	qint64       mPosition;   //!< The offset of the data not handed to zlib yet.
+	bool         mIsAtEnd;    //!< True after the last member.
+
+};
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Deflates data into a gzip stream written to a device.
+*/
+class GzipDeflater
+{
+
+public:
+	/*!
+	* \brief Constructor.
+	* \param [in] aDevice The open device to write to, it must outlive the deflater.
+	* \param [in] aLevel The zlib compression level, 1 (fastest) to 9 (smallest).
+	*/
+	GzipDeflater( QIODevice& aDevice, int aLevel = Z_DEFAULT_COMPRESSION );
+
+	~GzipDeflater();
+
+	/*!
+	* \brief Compresses and writes the data, zlib keeps a part of it until the next call.
+	* \return False if the device could not be written.
+	*/
+	bool write( const char* aData, qint64 aSize );
+
+	/*!
+	* \brief Writes the rest of the stream and the gzip trailer.
+	* \return False if the device could not be written.
+	*/
+	bool finish();
+
+private:
+	bool deflate( int aFlush );
+
+private:
+	z_stream     mStream;   //!< The zlib state.
+	QIODevice&   mDevice;   //!< The device the stream is written to.
+	QByteArray   mBuffer;   //!< The compressed bytes before they are written.
+
+};
+
+//-----------------------------------------------------------------------------
+
+}
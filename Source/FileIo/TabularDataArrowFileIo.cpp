@@ -0,0 +1,873 @@
+/*!
+* \file
+* Member function definitions for TabularDataArrowFileIo class. This file is part of FileIo module.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#include <FileIo/TabularDataArrowFileIo.h>
+#include <FileIo/FlatBuffer.h>
+#include <QFile>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+
+namespace lpmlfio
+{
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+const char    kMagic[ 8 ]       = { 'A', 'R', 'R', 'O', 'W', '1', '\0', '\0' };
+const quint32 kContinuation     = 0xFFFFFFFF;
+const qint16  kMetadataVersion  = 4;    // V5.
+const qint64  kBufferAlignment  = 64;
+const int     kTextBlockSize    = 1 << 20;
+
+// Message header and type ids, see Message.fbs and Schema.fbs of Arrow.
+const int kSchemaMessage      = 1;
+const int kRecordBatchMessage = 3;
+
+enum ArrowTypeId
+{
+	kNullType = 1, kIntType, kFloatingPointType, kBinaryType, kUtf8Type, kBoolType, kDecimalType, kDateType, kTimeType,
+	kTimestampType, kIntervalType, kListType, kStructType, kUnionType, kFixedSizeBinaryType, kFixedSizeListType, kMapType,
+	kDurationType, kLargeBinaryType, kLargeUtf8Type, kLargeListType
+};
+
+// Field slots of the metadata tables.
+enum { kMessageVersion = 0, kMessageHeaderType, kMessageHeader, kMessageBodyLength };
+enum { kSchemaEndianness = 0, kSchemaFields };
+enum { kFieldName = 0, kFieldNullable, kFieldTypeType, kFieldType, kFieldDictionary, kFieldChildren };
+enum { kIntBitWidth = 0, kIntIsSigned };
+enum { kFloatingPointPrecision = 0 };
+enum { kBatchLength = 0, kBatchNodes, kBatchBuffers, kBatchCompression };
+enum { kFooterVersion = 0, kFooterSchema, kFooterDictionaries, kFooterRecordBatches };
+
+const int kDoublePrecision = 2;
+const int kSinglePrecision = 1;
+
+struct ArrowFieldNode
+{
+	qint64  length;
+	qint64  nullCount;
+};
+
+struct ArrowBuffer
+{
+	qint64  offset;      // Offset in the message body.
+	qint64  length;
+};
+
+struct ArrowBlock
+{
+	qint64  offset;           // File offset of the message.
+	qint32  metaDataLength;   // Size of the message up to its body, prefix included.
+	qint32  padding;
+	qint64  bodyLength;
+};
+
+static_assert( sizeof( ArrowFieldNode ) == 16, "An Arrow field node must be 16 bytes." );
+static_assert( sizeof( ArrowBuffer ) == 16, "An Arrow buffer must be 16 bytes." );
+static_assert( sizeof( ArrowBlock ) == 24, "An Arrow block must be 24 bytes." );
+
+/*!
+* \brief The type of a field which is loaded: the Arrow type and the width of its values (of its offsets for utf8).
+*/
+struct ArrowFieldType
+{
+	int                              typeId;       //!< The Arrow type id.
+	int                              width;        //!< The size of a value or an offset in bytes, 0 for bool.
+	bool                             isSigned;     //!< True for signed integers.
+	lpmldata::TabularDataColumnType  columnType;   //!< The type of the column the field is loaded into.
+};
+
+/*!
+* \brief One field of a record batch, pointing into the mapped body.
+*/
+struct ArrowArray
+{
+	qint64       length;       //!< The number of values.
+	qint64       nullCount;    //!< The number of nulls.
+	const uchar* validity;     //!< The validity bitmap, nullptr if every value is valid.
+	const char*  offsets;      //!< The offsets of a utf8 field.
+	const char*  values;       //!< The values, the text of a utf8 field.
+};
+
+/*!
+* \brief A field of the schema which is saved.
+*/
+struct ArrowField
+{
+	QByteArray  name;         //!< The UTF-8 name.
+	int         typeId;       //!< The Arrow type id.
+	bool        isNullable;   //!< False for the keys.
+};
+
+qint64 alignedOffset( qint64 aOffset )
+{
+	return ( aOffset + kBufferAlignment - 1 ) / kBufferAlignment * kBufferAlignment;
+}
+
+bool isInFile( qint64 aOffset, qint64 aSize, qint64 aFileSize )
+{
+	return aOffset >= 0 && aSize >= 0 && aOffset <= aFileSize && aSize <= aFileSize - aOffset;
+}
+
+/*!
+* \brief Writes the zeros which follow a buffer of the given size up to the next aligned offset.
+*/
+bool writePadding( QFile& aFile, qint64 aSize )
+{
+	static const char padding[ kBufferAlignment ] = {};
+
+	qint64 paddingSize = alignedOffset( aSize ) - aSize;
+	return paddingSize == 0 || aFile.write( padding, paddingSize ) == paddingSize;
+}
+
+/*!
+* \brief Writes a buffer and pads it with zeros up to the next aligned offset.
+*/
+bool writeBlock( QFile& aFile, const void* aData, qint64 aSize )
+{
+	if ( aSize > 0 && aFile.write( static_cast< const char* >( aData ), aSize ) != aSize ) return false;
+
+	return writePadding( aFile, aSize );
+}
+
+/*!
+* \brief Writes an encapsulated message: the continuation marker, the size of the metadata and the metadata.
+* \return The size of the message up to its body, 0 if it could not be written.
+*/
+qint32 writeMessage( QFile& aFile, const QByteArray& aMetadata )
+{
+	qint32 prefix[ 2 ] = { qint32( kContinuation ), qint32( aMetadata.size() ) };
+	bool isWritten = aFile.write( reinterpret_cast< const char* >( prefix ), sizeof( prefix ) ) == qint64( sizeof( prefix ) )
+		&& aFile.write( aMetadata ) == aMetadata.size();
+
+	return isWritten ? qint32( sizeof( prefix ) + aMetadata.size() ) : 0;
+}
+
+/*!
+* \brief Writes the offsets and the text of a utf8 field, each padded. The text is written in blocks.
+* \param [in] aTextAt Returns with the text of a row and its size, nullptr for a null.
+*/
+template< typename TextAt >
+bool writeUtf8( QFile& aFile, qint64 aRowCount, bool aIsLarge, TextAt aTextAt )
+{
+	QVector< qint64 > offsets( int( aRowCount + 1 ), 0 );
+	for ( int rowIndex = 0; rowIndex < aRowCount; ++rowIndex )
+	{
+		int size = 0;
+		aTextAt( rowIndex, size );
+		offsets[ rowIndex + 1 ] = offsets.at( rowIndex ) + size;
+	}
+
+	bool isWritten = true;
+	if ( aIsLarge )
+	{
+		isWritten = writeBlock( aFile, offsets.constData(), offsets.size() * qint64( sizeof( qint64 ) ) );
+	}
+	else
+	{
+		QVector< qint32 > narrowOffsets( offsets.size() );
+		std::copy( offsets.begin(), offsets.end(), narrowOffsets.begin() );
+		isWritten = writeBlock( aFile, narrowOffsets.constData(), narrowOffsets.size() * qint64( sizeof( qint32 ) ) );
+	}
+
+	QByteArray block;
+	block.reserve( kTextBlockSize );
+	for ( int rowIndex = 0; rowIndex < aRowCount && isWritten; ++rowIndex )
+	{
+		int size = 0;
+		const char* text = aTextAt( rowIndex, size );
+		if ( size > 0 ) block.append( text, size );
+
+		if ( block.size() >= kTextBlockSize )
+		{
+			isWritten = aFile.write( block ) == block.size();
+			block.clear();
+		}
+	}
+
+	qint64 textSize = offsets.last();
+	return isWritten && aFile.write( block ) == block.size() && writePadding( aFile, textSize );
+}
+
+/*!
+* \brief Adds the schema of the fields to a metadata buffer.
+* \return The handle of the schema table.
+*/
+int addSchema( FlatBufferBuilder& aBuilder, const QVector< ArrowField >& aFields )
+{
+	QVector< int > fields;
+	for ( const ArrowField& arrowField : aFields )
+	{
+		int type = aBuilder.addTable();
+		if ( arrowField.typeId == kIntType )
+		{
+			aBuilder.setScalar( type, kIntBitWidth, 64, 4 );
+			aBuilder.setScalar( type, kIntIsSigned, 1, 1 );
+		}
+		else if ( arrowField.typeId == kFloatingPointType )
+		{
+			aBuilder.setScalar( type, kFloatingPointPrecision, kDoublePrecision, 2 );
+		}
+
+		int field = aBuilder.addTable();
+		aBuilder.setObject( field, kFieldName, aBuilder.addString( arrowField.name ) );
+		aBuilder.setScalar( field, kFieldNullable, arrowField.isNullable ? 1 : 0, 1 );
+		aBuilder.setScalar( field, kFieldTypeType, quint64( arrowField.typeId ), 1 );
+		aBuilder.setObject( field, kFieldType, type );
+		aBuilder.setObject( field, kFieldChildren, aBuilder.addVector( QVector< int >() ) );
+		fields.push_back( field );
+	}
+
+	int schema = aBuilder.addTable();
+	aBuilder.setObject( schema, kSchemaFields, aBuilder.addVector( fields ) );
+	return schema;
+}
+
+/*!
+* \brief Returns with the type a field is loaded as, false if the field is not loaded.
+*/
+bool fieldType( const FlatTable& aField, ArrowFieldType& aType )
+{
+	if ( aField.table( kFieldDictionary ).isValid() ) return false;
+
+	FlatTable type = aField.table( kFieldType );
+	aType.typeId = int( aField.scalar( kFieldTypeType, 1 ) & 0xFF );
+	aType.isSigned = true;
+
+	switch ( aType.typeId )
+	{
+		case kIntType:
+		{
+			int bitWidth = int( type.scalar( kIntBitWidth, 4 ) );
+			aType.width = bitWidth / 8;
+			aType.isSigned = type.scalar( kIntIsSigned, 1 ) != 0;
+			aType.columnType = lpmldata::TabularDataColumnType::Integer;
+			return bitWidth == 8 || bitWidth == 16 || bitWidth == 32 || bitWidth == 64;
+		}
+
+		case kFloatingPointType:
+		{
+			int precision = int( type.scalar( kFloatingPointPrecision, 2 ) );
+			aType.width = precision == kDoublePrecision ? 8 : 4;
+			aType.columnType = lpmldata::TabularDataColumnType::Float;
+			return precision == kDoublePrecision || precision == kSinglePrecision;
+		}
+
+		case kBoolType:
+		{
+			aType.width = 0;
+			aType.columnType = lpmldata::TabularDataColumnType::Integer;
+			return true;
+		}
+
+		case kUtf8Type:
+		case kLargeUtf8Type:
+		{
+			aType.width = aType.typeId == kUtf8Type ? 4 : 8;
+			aType.columnType = lpmldata::TabularDataColumnType::String;
+			return true;
+		}
+
+		default:
+			return false;
+	}
+}
+
+/*!
+* \brief Counts the nodes and buffers a field and its children take in a record batch.
+* \return False for types whose buffers are not known here, e.g. unions.
+*/
+bool countBuffers( const FlatTable& aField, int aDepth, int& aNodeCount, int& aBufferCount )
+{
+	++aNodeCount;
+
+	// A dictionary encoded field holds the indices.
+	if ( aField.table( kFieldDictionary ).isValid() )
+	{
+		aBufferCount += 2;
+		return true;
+	}
+
+	int bufferCount = -1;
+	switch ( int( aField.scalar( kFieldTypeType, 1 ) & 0xFF ) )
+	{
+		case kNullType:
+			bufferCount = 0;
+			break;
+
+		case kIntType: case kFloatingPointType: case kBoolType: case kDecimalType: case kDateType: case kTimeType:
+		case kTimestampType: case kIntervalType: case kFixedSizeBinaryType: case kDurationType:
+		case kListType: case kLargeListType: case kMapType:
+			bufferCount = 2;
+			break;
+
+		case kBinaryType: case kUtf8Type: case kLargeBinaryType: case kLargeUtf8Type:
+			bufferCount = 3;
+			break;
+
+		case kStructType: case kFixedSizeListType:
+			bufferCount = 1;
+			break;
+	}
+
+	if ( bufferCount < 0 || aDepth > 64 ) return false;
+
+	aBufferCount += bufferCount;
+	int childCount = std::max( aField.vectorSize( kFieldChildren ), 0 );
+	for ( int childIndex = 0; childIndex < childCount; ++childIndex )
+	{
+		if ( !countBuffers( aField.tableAt( kFieldChildren, childIndex ), aDepth + 1, aNodeCount, aBufferCount ) ) return false;
+	}
+
+	return true;
+}
+
+/*!
+* \brief Returns with a buffer of a record batch, nullptr if it is empty. A buffer out of the body or shorter than
+* aMinimumSize makes the batch invalid.
+*/
+const char* bodyBuffer( const FlatTable& aBatch, int aIndex, const char* aBody, qint64 aBodyLength, qint64 aMinimumSize, qint64& aSize, bool& aIsValid )
+{
+	ArrowBuffer buffer;
+	std::memcpy( &buffer, aBatch.structAt( kBatchBuffers, aIndex, sizeof( ArrowBuffer ) ), sizeof( buffer ) );
+	aIsValid = aIsValid && isInFile( buffer.offset, buffer.length, aBodyLength ) && buffer.length >= aMinimumSize;
+	aSize = buffer.length;
+	return aIsValid && buffer.length > 0 ? aBody + buffer.offset : nullptr;
+}
+
+/*!
+* \brief Reads the arrays of the loaded fields of a record batch.
+* \param [in] aData The mapped file.
+* \param [in] aFileSize The size of the file.
+* \param [in] aBlock The location of the record batch.
+* \param [in] aFields The fields of the schema.
+* \param [in] aTypes The types of the fields, typeId 0 for a field which is not loaded.
+* \param [out] aArrays The arrays of the fields.
+* \return False if the record batch is corrupt or not supported.
+*/
+bool readBatch( const char* aData, qint64 aFileSize, const ArrowBlock& aBlock, const QVector< FlatTable >& aFields, const QVector< ArrowFieldType >& aTypes, QVector< ArrowArray >& aArrays )
+{
+	if ( aBlock.metaDataLength < 8 || !isInFile( aBlock.offset, qint64( aBlock.metaDataLength ) + aBlock.bodyLength, aFileSize ) ) return false;
+
+	// Messages before format 0.15 have no continuation marker.
+	const char* message = aData + aBlock.offset;
+	qint32 prefix[ 2 ];
+	std::memcpy( prefix, message, sizeof( prefix ) );
+	qint64 metadataOffset = quint32( prefix[ 0 ] ) == kContinuation ? 8 : 4;
+	qint64 metadataSize = quint32( prefix[ 0 ] ) == kContinuation ? prefix[ 1 ] : prefix[ 0 ];
+	if ( metadataSize < 0 || metadataOffset + metadataSize > aBlock.metaDataLength ) return false;
+
+	FlatTable metadata = FlatTable::root( message + metadataOffset, metadataSize );
+	FlatTable batch = metadata.table( kMessageHeader );
+	if ( metadata.scalar( kMessageHeaderType, 1 ) != kRecordBatchMessage || !batch.isValid() ) return false;
+
+	if ( batch.table( kBatchCompression ).isValid() )
+	{
+		qDebug() << "Compressed Arrow record batches are not supported.";
+		return false;
+	}
+
+	const char* body = message + aBlock.metaDataLength;
+	qint64 batchLength = batch.scalar( kBatchLength, 8 );
+	int nodeIndex = 0;
+	int bufferIndex = 0;
+	bool isValid = batchLength >= 0;
+
+	aArrays.resize( aFields.size() );
+	for ( int fieldIndex = 0; fieldIndex < aFields.size() && isValid; ++fieldIndex )
+	{
+		const ArrowFieldType& type = aTypes.at( fieldIndex );
+		if ( type.typeId == 0 )
+		{
+			isValid = countBuffers( aFields.at( fieldIndex ), 0, nodeIndex, bufferIndex );
+			continue;
+		}
+
+		const char* nodeData = batch.structAt( kBatchNodes, nodeIndex++, sizeof( ArrowFieldNode ) );
+		int bufferCount = type.columnType == lpmldata::TabularDataColumnType::String ? 3 : 2;
+		const char* lastBuffer = batch.structAt( kBatchBuffers, bufferIndex + bufferCount - 1, sizeof( ArrowBuffer ) );
+		if ( nodeData == nullptr || lastBuffer == nullptr ) return false;
+
+		ArrowFieldNode node;
+		std::memcpy( &node, nodeData, sizeof( node ) );
+		isValid = node.length == batchLength && node.nullCount >= 0 && node.nullCount <= node.length;
+
+		ArrowArray& array = aArrays[ fieldIndex ];
+		array.length    = node.length;
+		array.nullCount = node.nullCount;
+		array.offsets   = nullptr;
+
+		// Without a bitmap every value is valid.
+		qint64 size = 0;
+		array.validity = reinterpret_cast< const uchar* >( bodyBuffer( batch, bufferIndex++, body, aBlock.bodyLength, 0, size, isValid ) );
+		isValid = isValid && ( array.validity == nullptr ? node.nullCount == 0 : size >= ( node.length + 7 ) / 8 );
+
+		if ( type.columnType != lpmldata::TabularDataColumnType::String )
+		{
+			qint64 valuesSize = type.width == 0 ? ( node.length + 7 ) / 8 : node.length * type.width;
+			array.values = bodyBuffer( batch, bufferIndex++, body, aBlock.bodyLength, valuesSize, size, isValid );
+			continue;
+		}
+
+		// The offsets have to grow within the text.
+		qint64 textSize = 0;
+		array.offsets = bodyBuffer( batch, bufferIndex++, body, aBlock.bodyLength, node.length > 0 ? ( node.length + 1 ) * type.width : 0, size, isValid );
+		array.values  = bodyBuffer( batch, bufferIndex++, body, aBlock.bodyLength, 0, textSize, isValid );
+
+		qint64 previous = 0;
+		for ( qint64 rowIndex = 0; rowIndex <= node.length && node.length > 0 && isValid; ++rowIndex )
+		{
+			qint64 offset = 0;
+			std::memcpy( &offset, array.offsets + rowIndex * type.width, size_t( type.width ) );
+			if ( type.width == 4 ) offset = qint32( offset );
+
+			isValid = offset >= ( rowIndex == 0 ? 0 : previous ) && offset <= textSize;
+			previous = offset;
+		}
+	}
+
+	return isValid;
+}
+
+bool isValidAt( const ArrowArray& aArray, qint64 aIndex )
+{
+	return aArray.validity == nullptr || ( ( aArray.validity[ aIndex >> 3 ] >> ( aIndex & 7 ) ) & 1 ) != 0;
+}
+
+qint64 integerAt( const ArrowArray& aArray, const ArrowFieldType& aType, qint64 aIndex )
+{
+	if ( aType.width == 0 ) return ( reinterpret_cast< const uchar* >( aArray.values )[ aIndex >> 3 ] >> ( aIndex & 7 ) ) & 1;
+
+	quint64 bits = 0;
+	std::memcpy( &bits, aArray.values + aIndex * aType.width, size_t( aType.width ) );
+
+	// Sign extension of the narrower signed integers.
+	int shift = 64 - 8 * aType.width;
+	return aType.isSigned && shift > 0 ? qint64( bits << shift ) >> shift : qint64( bits );
+}
+
+double floatAt( const ArrowArray& aArray, const ArrowFieldType& aType, qint64 aIndex )
+{
+	if ( aType.width == 4 )
+	{
+		float value;
+		std::memcpy( &value, aArray.values + aIndex * 4, sizeof( value ) );
+		return value;
+	}
+
+	double value;
+	std::memcpy( &value, aArray.values + aIndex * 8, sizeof( value ) );
+	return value;
+}
+
+const char* textAt( const ArrowArray& aArray, const ArrowFieldType& aType, qint64 aIndex, qint64& aSize )
+{
+	qint64 offsets[ 2 ] = {};
+	std::memcpy( &offsets[ 0 ], aArray.offsets + aIndex * aType.width, size_t( aType.width ) );
+	std::memcpy( &offsets[ 1 ], aArray.offsets + ( aIndex + 1 ) * aType.width, size_t( aType.width ) );
+	if ( aType.width == 4 )
+	{
+		offsets[ 0 ] = qint32( offsets[ 0 ] );
+		offsets[ 1 ] = qint32( offsets[ 1 ] );
+	}
+
+	aSize = offsets[ 1 ] - offsets[ 0 ];
+	return aArray.values + offsets[ 0 ];
+}
+
+}
+
+//-----------------------------------------------------------------------------
+
+TabularDataArrowFileIo::TabularDataArrowFileIo()
+{
+}
+
+//-----------------------------------------------------------------------------
+
+TabularDataArrowFileIo::~TabularDataArrowFileIo()
+{
+}
+
+//-----------------------------------------------------------------------------
+
+bool TabularDataArrowFileIo::load( const QString& aFileName, lpmldata::TabularData& aTabularData )
+{
+	std::shared_ptr< QFile > file = std::make_shared< QFile >( aFileName );
+	if ( !file->open( QIODevice::ReadOnly ) )
+	{
+		qDebug() << "Failed to open: " << aFileName;
+		return false;
+	}
+
+	qint64 fileSize = file->size();
+	const uchar* mapping = fileSize >= 2 * qint64( sizeof( kMagic ) ) + 4 ? file->map( 0, fileSize ) : nullptr;
+	if ( mapping == nullptr )
+	{
+		qDebug() << "Failed to map: " << aFileName;
+		return false;
+	}
+
+	// The mapping lives as long as the columns referring to it.
+	std::shared_ptr< const void > storage( mapping, [ file ]( const void* aData ) { file->unmap( const_cast< uchar* >( static_cast< const uchar* >( aData ) ) ); file->close(); } );
+	const char* data = reinterpret_cast< const char* >( mapping );
+
+	// The file ends with the footer, its size and the magic.
+	qint32 footerSize = 0;
+	std::memcpy( &footerSize, data + fileSize - 10, sizeof( footerSize ) );
+	qint64 footerOffset = fileSize - 10 - footerSize;
+
+	bool isValid = std::memcmp( data, kMagic, 6 ) == 0 && std::memcmp( data + fileSize - 6, kMagic, 6 ) == 0
+		&& footerSize > 0 && footerOffset >= qint64( sizeof( kMagic ) );
+
+	FlatTable footer = isValid ? FlatTable::root( data + footerOffset, footerSize ) : FlatTable();
+	FlatTable schema = footer.table( kFooterSchema );
+	int fieldCount = schema.vectorSize( kSchemaFields );
+	int batchCount = footer.vectorSize( kFooterRecordBatches );
+
+	if ( !schema.isValid() || fieldCount < 1 || batchCount < 0 || schema.scalar( kSchemaEndianness, 2 ) != 0 )
+	{
+		qDebug() << "Not a valid Arrow file: " << aFileName;
+		return false;
+	}
+
+	// The first field holds the keys.
+	QVector< FlatTable > fields( fieldCount );
+	QVector< ArrowFieldType > types( fieldCount );
+	for ( int fieldIndex = 0; fieldIndex < fieldCount; ++fieldIndex )
+	{
+		fields[ fieldIndex ] = schema.tableAt( kSchemaFields, fieldIndex );
+		if ( !fieldType( fields.at( fieldIndex ), types[ fieldIndex ] ) )
+		{
+			qDebug() << "Skipping the column of an unsupported type: " << QString::fromUtf8( fields.at( fieldIndex ).string( kFieldName ) );
+			types[ fieldIndex ].typeId = 0;
+		}
+	}
+
+	if ( types.first().typeId != kIntType && types.first().columnType != lpmldata::TabularDataColumnType::String )
+	{
+		qDebug() << "The first column of an Arrow file has to hold text or integer keys: " << aFileName;
+		return false;
+	}
+
+	QVector< QVector< ArrowArray > > batches( batchCount );
+	qint64 rowCount = 0;
+	for ( int batchIndex = 0; batchIndex < batchCount && isValid; ++batchIndex )
+	{
+		ArrowBlock block;
+		const char* blockData = footer.structAt( kFooterRecordBatches, batchIndex, sizeof( ArrowBlock ) );
+		isValid = blockData != nullptr;
+		if ( isValid ) std::memcpy( &block, blockData, sizeof( block ) );
+
+		isValid = isValid && readBatch( data, fileSize, block, fields, types, batches[ batchIndex ] );
+		rowCount += isValid ? batches.at( batchIndex ).first().length : 0;
+	}
+
+	if ( !isValid || rowCount > std::numeric_limits< int >::max() )
+	{
+		qDebug() << "Corrupt or unsupported Arrow file: " << aFileName;
+		return false;
+	}
+
+	// Keys.
+	QList< QString > keys;
+	keys.reserve( int( rowCount ) );
+	for ( const QVector< ArrowArray >& batch : batches )
+	{
+		const ArrowArray& array = batch.first();
+		for ( qint64 index = 0; index < array.length; ++index )
+		{
+			qint64 size = 0;
+			if ( !isValidAt( array, index ) )
+			{
+				keys.push_back( QString() );
+			}
+			else if ( types.first().typeId == kIntType )
+			{
+				keys.push_back( QString::number( integerAt( array, types.first(), index ) ) );
+			}
+			else
+			{
+				const char* text = textAt( array, types.first(), index, size );
+				keys.push_back( QString::fromUtf8( text, int( size ) ) );
+			}
+		}
+	}
+
+	// Columns. A single batch of 8 byte values without nulls is used in place, with a shared bitmap of valid rows.
+	lpmldata::TabularDataSchema tableSchema;
+	QVector< lpmldata::TabularDataColumn > columns;
+	std::shared_ptr< QVector< quint64 > > allValid;
+	int validityWordCount = int( ( rowCount + 63 ) / 64 );
+
+	for ( int fieldIndex = 1; fieldIndex < fieldCount; ++fieldIndex )
+	{
+		const ArrowFieldType& type = types.at( fieldIndex );
+		if ( type.typeId == 0 ) continue;
+
+		tableSchema.append( QString::fromUtf8( fields.at( fieldIndex ).string( kFieldName ) ), type.columnType );
+
+		const ArrowArray& first = batches.isEmpty() ? ArrowArray() : batches.first().at( fieldIndex );
+		bool isInPlace = batches.size() == 1 && rowCount > 0 && type.width == 8 && type.isSigned && type.columnType != lpmldata::TabularDataColumnType::String
+			&& first.nullCount == 0 && reinterpret_cast< quintptr >( first.values ) % sizeof( double ) == 0;
+
+		if ( isInPlace )
+		{
+			if ( !allValid )
+			{
+				allValid = std::make_shared< QVector< quint64 > >( std::max( validityWordCount, 1 ), ~quint64( 0 ) );
+				if ( ( rowCount & 63 ) != 0 ) allValid->last() = ( quint64( 1 ) << ( rowCount & 63 ) ) - 1;
+			}
+
+			std::shared_ptr< const void > columnStorage( allValid->constData(), [ storage, allValid ]( const void* ) {} );
+			columns.push_back( lpmldata::TabularDataColumn( type.columnType, int( rowCount ), first.values, allValid->constData(), nullptr, 0, columnStorage ) );
+			continue;
+		}
+
+		// The text of the batches, that of nulls included, bounds the text of the column.
+		quint64 textSize = 0;
+		for ( const QVector< ArrowArray >& batch : batches )
+		{
+			const ArrowArray& array = batch.at( fieldIndex );
+			qint64 size = 0;
+			if ( type.columnType == lpmldata::TabularDataColumnType::String && array.length > 0 )
+			{
+				const char* begin = textAt( array, type, 0, size );
+				const char* last = textAt( array, type, array.length - 1, size );
+				textSize += quint64( last + size - begin );
+			}
+		}
+
+		if ( textSize > std::numeric_limits< quint32 >::max() )
+		{
+			qDebug() << "Column text above 4 GB in: " << aFileName;
+			return false;
+		}
+
+		lpmldata::TabularDataColumn column( type.columnType );
+		column.resize( int( rowCount ) );
+		column.reset( type.columnType, quint32( textSize ) );
+
+		QVector< quint64 > validity( validityWordCount, 0 );
+		int row = 0;
+		quint32 textOffset = 0;
+		for ( const QVector< ArrowArray >& batch : batches )
+		{
+			const ArrowArray& array = batch.at( fieldIndex );
+			for ( qint64 index = 0; index < array.length; ++index, ++row )
+			{
+				if ( !isValidAt( array, index ) ) continue;
+
+				validity[ row >> 6 ] |= quint64( 1 ) << ( row & 63 );
+				if ( type.columnType == lpmldata::TabularDataColumnType::Float )
+				{
+					column.fill( row, floatAt( array, type, index ) );
+				}
+				else if ( type.columnType == lpmldata::TabularDataColumnType::Integer )
+				{
+					column.fill( row, integerAt( array, type, index ) );
+				}
+				else
+				{
+					qint64 size = 0;
+					const char* text = textAt( array, type, index, size );
+					column.fill( row, text, quint32( size ), textOffset );
+					textOffset += quint32( size );
+				}
+			}
+		}
+
+		for ( int wordIndex = 0; wordIndex < validityWordCount; ++wordIndex )
+		{
+			if ( validity.at( wordIndex ) != 0 ) column.fillValidity( wordIndex, validity.at( wordIndex ) );
+		}
+
+		columns.push_back( std::move( column ) );
+	}
+
+	aTabularData.assign( tableSchema.toHeader(), keys, std::move( columns ) );
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool TabularDataArrowFileIo::save( const QString& aFileName, const lpmldata::TabularData& aTabularData )
+{
+	qint64 rowCount = aTabularData.rowCount();
+	int columnCount = aTabularData.columnCount();
+	qint64 validitySize = ( rowCount + 7 ) / 8;
+
+	QVector< QByteArray > keys;
+	keys.reserve( int( rowCount ) );
+	qint64 keyTextSize = 0;
+	for ( const QString& key : aTabularData.keys() )
+	{
+		keys.push_back( key.toUtf8() );
+		keyTextSize += keys.last().size();
+	}
+
+	// Schema, nodes and buffers: the keys as a non-nullable utf8 field, then the columns.
+	QVector< ArrowField > fields;
+	QVector< ArrowFieldNode > nodes;
+	QVector< ArrowBuffer > buffers;
+	QVector< char > isLarge;
+	qint64 bodyLength = 0;
+	auto addBuffer = [ & ]( qint64 aSize )
+	{
+		buffers.push_back( { bodyLength, aSize } );
+		bodyLength += alignedOffset( aSize );
+	};
+
+	isLarge.push_back( keyTextSize > std::numeric_limits< qint32 >::max() ? 1 : 0 );
+	fields.push_back( { QByteArray( "Key" ), isLarge.last() ? kLargeUtf8Type : kUtf8Type, false } );
+	nodes.push_back( { rowCount, 0 } );
+	addBuffer( 0 );
+	addBuffer( ( rowCount + 1 ) * ( isLarge.last() ? 8 : 4 ) );
+	addBuffer( keyTextSize );
+
+	for ( int columnIndex = 0; columnIndex < columnCount; ++columnIndex )
+	{
+		const lpmldata::TabularDataColumn& column = aTabularData.columnData( columnIndex );
+		qint64 nullCount = 0;
+		qint64 textSize = 0;
+		for ( int rowIndex = 0; rowIndex < rowCount; ++rowIndex )
+		{
+			int size = 0;
+			if ( !column.isValid( rowIndex ) )
+			{
+				++nullCount;
+			}
+			else if ( column.type() == lpmldata::TabularDataColumnType::String )
+			{
+				column.textAt( rowIndex, size );
+				textSize += size;
+			}
+		}
+
+		// A bitmap is written only if there are nulls.
+		nodes.push_back( { rowCount, nullCount } );
+		addBuffer( nullCount > 0 ? validitySize : 0 );
+
+		isLarge.push_back( textSize > std::numeric_limits< qint32 >::max() ? 1 : 0 );
+		QByteArray name = aTabularData.schema().name( columnIndex ).toUtf8();
+		switch ( column.type() )
+		{
+			case lpmldata::TabularDataColumnType::Float:
+				fields.push_back( { name, kFloatingPointType, true } );
+				addBuffer( rowCount * qint64( sizeof( double ) ) );
+				break;
+
+			case lpmldata::TabularDataColumnType::Integer:
+				fields.push_back( { name, kIntType, true } );
+				addBuffer( rowCount * qint64( sizeof( qint64 ) ) );
+				break;
+
+			case lpmldata::TabularDataColumnType::String:
+				fields.push_back( { name, isLarge.last() ? kLargeUtf8Type : kUtf8Type, true } );
+				addBuffer( ( rowCount + 1 ) * ( isLarge.last() ? 8 : 4 ) );
+				addBuffer( textSize );
+				break;
+		}
+	}
+
+	FlatBufferBuilder schemaBuilder;
+	int schemaMessage = schemaBuilder.addTable();
+	schemaBuilder.setScalar( schemaMessage, kMessageVersion, quint64( kMetadataVersion ), 2 );
+	schemaBuilder.setScalar( schemaMessage, kMessageHeaderType, kSchemaMessage, 1 );
+	schemaBuilder.setObject( schemaMessage, kMessageHeader, addSchema( schemaBuilder, fields ) );
+	schemaBuilder.setScalar( schemaMessage, kMessageBodyLength, 0, 8 );
+
+	FlatBufferBuilder batchBuilder;
+	int batch = batchBuilder.addTable();
+	batchBuilder.setScalar( batch, kBatchLength, quint64( rowCount ), 8 );
+	batchBuilder.setObject( batch, kBatchNodes, batchBuilder.addStructVector( nodes.constData(), nodes.size(), sizeof( ArrowFieldNode ) ) );
+	batchBuilder.setObject( batch, kBatchBuffers, batchBuilder.addStructVector( buffers.constData(), buffers.size(), sizeof( ArrowBuffer ) ) );
+
+	int batchMessage = batchBuilder.addTable();
+	batchBuilder.setScalar( batchMessage, kMessageVersion, quint64( kMetadataVersion ), 2 );
+	batchBuilder.setScalar( batchMessage, kMessageHeaderType, kRecordBatchMessage, 1 );
+	batchBuilder.setObject( batchMessage, kMessageHeader, batch );
+	batchBuilder.setScalar( batchMessage, kMessageBodyLength, quint64( bodyLength ), 8 );
+
+	// Magic, schema, record batch, end of stream, footer.
+	QFile file( aFileName );
+	if ( !file.open( QIODevice::WriteOnly ) )
+	{
+		qDebug() << "Cannot open for write: " << aFileName;
+		return false;
+	}
+
+	bool isWritten = file.write( kMagic, sizeof( kMagic ) ) == qint64( sizeof( kMagic ) )
+		&& writeMessage( file, schemaBuilder.finish( schemaMessage ) ) > 0;
+
+	ArrowBlock block = { file.pos(), 0, 0, bodyLength };
+	block.metaDataLength = isWritten ? writeMessage( file, batchBuilder.finish( batchMessage ) ) : 0;
+	isWritten = block.metaDataLength > 0
+		&& writeUtf8( file, rowCount, isLarge.first() != 0, [ & ]( int aRow, int& aSize ) { aSize = keys.at( aRow ).size(); return keys.at( aRow ).constData(); } );
+
+	QVector< quint64 > validity( int( ( rowCount + 63 ) / 64 ) );
+	for ( int columnIndex = 0; columnIndex < columnCount && isWritten; ++columnIndex )
+	{
+		const lpmldata::TabularDataColumn& column = aTabularData.columnData( columnIndex );
+
+		// Bits beyond the last row are cleared.
+		if ( !validity.isEmpty() )
+		{
+			std::memcpy( validity.data(), column.validity(), validity.size() * sizeof( quint64 ) );
+			if ( ( rowCount & 63 ) != 0 )
+			{
+				validity.last() &= ( quint64( 1 ) << ( rowCount & 63 ) ) - 1;
+			}
+		}
+
+		isWritten = writeBlock( file, validity.constData(), nodes.at( columnIndex + 1 ).nullCount > 0 ? validitySize : 0 );
+		if ( column.type() == lpmldata::TabularDataColumnType::String )
+		{
+			isWritten = isWritten && writeUtf8( file, rowCount, isLarge.at( columnIndex + 1 ) != 0, [ & ]( int aRow, int& aSize ) { aSize = 0; return column.isValid( aRow ) ? column.textAt( aRow, aSize ) : nullptr; } );
+		}
+		else
+		{
+			isWritten = isWritten && writeBlock( file, column.cells(), rowCount * qint64( sizeof( double ) ) );
+		}
+	}
+
+	FlatBufferBuilder footerBuilder;
+	int footer = footerBuilder.addTable();
+	footerBuilder.setScalar( footer, kFooterVersion, quint64( kMetadataVersion ), 2 );
+	footerBuilder.setObject( footer, kFooterSchema, addSchema( footerBuilder, fields ) );
+	footerBuilder.setObject( footer, kFooterDictionaries, footerBuilder.addStructVector( nullptr, 0, sizeof( ArrowBlock ) ) );
+	footerBuilder.setObject( footer, kFooterRecordBatches, footerBuilder.addStructVector( &block, 1, sizeof( ArrowBlock ) ) );
+	QByteArray footerData = footerBuilder.finish( footer );
+
+	qint32 endOfStream[ 2 ] = { qint32( kContinuation ), 0 };
+	qint32 footerSize = footerData.size();
+	isWritten = isWritten && file.write( reinterpret_cast< const char* >( endOfStream ), sizeof( endOfStream ) ) == qint64( sizeof( endOfStream ) )
+		&& file.write( footerData ) == footerData.size()
+		&& file.write( reinterpret_cast< const char* >( &footerSize ), sizeof( footerSize ) ) == qint64( sizeof( footerSize ) )
+		&& file.write( kMagic, 6 ) == 6;
+
+	file.close();
+
+	if ( !isWritten )
+	{
+		qDebug() << "Failed to write: " << aFileName;
+	}
+
+	return isWritten;
+}
+
+//-----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,69 @@
+/*!
+* \file This file is part of FileIo module.
+* The TabularDataArrowFileIo class reads and writes tabular data in the Apache Arrow IPC file format (Feather V2), e.g. to
+* exchange tables with pandas and pyarrow without CSV.
+*
+* \remarks
+* The first column of the file holds the keys, like the first field of a CSV record; it is called Key when saving.
+* Type mapping on save: Float -> float64, Integer -> int64, String -> utf8 (large_utf8 above 2 GB of text), the keys are a
+* non-nullable utf8 column. Loading also accepts the other integer widths, bool (as Integer), float32 and large_utf8; columns
+* of other types, e.g. timestamps or dictionary encoded ones, are skipped. Compressed record batches are not supported,
+* pyarrow has to write them with compression='uncompressed'.
+* In Python:
+* \code
+* import pyarrow as pa
+* table = pa.ipc.open_file( pa.memory_map( 'result.arrow' ) ).read_all()
+* frame = table.to_pandas().set_index( 'Key' )
+* \endcode
+*
+* \authors
+* lpapp
+*/
+
+#pragma once
+
+#include <FileIo/Export.h>
+#include <DataRepresentation/TabularData.h>
+
+namespace lpmlfio
+{
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Arrow IPC file IO of tabular data, without any dependency on the Arrow libraries.
+*
+* \details Saving writes a single record batch whose Float and Integer buffers are the cells of the columns as they are.
+* Loading maps the file: float64 and int64 columns of a file of a single record batch without nulls refer to the mapped
+* buffers without copying them, like the columns loaded by TabularDataBinaryFileIo; all other columns are copied.
+*/
+class FileIo_API TabularDataArrowFileIo
+{
+
+public:
+
+	TabularDataArrowFileIo();
+
+	~TabularDataArrowFileIo();
+
+	/*!
+	* \brief Loads an Arrow IPC file.
+	* \param [in] aFileName The full path of the file.
+	* \param [out] aTabularData The loaded table.
+	* \return True on success.
+	*/
+	bool load( const QString& aFileName, lpmldata::TabularData& aTabularData );
+
+	/*!
+	* \brief Saves the table as an Arrow IPC file.
+	* \param [in] aFileName The full path of the file.
+	* \param [in] aTabularData The table to save.
+	* \return True on success.
+	*/
+	bool save( const QString& aFileName, const lpmldata::TabularData& aTabularData );
+
+};
+
+//-----------------------------------------------------------------------------
+
+}
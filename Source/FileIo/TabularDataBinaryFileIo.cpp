@@ -0,0 +1,409 @@
+/*!
+* \file
+* Member function definitions for TabularDataBinaryFileIo class. This file is part of FileIo module.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#include <FileIo/TabularDataBinaryFileIo.h>
+#include <QFile>
+#include <QDebug>
+#include <cstring>
+#include <limits>
+#include <memory>
+
+namespace lpmlfio
+{
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+const char    kMagic[ 8 ]     = { 'L', 'P', 'M', 'L', 'T', 'D', 'B', '\0' };
+const quint32 kVersion        = 1;
+const quint32 kChecksumFlag   = 1;
+const qint64  kBlockAlignment = 64;
+
+struct BinaryHeader
+{
+	char     magic[ 8 ];
+	quint32  version;
+	quint32  flags;
+	quint64  rowCount;
+	quint64  columnCount;
+	quint64  stringsOffset;
+	quint64  stringsSize;
+	quint64  keysOffset;
+	quint32  nameOffset;      // Offset of the table name in the strings block.
+	quint32  nameLength;
+	quint64  checksum;
+	quint64  reserved[ 7 ];
+};
+
+struct BinaryColumn
+{
+	quint32  type;
+	quint32  nameLength;
+	quint64  nameOffset;      // Offset of the column name in the strings block.
+	quint64  cellsOffset;
+	quint64  validityOffset;
+	quint64  textOffset;
+	quint64  textSize;
+	quint64  reserved[ 2 ];
+};
+
+struct StringCell
+{
+	quint32  offset;
+	quint32  length;
+};
+
+static_assert( sizeof( BinaryHeader ) == 128, "The binary file header must be 128 bytes." );
+static_assert( sizeof( BinaryColumn ) == 64, "A binary column entry must be 64 bytes." );
+
+qint64 alignedOffset( qint64 aOffset )
+{
+	return ( aOffset + kBlockAlignment - 1 ) / kBlockAlignment * kBlockAlignment;
+}
+
+quint64 rotateLeft( quint64 aValue, int aBits )
+{
+	return ( aValue << aBits ) | ( aValue >> ( 64 - aBits ) );
+}
+
+bool isInFile( quint64 aOffset, quint64 aSize, qint64 aFileSize )
+{
+	return aOffset <= quint64( aFileSize ) && aSize <= quint64( aFileSize ) - aOffset;
+}
+
+/*!
+* \brief Writes a block and pads it with zeros up to the next aligned offset.
+*/
+bool writeBlock( QFile& aFile, const void* aData, qint64 aSize )
+{
+	static const char padding[ kBlockAlignment ] = {};
+
+	if ( aSize > 0 && aFile.write( static_cast< const char* >( aData ), aSize ) != aSize ) return false;
+
+	qint64 paddingSize = alignedOffset( aSize ) - aSize;
+	return paddingSize == 0 || aFile.write( padding, paddingSize ) == paddingSize;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+
+TabularDataBinaryFileIo::TabularDataBinaryFileIo()
+{
+}
+
+//-----------------------------------------------------------------------------
+
+TabularDataBinaryFileIo::~TabularDataBinaryFileIo()
+{
+}
+
+//-----------------------------------------------------------------------------
+
+bool TabularDataBinaryFileIo::load( const QString& aFileName, lpmldata::TabularData& aTabularData, bool aIsChecksumVerified )
+{
+	std::shared_ptr< QFile > file = std::make_shared< QFile >( aFileName );
+	if ( !file->open( QIODevice::ReadOnly ) )
+	{
+		qDebug() << "Failed to open: " << aFileName;
+		return false;
+	}
+
+	qint64 fileSize = file->size();
+	const uchar* data = fileSize >= qint64( sizeof( BinaryHeader ) ) ? file->map( 0, fileSize ) : nullptr;
+	if ( data == nullptr )
+	{
+		qDebug() << "Failed to map: " << aFileName;
+		return false;
+	}
+
+	// The mapping lives as long as the columns referring to it.
+	std::shared_ptr< const void > storage( data, [ file ]( const void* aData ) { file->unmap( const_cast< uchar* >( static_cast< const uchar* >( aData ) ) ); file->close(); } );
+
+	BinaryHeader header;
+	std::memcpy( &header, data, sizeof( BinaryHeader ) );
+
+	quint64 columnDirectorySize = header.columnCount * sizeof( BinaryColumn );
+	bool isValid = std::memcmp( header.magic, kMagic, sizeof( kMagic ) ) == 0 && header.version == kVersion
+		&& header.rowCount <= quint64( std::numeric_limits< int >::max() ) && header.columnCount <= quint64( std::numeric_limits< int >::max() )
+		&& isInFile( sizeof( BinaryHeader ), columnDirectorySize, fileSize )
+		&& isInFile( header.stringsOffset, header.stringsSize, fileSize )
+		&& isInFile( header.keysOffset, header.rowCount * sizeof( StringCell ), fileSize )
+		&& quint64( header.nameOffset ) + header.nameLength <= header.stringsSize;
+
+	if ( !isValid )
+	{
+		qDebug() << "Not a valid binary tabular data file: " << aFileName;
+		return false;
+	}
+
+	if ( aIsChecksumVerified && ( header.flags & kChecksumFlag ) != 0 )
+	{
+		const char* body = reinterpret_cast< const char* >( data ) + sizeof( BinaryHeader );
+		if ( checksum( body, fileSize - qint64( sizeof( BinaryHeader ) ) ) != header.checksum )
+		{
+			qDebug() << "Checksum mismatch: " << aFileName;
+			return false;
+		}
+	}
+
+	int rowCount = int( header.rowCount );
+	int columnCount = int( header.columnCount );
+	const char* strings = reinterpret_cast< const char* >( data ) + header.stringsOffset;
+
+	// Keys.
+	QList< QString > keys;
+	keys.reserve( rowCount );
+	const StringCell* keyCells = reinterpret_cast< const StringCell* >( data + header.keysOffset );
+	for ( int rowIndex = 0; rowIndex < rowCount; ++rowIndex )
+	{
+		const StringCell& keyCell = keyCells[ rowIndex ];
+		if ( quint64( keyCell.offset ) + keyCell.length > header.stringsSize )
+		{
+			qDebug() << "Corrupt key dictionary: " << aFileName;
+			return false;
+		}
+
+		keys.push_back( QString::fromUtf8( strings + keyCell.offset, int( keyCell.length ) ) );
+	}
+
+	// Columns, referring to the mapped blocks.
+	lpmldata::TabularDataSchema schema;
+	QVector< lpmldata::TabularDataColumn > columns;
+	columns.reserve( columnCount );
+
+	const BinaryColumn* columnEntries = reinterpret_cast< const BinaryColumn* >( data + sizeof( BinaryHeader ) );
+	quint64 validitySize = ( header.rowCount + 63 ) / 64 * sizeof( quint64 );
+
+	for ( int columnIndex = 0; columnIndex < columnCount; ++columnIndex )
+	{
+		const BinaryColumn& entry = columnEntries[ columnIndex ];
+
+		isValid = entry.type <= quint32( lpmldata::TabularDataColumnType::String )
+			&& entry.nameOffset + entry.nameLength <= header.stringsSize
+			&& entry.cellsOffset % sizeof( double ) == 0 && entry.validityOffset % sizeof( quint64 ) == 0
+			&& isInFile( entry.cellsOffset, header.rowCount * sizeof( double ), fileSize )
+			&& isInFile( entry.validityOffset, validitySize, fileSize )
+			&& isInFile( entry.textOffset, entry.textSize, fileSize ) && entry.textSize <= std::numeric_limits< quint32 >::max();
+
+		lpmldata::TabularDataColumnType type = lpmldata::TabularDataColumnType( entry.type );
+		if ( isValid && type == lpmldata::TabularDataColumnType::String )
+		{
+			// Text cells are checked once, so that reading them never leaves the text block.
+			const StringCell* textCells = reinterpret_cast< const StringCell* >( data + entry.cellsOffset );
+			for ( int rowIndex = 0; rowIndex < rowCount && isValid; ++rowIndex )
+			{
+				isValid = quint64( textCells[ rowIndex ].offset ) + textCells[ rowIndex ].length <= entry.textSize;
+			}
+		}
+
+		if ( !isValid )
+		{
+			qDebug() << "Corrupt column" << columnIndex << "in" << aFileName;
+			return false;
+		}
+
+		const char* text = type == lpmldata::TabularDataColumnType::String ? reinterpret_cast< const char* >( data + entry.textOffset ) : nullptr;
+		columns.push_back( lpmldata::TabularDataColumn( type, rowCount, data + entry.cellsOffset, reinterpret_cast< const quint64* >( data + entry.validityOffset ), text, quint32( entry.textSize ), storage ) );
+		schema.append( QString::fromUtf8( strings + entry.nameOffset, int( entry.nameLength ) ), type );
+	}
+
+	aTabularData.assign( schema.toHeader(), keys, std::move( columns ) );
+	aTabularData.name() = QString::fromUtf8( strings + header.nameOffset, int( header.nameLength ) );
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool TabularDataBinaryFileIo::save( const QString& aFileName, const lpmldata::TabularData& aTabularData, bool aIsChecksumWritten )
+{
+	quint64 rowCount = aTabularData.rowCount();
+	quint64 columnCount = aTabularData.columnCount();
+	quint64 validityWordCount = ( rowCount + 63 ) / 64;
+
+	// Strings block: table name, column names, keys.
+	QByteArray strings;
+	BinaryHeader header = {};
+	std::memcpy( header.magic, kMagic, sizeof( kMagic ) );
+	header.version     = kVersion;
+	header.rowCount    = rowCount;
+	header.columnCount = columnCount;
+
+	QByteArray name = aTabularData.name().toUtf8();
+	header.nameOffset = 0;
+	header.nameLength = quint32( name.size() );
+	strings.append( name );
+
+	QVector< BinaryColumn > columnEntries( static_cast< int >( columnCount ) );
+	for ( int columnIndex = 0; columnIndex < int( columnCount ); ++columnIndex )
+	{
+		QByteArray columnName = aTabularData.schema().name( columnIndex ).toUtf8();
+		BinaryColumn& entry = columnEntries[ columnIndex ];
+		std::memset( &entry, 0, sizeof( BinaryColumn ) );
+		entry.type       = quint32( aTabularData.columnData( columnIndex ).type() );
+		entry.nameOffset = quint64( strings.size() );
+		entry.nameLength = quint32( columnName.size() );
+		strings.append( columnName );
+	}
+
+	// The key cells hold 32 bit offsets into the strings block, which is also bounded by the size of a QByteArray.
+	const QList< QString >& keys = aTabularData.keys();
+	QVector< StringCell > keyCells( static_cast< int >( rowCount ) );
+	for ( int rowIndex = 0; rowIndex < int( rowCount ); ++rowIndex )
+	{
+		QByteArray key = keys.at( rowIndex ).toUtf8();
+		if ( quint64( strings.size() ) + quint64( key.size() ) > quint64( std::numeric_limits< int >::max() ) )
+		{
+			qDebug() << "Keys and names above 2 GB, cannot save: " << aFileName;
+			return false;
+		}
+
+		keyCells[ rowIndex ].offset = quint32( strings.size() );
+		keyCells[ rowIndex ].length = quint32( key.size() );
+		strings.append( key );
+	}
+
+	// Layout.
+	qint64 offset = alignedOffset( qint64( sizeof( BinaryHeader ) + columnCount * sizeof( BinaryColumn ) ) );
+	header.stringsOffset = quint64( offset );
+	header.stringsSize   = quint64( strings.size() );
+	offset = alignedOffset( offset + strings.size() );
+	header.keysOffset = quint64( offset );
+	offset = alignedOffset( offset + qint64( rowCount * sizeof( StringCell ) ) );
+
+	for ( BinaryColumn& entry : columnEntries )
+	{
+		const lpmldata::TabularDataColumn& column = aTabularData.columnData( int( &entry - columnEntries.data() ) );
+		entry.cellsOffset = quint64( offset );
+		offset = alignedOffset( offset + qint64( rowCount * sizeof( double ) ) );
+		entry.validityOffset = quint64( offset );
+		offset = alignedOffset( offset + qint64( validityWordCount * sizeof( quint64 ) ) );
+		entry.textOffset = quint64( offset );
+		entry.textSize   = column.type() == lpmldata::TabularDataColumnType::String ? column.textSize() : 0;
+		offset = alignedOffset( offset + qint64( entry.textSize ) );
+	}
+
+	// Blocks in layout order.
+	QFile file( aFileName );
+	if ( !file.open( QIODevice::WriteOnly ) )
+	{
+		qDebug() << "Cannot open for write: " << aFileName;
+		return false;
+	}
+
+	bool isWritten = writeBlock( file, &header, sizeof( BinaryHeader ) )
+		&& writeBlock( file, columnEntries.constData(), qint64( columnCount * sizeof( BinaryColumn ) ) )
+		&& writeBlock( file, strings.constData(), strings.size() )
+		&& writeBlock( file, keyCells.constData(), qint64( rowCount * sizeof( StringCell ) ) );
+
+	QVector< quint64 > validity( static_cast< int >( validityWordCount ) );
+	for ( int columnIndex = 0; columnIndex < int( columnCount ) && isWritten; ++columnIndex )
+	{
+		const lpmldata::TabularDataColumn& column = aTabularData.columnData( columnIndex );
+
+		// Bits beyond the last row are cleared.
+		if ( validityWordCount > 0 )
+		{
+			std::memcpy( validity.data(), column.validity(), validityWordCount * sizeof( quint64 ) );
+			if ( ( rowCount & 63 ) != 0 )
+			{
+				validity.last() &= ( quint64( 1 ) << ( rowCount & 63 ) ) - 1;
+			}
+		}
+
+		isWritten = writeBlock( file, column.cells(), qint64( rowCount * sizeof( double ) ) )
+			&& writeBlock( file, validity.constData(), qint64( validityWordCount * sizeof( quint64 ) ) )
+			&& writeBlock( file, column.text(), qint64( columnEntries.at( columnIndex ).textSize ) );
+	}
+
+	file.close();
+
+	if ( isWritten && aIsChecksumWritten )
+	{
+		// The checksum is computed over the mapped file, then patched into the header.
+		isWritten = file.open( QIODevice::ReadWrite );
+		const uchar* data = isWritten ? file.map( 0, file.size() ) : nullptr;
+		isWritten = data != nullptr;
+
+		if ( isWritten )
+		{
+			header.flags   |= kChecksumFlag;
+			header.checksum = checksum( reinterpret_cast< const char* >( data ) + sizeof( BinaryHeader ), file.size() - qint64( sizeof( BinaryHeader ) ) );
+			file.unmap( const_cast< uchar* >( data ) );
+			isWritten = file.seek( 0 ) && file.write( reinterpret_cast< const char* >( &header ), sizeof( BinaryHeader ) ) == qint64( sizeof( BinaryHeader ) );
+		}
+
+		file.close();
+	}
+
+	if ( !isWritten )
+	{
+		qDebug() << "Failed to write: " << aFileName;
+	}
+
+	return isWritten;
+}
+
+//-----------------------------------------------------------------------------
+
+quint64 TabularDataBinaryFileIo::checksum( const char* aData, qint64 aSize )
+{
+	const quint64 prime1 = 0x9E3779B185EBCA87ULL;
+	const quint64 prime2 = 0xC2B2AE3D27D4EB4FULL;
+	const quint64 prime3 = 0x165667B19E3779F9ULL;
+
+	// Four independent lanes over 32 byte stripes.
+	quint64 lanes[ 4 ] = { prime1 + prime2, prime2, 0, 0 - prime1 };
+	qint64 position = 0;
+
+	for ( ; position + 32 <= aSize; position += 32 )
+	{
+		quint64 words[ 4 ];
+		std::memcpy( words, aData + position, sizeof( words ) );
+
+		for ( int lane = 0; lane < 4; ++lane )
+		{
+			lanes[ lane ] = rotateLeft( lanes[ lane ] + words[ lane ] * prime2, 31 ) * prime1;
+		}
+	}
+
+	quint64 hash = rotateLeft( lanes[ 0 ], 1 ) + rotateLeft( lanes[ 1 ], 7 ) + rotateLeft( lanes[ 2 ], 12 ) + rotateLeft( lanes[ 3 ], 18 );
+	hash += quint64( aSize );
+
+	for ( ; position + 8 <= aSize; position += 8 )
+	{
+		quint64 word;
+		std::memcpy( &word, aData + position, sizeof( word ) );
+		hash ^= rotateLeft( word * prime2, 31 ) * prime1;
+		hash  = rotateLeft( hash, 27 ) * prime1 + prime3;
+	}
+
+	for ( ; position < aSize; ++position )
+	{
+		hash ^= quint64( static_cast< unsigned char >( aData[ position ] ) ) * prime3;
+		hash  = rotateLeft( hash, 11 ) * prime1;
+	}
+
+	// Final avalanche.
+	hash ^= hash >> 33;
+	hash *= prime2;
+	hash ^= hash >> 29;
+	hash *= prime3;
+	hash ^= hash >> 32;
+
+	return hash;
+}
+
+//-----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,70 @@
+/*!
+* \file This file is part of FileIo module.
+* The TabularDataBinaryFileIo class reads and writes tabular data in a memory mappable, columnar binary format.
+*
+* \remarks
+* File layout, every block starts at a 64 byte aligned file offset and integers are little endian:
+*   - 128 byte file header: magic "LPMLTDB", version, flags, row and column count, location of the strings and keys, checksum
+*   - column directory: one 64 byte entry per column with its type, name and the location of its blocks
+*   - strings block: UTF-8 text of the table name, the column names and the keys
+*   - key cells: one ( 32 bit offset, 32 bit length ) pair per row into the strings block
+*   - per column: the 8 byte cells, the validity bitmap and, for String columns, the UTF-8 text the cells refer to
+* The checksum covers everything after the file header.
+*
+* \authors
+* lpapp
+*/
+
+#pragma once
+
+#include <FileIo/Export.h>
+#include <DataRepresentation/TabularData.h>
+
+namespace lpmlfio
+{
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Binary file IO of tabular data. Loading maps the file and the columns refer to the mapped blocks without copying them.
+*
+* \details The mapping is kept alive as long as any column of the loaded table (or of a copy of it) refers to it. A mapped
+* column is copied into memory on its first modification, the file itself is never written through the mapping.
+*/
+class FileIo_API TabularDataBinaryFileIo
+{
+
+public:
+
+	TabularDataBinaryFileIo();
+
+	~TabularDataBinaryFileIo();
+
+	/*!
+	* \brief Maps a binary tabular data file.
+	* \param [in] aFileName The full path of the file.
+	* \param [out] aTabularData The loaded table.
+	* \param [in] aIsChecksumVerified If true and the file has a checksum, the whole file is read once to verify it.
+	* \return True on success.
+	*/
+	bool load( const QString& aFileName, lpmldata::TabularData& aTabularData, bool aIsChecksumVerified = false );
+
+	/*!
+	* \brief Saves the table in the binary format.
+	* \param [in] aFileName The full path of the file.
+	* \param [in] aTabularData The table to save.
+	* \param [in] aIsChecksumWritten If true, the checksum of the file is computed and stored in its header.
+	* \return True on success.
+	*/
+	bool save( const QString& aFileName, const lpmldata::TabularData& aTabularData, bool aIsChecksumWritten = true );
+
+	/*!
+	* \brief Computes a fast, non-cryptographic 64 bit hash of a memory block, processing four 8 byte words per step.
+	*/
+	static quint64 checksum( const char* aData, qint64 aSize );
+
+};
+
+//-----------------------------------------------------------------------------
+
+}
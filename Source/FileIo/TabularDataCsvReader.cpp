@@ -0,0 +1,229 @@
+/*!
+* \file
+* Member function definitions for TabularDataCsvReader class. This file is part of FileIo module.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#include <FileIo/TabularDataCsvReader.h>
+#include <FileIo/GzipStream.h>
+#include <DataRepresentation/NumberParser.h>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+namespace lpmlfio
+{
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+const qint64 kBlockSize = qint64( 4 ) << 20;
+
+}
+
+//-----------------------------------------------------------------------------
+
+TabularDataCsvReader::TabularDataCsvReader( const QString& aFileName, const TabularDataLoadOptions& aOptions, char aSeparator )
+:
+	mFile( aFileName ),
+	mPosition( 0 ),
+	mIsAtEnd( true ),
+	mSeparator( aSeparator ),
+	mRecordCount( 0 )
+{
+	if ( !mFile.open( QIODevice::ReadOnly ) )
+	{
+		qDebug() << "Failed to open: " << aFileName;
+		return;
+	}
+
+	mIsAtEnd = false;
+	readBlock();
+
+	// A gzip file is inflated from its mapping instead.
+	if ( GzipInflater::isGzip( mBuffer.constData(), mBuffer.size() ) )
+	{
+		mBuffer.clear();
+		const uchar* data = mFile.map( 0, mFile.size() );
+		if ( data )
+		{
+			mInflater.reset( new GzipInflater( reinterpret_cast< const char* >( data ), mFile.size() ) );
+			readBlock();
+		}
+		else
+		{
+			qDebug() << "Failed to map: " << aFileName;
+			mIsAtEnd = true;
+		}
+	}
+
+	// Skip the UTF-8 byte order mark.
+	if ( mBuffer.size() >= 3 && std::memcmp( mBuffer.constData(), "\xEF\xBB\xBF", 3 ) == 0 )
+	{
+		mPosition = 3;
+	}
+
+	// Read the header, the first field names the key column. Remove a possible empty field from the end.
+	QStringList headerNames;
+	if ( readRecord() )
+	{
+		if ( !mFields.isEmpty() && mFields.last().size == 0 )
+		{
+			mFields.removeLast();
+		}
+
+		for ( int headerIndex = 1; headerIndex < mFields.size(); ++headerIndex )
+		{
+			headerNames.push_back( CsvTokenizer::toString( mFields.at( headerIndex ) ) );
+		}
+	}
+
+	mLayout = layoutCsv( headerNames, aOptions );
+
+	// The columns named by the schema get their declared type, the others start as Float.
+	int columnCount = mLayout.fieldIndices.size();
+	mIsDeclared.fill( 0, columnCount );
+	for ( int columnIndex = 0; columnIndex < columnCount; ++columnIndex )
+	{
+		QString name = headerNames.at( mLayout.fieldIndices.at( columnIndex ) - 1 );
+		int schemaIndex = aOptions.schema.indexOf( name );
+		lpmldata::TabularDataColumnType type = schemaIndex < 0 ? lpmldata::TabularDataColumnType::Float : aOptions.schema.type( schemaIndex );
+		mIsDeclared[ columnIndex ] = schemaIndex < 0 ? 0 : 1;
+
+		QVariantList headerValue = { name, lpmldata::TabularDataSchema::typeName( type ) };
+		mHeader.insert( QString::number( columnIndex ), headerValue );
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+TabularDataCsvReader::~TabularDataCsvReader()
+{
+}
+
+//-----------------------------------------------------------------------------
+
+bool TabularDataCsvReader::readBatch( lpmldata::TabularData& aBatch, int aRowCount )
+{
+	// A new table, so the keys of the previous batch are released with its symbol pool.
+	aBatch = lpmldata::TabularData();
+	aBatch.setHeader( mHeader );
+	aBatch.reserve( aRowCount );
+
+	int columnCount = mLayout.fieldIndices.size();
+	int recordCount = 0;
+	QByteArray unescaped;
+
+	while ( recordCount < aRowCount && readRecord() )
+	{
+		if ( mFields.size() == 1 && mFields.first().size == 0 ) continue;  // Empty line.
+		if ( !meetsConditions( mFields, mLayout.conditions ) ) continue;
+
+		int rowIndex = aBatch.insertRow( CsvTokenizer::toString( mFields.first() ) );
+		for ( int columnIndex = 0; columnIndex < columnCount; ++columnIndex )
+		{
+			int fieldIndex = mLayout.fieldIndices.at( columnIndex );
+			if ( fieldIndex >= mFields.size() )
+			{
+				aBatch.setValueAt( rowIndex, columnIndex, nullptr, 0 );
+				continue;
+			}
+
+			const CsvField& field = mFields.at( fieldIndex );
+			const char* text = field.data;
+			int size = field.size;
+			if ( field.isEscaped )
+			{
+				unescaped = CsvTokenizer::toUtf8( field );
+				text = unescaped.constData();
+				size = unescaped.size();
+			}
+
+			// A fixed type is kept, a field of another type is a missing value.
+			lpmldata::TabularDataColumnType type = aBatch.columnData( columnIndex ).type();
+			double number = 0.0;
+			qint64 integer = 0;
+			bool isMismatch = mIsDeclared.at( columnIndex ) &&
+				( ( type == lpmldata::TabularDataColumnType::Float && !lpmldata::parseDouble( text, size, number ) ) ||
+				  ( type == lpmldata::TabularDataColumnType::Integer && !lpmldata::parseInteger( text, size, integer ) ) );
+
+			aBatch.setValueAt( rowIndex, columnIndex, isMismatch ? nullptr : text, isMismatch ? 0 : size );
+		}
+
+		++recordCount;
+	}
+
+	if ( recordCount == 0 ) return false;
+
+	// The first batch fixes the types of the columns.
+	if ( mRecordCount == 0 )
+	{
+		for ( int columnIndex = 0; columnIndex < columnCount; ++columnIndex )
+		{
+			QVariantList headerValue = { aBatch.columnName( columnIndex ), lpmldata::TabularDataSchema::typeName( aBatch.columnData( columnIndex ).type() ) };
+			mHeader.insert( QString::number( columnIndex ), headerValue );
+			mIsDeclared[ columnIndex ] = 1;
+		}
+
+		aBatch.setHeader( mHeader );
+	}
+
+	mRecordCount += recordCount;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool TabularDataCsvReader::readRecord()
+{
+	while ( true )
+	{
+		CsvTokenizer tokenizer( mBuffer.constData(), mBuffer.size(), mSeparator );
+		tokenizer.setPosition( mPosition );
+		bool isRead = tokenizer.readRecord( mFields, mLayout.fieldLimit );
+
+		// A record reaching the end of the buffer may go on in the next block.
+		if ( mIsAtEnd || ( isRead && tokenizer.position() < mBuffer.size() ) )
+		{
+			mPosition = tokenizer.position();
+			return isRead;
+		}
+
+		readBlock();
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataCsvReader::readBlock()
+{
+	// Drop the consumed records, the rest of a record is kept in front of the new block.
+	mBuffer.remove( 0, int( mPosition ) );
+	mPosition = 0;
+
+	if ( mInflater )
+	{
+		int size = mBuffer.size();
+		mBuffer.resize( size + int( kBlockSize ) );
+		qint64 blockSize = mInflater->inflate( mBuffer.data() + size, kBlockSize );
+		if ( blockSize < 0 ) qDebug() << "Corrupt gzip data: " << mFile.fileName();
+
+		mBuffer.resize( size + int( std::max( blockSize, qint64( 0 ) ) ) );
+		mIsAtEnd = blockSize < kBlockSize;
+		return;
+	}
+
+	QByteArray block = mFile.read( kBlockSize );
+	mBuffer.append( block );
+	mIsAtEnd = block.isEmpty() || mFile.atEnd();
+}
+
+//-----------------------------------------------------------------------------
+
+}
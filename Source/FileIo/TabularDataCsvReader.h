@@ -0,0 +1,101 @@
+/*!
+* \file This file is part of FileIo module.
+* The TabularDataCsvReader class reads a CSV file in batches of rows, e.g. to process tables which do not fit into memory.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#pragma once
+
+#include <FileIo/Export.h>
+#include <FileIo/CsvLayout.h>
+#include <FileIo/TabularDataFileIo.h>
+#include <DataRepresentation/TabularData.h>
+#include <QFile>
+#include <memory>
+
+namespace lpmlfio
+{
+
+class GzipInflater;
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Streaming CSV reader. The file is read block by block and each batch is a columnar table of the next rows, so the
+* memory used depends on the block and the batch size only. A gzip compressed file is inflated block by block.
+*
+* \details The columns are those of the header, filtered by the projection of the options; fields behind the header are
+* ignored. The types are the declared ones and those inferred from the first batch; afterwards they are fixed, a field of
+* another type is a missing value. A key repeated within a batch overwrites its row, batches are independent of each other.
+* The keys of a batch are interned in its own symbol pool, which is released with the batch, so streaming a file of any
+* number of distinct keys does not accumulate them.
+* Usage:
+* \code
+* TabularDataCsvReader reader( "tiles.csv" );
+* lpmldata::TabularData batch;
+* while ( reader.readBatch( batch ) ) { ... }
+* \endcode
+*/
+class FileIo_API TabularDataCsvReader
+{
+
+public:
+	/*!
+	* \brief Constructor, opens the file and reads its header.
+	* \param [in] aFileName The full path of the CSV file.
+	* \param [in] aOptions The declared types, the projection and the row conditions.
+	* \param [in] aSeparator The field separator.
+	*/
+	TabularDataCsvReader( const QString& aFileName, const TabularDataLoadOptions& aOptions = TabularDataLoadOptions(), char aSeparator = ';' );
+
+	~TabularDataCsvReader();
+
+	/*!
+	* \brief Returns true if the file could be opened.
+	*/
+	bool isOpen() const { return mFile.isOpen(); }
+
+	/*!
+	* \brief Returns with the header of the batches, its types are final after the first batch.
+	*/
+	const lpmldata::TabularDataHeader& header() const { return mHeader; }
+
+	/*!
+	* \brief Returns with the number of records read so far, those failing the conditions not counted.
+	*/
+	qint64 recordCount() const { return mRecordCount; }
+
+	/*!
+	* \brief Reads the next batch of rows.
+	* \param [out] aBatch The table of the rows, replaced by each call.
+	* \param [in] aRowCount The number of records per batch, the last batch may have less.
+	* \return False if there are no more rows.
+	*/
+	bool readBatch( lpmldata::TabularData& aBatch, int aRowCount = 65536 );
+
+private:
+	bool readRecord();
+	void readBlock();
+
+private:
+	QFile                            mFile;          //!< The CSV file.
+	std::unique_ptr< GzipInflater >  mInflater;      //!< Inflates the mapped file if it is gzip compressed.
+	QByteArray                       mBuffer;        //!< The bytes read but not consumed yet, whole blocks.
+	qint64                           mPosition;      //!< The offset of the next record in the buffer.
+	bool                             mIsAtEnd;       //!< True if the buffer holds the end of the file.
+	char                             mSeparator;     //!< The field separator.
+	QVector< CsvField >              mFields;        //!< The fields of the current record.
+	lpmlfio::CsvLayout               mLayout;        //!< The fields of the records which are loaded.
+	lpmldata::TabularDataHeader      mHeader;        //!< The header of the batches.
+	QVector< char >                  mIsDeclared;    //!< True for the columns whose type is fixed.
+	qint64                           mRecordCount;   //!< The number of records read so far.
+
+};
+
+//-----------------------------------------------------------------------------
+
+}
@@ -5,21 +5,815 @@
 */
 
 #include <FileIo/TabularDataFileIo.h>
+#include <FileIo/TabularDataBinaryFileIo.h>
+#include <FileIo/CsvTokenizer.h>
+#include <FileIo/CsvLayout.h>
+#include <FileIo/GzipStream.h>
+#include <DataRepresentation/NumberFormatter.h>
+#include <DataRepresentation/NumberParser.h>
+#include <QDir>
 #include <QFile>
-#include <QTextStream>
+#include <QFileInfo>
 #include <QJsonObject>
 #include <QJsonDocument>
 #include <QDebug>
+#include <QMutex>
+#include <QTemporaryFile>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrentRun>
+#include <QWaitCondition>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <vector>
+#if defined( _OPENMP )
+#include <omp.h>
+#endif
 
 namespace lpmlfio
 {
 
 //-----------------------------------------------------------------------------
 
+namespace
+{
+
+#if defined( Q_OS_WIN )
+const char kLineEnd[] = "\r\n";
+#else
+const char kLineEnd[] = "\n";
+#endif
+
+const int kDefaultConcurrentLoads = 4;   //!< The files loadMany reads at a time by default, the cores are shared among them.
+const int kRowsPerBlock = 4096;   //!< The rows formatted by a thread at a time when saving.
+
+/*!
+* \brief Appends a field, quoted if it contains a separator, a quote or a line break, so that it loads back as it was.
+*/
+void appendField( QByteArray& aBuffer, const char* aText, int aSize, char aSeparator )
+{
+	bool isQuoted = false;
+	for ( int index = 0; index < aSize && !isQuoted; ++index )
+	{
+		char character = aText[ index ];
+		isQuoted = character == aSeparator || character == '"' || character == '\n' || character == '\r';
+	}
+
+	if ( !isQuoted )
+	{
+		aBuffer.append( aText, aSize );
+		return;
+	}
+
+	aBuffer.append( '"' );
+	for ( int index = 0; index < aSize; ++index )
+	{
+		if ( aText[ index ] == '"' ) aBuffer.append( '"' );
+		aBuffer.append( aText[ index ] );
+	}
+	aBuffer.append( '"' );
+}
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Formats the rows of a range of the row order into CSV records, missing values as NA.
+*/
+void formatCsvRows( const lpmldata::TabularData& aTabularData, const QList< QString >& aKeys, const QVector< int >& aRowOrder, int aBegin, int aEnd, char aSeparator, QByteArray& aBuffer )
+{
+	char number[ lpmldata::kNumberTextCapacity ];
+
+	for ( int orderIndex = aBegin; orderIndex < aEnd; ++orderIndex )
+	{
+		int rowIndex = aRowOrder.at( orderIndex );
+		QByteArray key = aKeys.at( rowIndex ).toUtf8();
+		appendField( aBuffer, key.constData(), key.size(), aSeparator );
+
+		for ( int columnIndex = 0; columnIndex < aTabularData.columnCount(); ++columnIndex )
+		{
+			const lpmldata::TabularDataColumn& column = aTabularData.columnData( columnIndex );
+			aBuffer.append( aSeparator );
+
+			if ( !column.isValid( rowIndex ) )
+			{
+				aBuffer.append( "NA", 2 );
+				continue;
+			}
+
+			switch ( column.type() )
+			{
+			case lpmldata::TabularDataColumnType::Float:
+				aBuffer.append( number, lpmldata::formatDouble( column.floats()[ rowIndex ], number ) );
+				break;
+			case lpmldata::TabularDataColumnType::Integer:
+				aBuffer.append( number, lpmldata::formatInteger( column.integers()[ rowIndex ], number ) );
+				break;
+			case lpmldata::TabularDataColumnType::String:
+			{
+				int size = 0;
+				const char* text = column.textAt( rowIndex, size );
+				appendField( aBuffer, text, size, aSeparator );
+				break;
+			}
+			}
+		}
+
+		aBuffer.append( kLineEnd, int( sizeof( kLineEnd ) ) - 1 );
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Records of a CSV body read by one thread. The chunk starts and ends on record boundaries.
+*/
+struct CsvChunk
+{
+	qint64                      begin;           //!< The offset of the first record.
+	qint64                      end;             //!< The offset behind the last record.
+	bool                        isInQuotes;      //!< True if the nominal start of the chunk is inside a quoted field.
+	int                         fieldCount;      //!< The number of fields of the longest record.
+	QVector< QString >          keys;            //!< The key of each record, empty lines and records failing the conditions skipped.
+	QVector< qint64 >           recordOffsets;   //!< The offset of each record.
+	QVector< int >              rowIndices;      //!< The row of each record, -1 for a key seen before.
+	QVector< quint64 >          textSizes;       //!< The number of bytes of each field but the key.
+	QVector< quint32 >          textOffsets;     //!< The offset of the text of the chunk in each String column.
+	QVector< char >             isText;          //!< True for the columns in which the chunk has a field which is not a number.
+};
+
+const qint64 kMinimumChunkSize = qint64( 1 ) << 20;
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Splits the records from aBegin into chunks, about four per thread.
+* \details Whether a nominal boundary is inside a quoted field follows from the parity of the quotes before it, counted in
+* parallel; the boundary then moves behind the first newline which is not inside quotes.
+*/
+QVector< CsvChunk > splitCsv( const char* aData, qint64 aSize, qint64 aBegin )
+{
+	qint64 chunkCount = std::min( qint64( QThread::idealThreadCount() ) * 4, ( aSize - aBegin ) / kMinimumChunkSize );
+	chunkCount = std::max( chunkCount, qint64( 1 ) );
+
+	QVector< CsvChunk > chunks( static_cast< int >( chunkCount ) );
+	QVector< qint64 > quoteCounts( static_cast< int >( chunkCount ), 0 );
+
+	#pragma omp parallel for schedule( dynamic, 1 )
+	for ( int chunkIndex = 0; chunkIndex < int( chunkCount ); ++chunkIndex )
+	{
+		const char* begin = aData + aBegin + ( aSize - aBegin ) * chunkIndex / chunkCount;
+		const char* end   = aData + aBegin + ( aSize - aBegin ) * ( chunkIndex + 1 ) / chunkCount;
+		quoteCounts[ chunkIndex ] = qint64( std::count( begin, end, '"' ) );
+	}
+
+	qint64 quoteCount = 0;
+	for ( int chunkIndex = 0; chunkIndex < int( chunkCount ); ++chunkIndex )
+	{
+		chunks[ chunkIndex ].isInQuotes = ( quoteCount & 1 ) != 0;
+		quoteCount += quoteCounts.at( chunkIndex );
+	}
+
+	#pragma omp parallel for schedule( dynamic, 1 )
+	for ( int chunkIndex = 0; chunkIndex < int( chunkCount ); ++chunkIndex )
+	{
+		CsvChunk& chunk = chunks[ chunkIndex ];
+		if ( chunkIndex == 0 )
+		{
+			chunk.begin = aBegin;
+			continue;
+		}
+
+		const char* end = aData + aSize;
+		const char* position = aData + aBegin + ( aSize - aBegin ) * chunkIndex / chunkCount;
+		bool isInQuotes = chunk.isInQuotes;
+
+		while ( position < end )
+		{
+			position = CsvTokenizer::findFirstOf( position, end, '"', '\n' );
+			if ( position == end ) break;
+
+			bool isRecordEnd = *position == '\n' && !isInQuotes;
+			isInQuotes = *position == '"' ? !isInQuotes : isInQuotes;
+			++position;
+
+			if ( isRecordEnd ) break;
+		}
+
+		chunk.begin = position - aData;
+	}
+
+	for ( int chunkIndex = 0; chunkIndex < int( chunkCount ); ++chunkIndex )
+	{
+		chunks[ chunkIndex ].end = chunkIndex + 1 < int( chunkCount ) ? chunks.at( chunkIndex + 1 ).begin : aSize;
+	}
+
+	return chunks;
+}
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Adds a record to the index of a chunk: its key, offset, width and text sizes.
+*/
+void indexCsvRecord( const QVector< CsvField >& aFields, qint64 aRecordOffset, CsvChunk& aChunk )
+{
+	aChunk.keys.push_back( CsvTokenizer::toString( aFields.first() ) );
+	aChunk.recordOffsets.push_back( aRecordOffset );
+	aChunk.fieldCount = std::max( aChunk.fieldCount, aFields.size() );
+
+	if ( aChunk.textSizes.size() < aFields.size() - 1 )
+	{
+		aChunk.textSizes.resize( aFields.size() - 1 );
+	}
+
+	for ( int fieldIndex = 1; fieldIndex < aFields.size(); ++fieldIndex )
+	{
+		aChunk.textSizes[ fieldIndex - 1 ] += quint64( aFields.at( fieldIndex ).size );
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Reads the records of the chunks in parallel and collects the keys, offsets, widths and text sizes of those meeting
+* the conditions. Only the fields up to the limit of the layout are tokenized.
+* \return False if a chunk does not end where the next one starts, i.e. a stray quote misled the split.
+*/
+bool indexCsvChunks( const char* aData, qint64 aSize, char aSeparator, const CsvLayout& aLayout, QVector< CsvChunk >& aChunks )
+{
+	bool isConsistent = true;
+
+	#pragma omp parallel for schedule( dynamic, 1 )
+	for ( int chunkIndex = 0; chunkIndex < aChunks.size(); ++chunkIndex )
+	{
+		CsvChunk& chunk = aChunks[ chunkIndex ];
+		chunk.fieldCount = 0;
+
+		CsvTokenizer tokenizer( aData + chunk.begin, aSize - chunk.begin, aSeparator );
+		QVector< CsvField > fields;
+
+		while ( tokenizer.position() < chunk.end - chunk.begin )
+		{
+			qint64 recordOffset = chunk.begin + tokenizer.position();
+			tokenizer.readRecord( fields, aLayout.fieldLimit );
+			if ( fields.size() == 1 && fields.first().size == 0 ) continue;  // Empty line.
+			if ( !meetsConditions( fields, aLayout.conditions ) ) continue;
+
+			indexCsvRecord( fields, recordOffset, chunk );
+		}
+
+		// The last record has to end exactly where the next chunk starts.
+		if ( tokenizer.position() != chunk.end - chunk.begin )
+		{
+			#pragma omp critical
+			isConsistent = false;
+		}
+	}
+
+	return isConsistent;
+}
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Fills the rows of the records of a chunk, numbers first, then the text of the columns which turned out to be String.
+* \details The validity bits of a word are collected and set at once; a word at a chunk boundary is shared with the
+* neighbouring chunk, so it is set atomically.
+* \param [in] aIsDeclared True for the columns whose type is given: their fields of another type are missing values.
+* \param [in] aTextColumns Null to fill the numeric columns and mark the inferred ones with text in the chunk, otherwise the
+* String columns to fill.
+*/
+void fillCsvChunk( const char* aData, qint64 aSize, char aSeparator, const CsvLayout& aLayout, CsvChunk& aChunk, const QVector< lpmldata::TabularDataColumn* >& aColumns, const QVector< char >& aIsDeclared, const QVector< char >* aTextColumns )
+{
+	int columnCount = aColumns.size();
+	QVector< int > pendingWords( columnCount, -1 );
+	QVector< quint64 > pendingBits( columnCount, 0 );
+
+	auto setValid = [ & ]( int aColumnIndex, int aRowIndex )
+	{
+		int wordIndex = aRowIndex >> 6;
+		if ( wordIndex != pendingWords.at( aColumnIndex ) )
+		{
+			if ( pendingBits.at( aColumnIndex ) != 0 )
+			{
+				aColumns.at( aColumnIndex )->fillValidity( pendingWords.at( aColumnIndex ), pendingBits.at( aColumnIndex ) );
+			}
+
+			pendingWords[ aColumnIndex ] = wordIndex;
+			pendingBits[ aColumnIndex ]  = 0;
+		}
+
+		pendingBits[ aColumnIndex ] |= quint64( 1 ) << ( aRowIndex & 63 );
+	};
+
+	CsvTokenizer tokenizer( aData, aSize, aSeparator );
+	QVector< CsvField > fields;
+	QByteArray unescaped;
+
+	for ( int recordIndex = 0; recordIndex < aChunk.rowIndices.size(); ++recordIndex )
+	{
+		int rowIndex = aChunk.rowIndices.at( recordIndex );
+		if ( rowIndex < 0 ) continue;
+
+		tokenizer.setPosition( aChunk.recordOffsets.at( recordIndex ) );
+		tokenizer.readRecord( fields, aLayout.fieldLimit );
+
+		for ( int columnIndex = 0; columnIndex < columnCount; ++columnIndex )
+		{
+			int fieldIndex = aLayout.fieldIndices.at( columnIndex );
+			if ( fieldIndex >= fields.size() ) continue;
+
+			lpmldata::TabularDataColumn* column = aColumns.at( columnIndex );
+			bool isTextColumn = aTextColumns != nullptr ? aTextColumns->at( columnIndex ) != 0 : aChunk.isText.at( columnIndex ) != 0 || column->type() == lpmldata::TabularDataColumnType::String;
+			if ( isTextColumn != ( aTextColumns != nullptr ) ) continue;
+
+			const CsvField& field = fields.at( fieldIndex );
+			const char* text = field.data;
+			int size = field.size;
+			if ( field.isEscaped )
+			{
+				unescaped = CsvTokenizer::toUtf8( field );
+				text = unescaped.constData();
+				size = unescaped.size();
+			}
+
+			if ( lpmldata::TabularDataColumn::isMissing( text, size ) ) continue;
+
+			if ( aTextColumns != nullptr )
+			{
+				column->fill( rowIndex, text, quint32( size ), aChunk.textOffsets.at( columnIndex ) );
+				aChunk.textOffsets[ columnIndex ] += quint32( size );
+				setValid( columnIndex, rowIndex );
+				continue;
+			}
+
+			if ( column->type() == lpmldata::TabularDataColumnType::Integer )
+			{
+				qint64 integer = 0;
+				if ( lpmldata::parseInteger( text, size, integer ) )
+				{
+					column->fill( rowIndex, integer );
+					setValid( columnIndex, rowIndex );
+				}
+
+				continue;
+			}
+
+			double number = 0.0;
+			if ( !lpmldata::parseDouble( text, size, number ) )
+			{
+				aChunk.isText[ columnIndex ] = aIsDeclared.at( columnIndex ) ? 0 : 1;
+			}
+			else if ( number == number )
+			{
+				column->fill( rowIndex, number );
+				setValid( columnIndex, rowIndex );
+			}
+		}
+	}
+
+	for ( int columnIndex = 0; columnIndex < columnCount; ++columnIndex )
+	{
+		if ( pendingBits.at( columnIndex ) != 0 )
+		{
+			aColumns.at( columnIndex )->fillValidity( pendingWords.at( columnIndex ), pendingBits.at( columnIndex ) );
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Returns with the column names of a header record, the first field names the key column. A possible empty field at
+* the end is dropped.
+*/
+QStringList csvHeaderNames( QVector< CsvField >& aFields )
+{
+	if ( !aFields.isEmpty() && aFields.last().size == 0 )
+	{
+		aFields.removeLast();
+	}
+
+	QStringList headerNames;
+	for ( int headerIndex = 1; headerIndex < aFields.size(); ++headerIndex )
+	{
+		headerNames.push_back( CsvTokenizer::toString( aFields.at( headerIndex ) ) );
+	}
+
+	return headerNames;
+}
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Creates the columns and the rows of the indexed chunks and fills them, see TabularDataFileIo::parseCsv.
+*/
+void fillCsv( const char* aData, qint64 aSize, char aSeparator, const QStringList& aHeaderNames, const lpmldata::TabularDataSchema& aSchema, CsvLayout& aLayout, QVector< CsvChunk >& aChunks, lpmldata::TabularData& aTabularData )
+{
+	// Without a projection a record longer than the header adds unnamed columns.
+	int fieldCount = 0;
+	for ( const CsvChunk& chunk : aChunks )
+	{
+		fieldCount = std::max( fieldCount, chunk.fieldCount );
+	}
+
+	if ( aLayout.fieldLimit < 0 )
+	{
+		for ( int fieldIndex = aHeaderNames.size() + 1; fieldIndex < fieldCount; ++fieldIndex )
+		{
+			aLayout.fieldIndices.push_back( fieldIndex );
+		}
+	}
+
+	// The columns named by the schema get their declared type, the others start as Float.
+	lpmldata::TabularDataHeader header;
+	int columnCount = aLayout.fieldIndices.size();
+	QVector< char > isDeclared( columnCount, 0 );
+	for ( int columnIndex = 0; columnIndex < columnCount; ++columnIndex )
+	{
+		int headerIndex = aLayout.fieldIndices.at( columnIndex ) - 1;
+		QString name = headerIndex < aHeaderNames.size() ? aHeaderNames.at( headerIndex ) : QString();
+		int schemaIndex = aSchema.indexOf( name );
+		lpmldata::TabularDataColumnType type = schemaIndex < 0 ? lpmldata::TabularDataColumnType::Float : aSchema.type( schemaIndex );
+		isDeclared[ columnIndex ] = schemaIndex < 0 ? 0 : 1;
+
+		QVariantList headerValue = { name, lpmldata::TabularDataSchema::typeName( type ) };
+		header.insert( QString::number( columnIndex ), headerValue );
+	}
+
+	aTabularData.setHeader( header );  // Save the header to the tabular data.
+
+	// Create the rows of all chunks at once. A record of a key seen before is applied at the end, in file order.
+	QVector< char > isRowTaken;
+	for ( CsvChunk& chunk : aChunks )
+	{
+		chunk.rowIndices = aTabularData.insertRows( chunk.keys );
+		isRowTaken.resize( int( aTabularData.rowCount() ) );
+		for ( int& rowIndex : chunk.rowIndices )
+		{
+			if ( isRowTaken.at( rowIndex ) ) rowIndex = -1;
+			else isRowTaken[ rowIndex ] = 1;
+		}
+	}
+
+	QVector< lpmldata::TabularDataColumn* > columns( columnCount );
+	for ( int columnIndex = 0; columnIndex < columnCount; ++columnIndex )
+	{
+		columns[ columnIndex ] = &aTabularData.mutableColumnData( columnIndex );
+	}
+
+	for ( CsvChunk& chunk : aChunks )
+	{
+		chunk.isText.fill( 0, columnCount );
+		chunk.textSizes.resize( std::max( { chunk.textSizes.size(), aHeaderNames.size(), fieldCount - 1 } ) );
+		chunk.textOffsets.resize( columnCount );
+	}
+
+	// Fill the numbers, each chunk its own rows. A column with a field which is not a number is filled with text afterwards.
+	#pragma omp parallel for schedule( dynamic, 1 )
+	for ( int chunkIndex = 0; chunkIndex < aChunks.size(); ++chunkIndex )
+	{
+		fillCsvChunk( aData, aSize, aSeparator, aLayout, aChunks[ chunkIndex ], columns, isDeclared, nullptr );
+	}
+
+	QVector< char > isText( columnCount, 0 );
+	for ( int columnIndex = 0; columnIndex < columnCount; ++columnIndex )
+	{
+		isText[ columnIndex ] = columns.at( columnIndex )->type() == lpmldata::TabularDataColumnType::String ? 1 : 0;
+		quint64 textSize = 0;
+		for ( CsvChunk& chunk : aChunks )
+		{
+			isText[ columnIndex ] |= chunk.isText.at( columnIndex );
+			chunk.textOffsets[ columnIndex ] = quint32( textSize );
+			textSize += chunk.textSizes.at( aLayout.fieldIndices.at( columnIndex ) - 1 );
+		}
+
+		if ( isText.at( columnIndex ) )
+		{
+			columns[ columnIndex ]->reset( lpmldata::TabularDataColumnType::String, quint32( textSize ) );
+		}
+	}
+
+	if ( isText.contains( 1 ) )
+	{
+		#pragma omp parallel for schedule( dynamic, 1 )
+		for ( int chunkIndex = 0; chunkIndex < aChunks.size(); ++chunkIndex )
+		{
+			fillCsvChunk( aData, aSize, aSeparator, aLayout, aChunks[ chunkIndex ], columns, isDeclared, &isText );
+		}
+	}
+
+	// Records of repeated keys overwrite the whole row, like an insert.
+	QVector< CsvField > fields;
+	for ( const CsvChunk& chunk : aChunks )
+	{
+		for ( int recordIndex = 0; recordIndex < chunk.rowIndices.size(); ++recordIndex )
+		{
+			if ( chunk.rowIndices.at( recordIndex ) >= 0 ) continue;
+
+			CsvTokenizer recordTokenizer( aData + chunk.recordOffsets.at( recordIndex ), aSize - chunk.recordOffsets.at( recordIndex ), aSeparator );
+			recordTokenizer.readRecord( fields, aLayout.fieldLimit );
+
+			int rowIndex = aTabularData.rowIndex( chunk.keys.at( recordIndex ) );
+			for ( int columnIndex = 0; columnIndex < columnCount; ++columnIndex )
+			{
+				int fieldIndex = aLayout.fieldIndices.at( columnIndex );
+				if ( fieldIndex >= fields.size() )
+				{
+					aTabularData.setValueAt( rowIndex, columnIndex, nullptr, 0 );
+					continue;
+				}
+
+				QByteArray text = CsvTokenizer::toUtf8( fields.at( fieldIndex ) );
+
+				// A declared type is kept, a field of another type is a missing value.
+				lpmldata::TabularDataColumnType type = columns.at( columnIndex )->type();
+				double number = 0.0;
+				qint64 integer = 0;
+				bool isMismatch = isDeclared.at( columnIndex ) &&
+					( ( type == lpmldata::TabularDataColumnType::Float && !lpmldata::parseDouble( text.constData(), text.size(), number ) ) ||
+					  ( type == lpmldata::TabularDataColumnType::Integer && !lpmldata::parseInteger( text.constData(), text.size(), integer ) ) );
+
+				aTabularData.setValueAt( rowIndex, columnIndex, isMismatch ? nullptr : text.constData(), isMismatch ? 0 : text.size() );
+			}
+		}
+	}
+
+	// The header follows the inferred types.
+	for ( int columnIndex = 0; columnIndex < columnCount; ++columnIndex )
+	{
+		QVariantList headerValue = { aTabularData.columnName( columnIndex ), lpmldata::TabularDataSchema::typeName( columns.at( columnIndex )->type() ) };
+		header.insert( QString::number( columnIndex ), headerValue );
+	}
+
+	aTabularData.setHeader( header );
+}
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief A buffer which one thread inflates a gzip file into while another one reads the records inflated so far.
+*/
+struct CsvInflation
+{
+	char*                 data;         //!< The buffer, of the size stated by the gzip trailer.
+	qint64                capacity;     //!< The size of the buffer.
+	qint64                size;         //!< The number of bytes inflated so far.
+	bool                  isFinished;   //!< True if the inflation ended, successfully or not.
+	std::atomic< bool >   isFailed;     //!< True if the data is corrupt or larger than the buffer, read without the mutex.
+	QMutex                mutex;        //!< Guards the size and the finished flag.
+	QWaitCondition        condition;    //!< Signals the progress.
+};
+
+const qint64 kInflationBlockSize = qint64( 1 ) << 20;
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Inflates gzip data into the buffer of the inflation a block at a time, announcing each block.
+*/
+void inflateCsv( const char* aData, qint64 aSize, CsvInflation& aInflation )
+{
+	GzipInflater inflater( aData, aSize );
+	qint64 size = 0;
+	bool isFailed = false;
+
+	while ( true )
+	{
+		// A full buffer has to be the end of the data.
+		qint64 room = std::min( kInflationBlockSize, aInflation.capacity - size );
+		char overflow = 0;
+		qint64 blockSize = room > 0 ? inflater.inflate( aInflation.data + size, room ) : inflater.inflate( &overflow, 1 );
+
+		isFailed = blockSize < 0 || ( room == 0 && blockSize > 0 );
+		if ( isFailed || blockSize == 0 ) break;
+
+		size += blockSize;
+		QMutexLocker locker( &aInflation.mutex );
+		aInflation.size = size;
+		aInflation.condition.wakeAll();
+	}
+
+	QMutexLocker locker( &aInflation.mutex );
+	aInflation.isFinished = true;
+	aInflation.isFailed = isFailed;
+	aInflation.condition.wakeAll();
+}
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Waits until more than aSize bytes are inflated or the inflation is finished.
+* \return The number of bytes inflated.
+*/
+qint64 waitForCsv( CsvInflation& aInflation, qint64 aSize, bool& aIsFinished )
+{
+	QMutexLocker locker( &aInflation.mutex );
+	while ( aInflation.size <= aSize && !aInflation.isFinished )
+	{
+		aInflation.condition.wait( &aInflation.mutex );
+	}
+
+	aIsFinished = aInflation.isFinished;
+	return aInflation.size;
+}
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Reads the records of the buffer as they are inflated and indexes them in chunks of about aChunkSize bytes, the
+* way splitCsv and indexCsvChunks do for a complete buffer.
+* \return False if the inflation failed.
+*/
+bool indexCsvStream( CsvInflation& aInflation, char aSeparator, const TabularDataLoadOptions& aOptions, qint64 aChunkSize, QStringList& aHeaderNames, CsvLayout& aLayout, QVector< CsvChunk >& aChunks )
+{
+	QVector< CsvField > fields;
+	bool isFinished = false;
+	qint64 available = 0;
+	while ( available < 3 && !isFinished )
+	{
+		available = waitForCsv( aInflation, available, isFinished );
+	}
+
+	// Skip the UTF-8 byte order mark.
+	qint64 position = available >= 3 && std::memcmp( aInflation.data, "\xEF\xBB\xBF", 3 ) == 0 ? 3 : 0;
+	bool isHeader = true;
+
+	CsvChunk chunk;
+	chunk.isInQuotes = false;
+	chunk.fieldCount = 0;
+
+	while ( true )
+	{
+		CsvTokenizer tokenizer( aInflation.data, available, aSeparator );
+		tokenizer.setPosition( position );
+		bool isRead = tokenizer.readRecord( fields, isHeader ? -1 : aLayout.fieldLimit );
+
+		// A record reaching the end of the inflated bytes may go on in the next block.
+		if ( !isFinished && ( !isRead || tokenizer.position() >= available ) )
+		{
+			available = waitForCsv( aInflation, available, isFinished );
+			continue;
+		}
+
+		if ( aInflation.isFailed ) return false;
+		if ( !isRead ) break;
+
+		qint64 recordOffset = position;
+		position = tokenizer.position();
+
+		if ( isHeader )
+		{
+			aHeaderNames = csvHeaderNames( fields );
+			aLayout = layoutCsv( aHeaderNames, aOptions );
+			isHeader = false;
+			chunk.begin = position;
+			continue;
+		}
+
+		if ( !( fields.size() == 1 && fields.first().size == 0 ) && meetsConditions( fields, aLayout.conditions ) )
+		{
+			indexCsvRecord( fields, recordOffset, chunk );
+		}
+
+		if ( position - chunk.begin >= aChunkSize )
+		{
+			chunk.end = position;
+			aChunks.push_back( chunk );
+
+			chunk = CsvChunk();
+			chunk.begin = position;
+			chunk.isInQuotes = false;
+			chunk.fieldCount = 0;
+		}
+	}
+
+	if ( isHeader )
+	{
+		aLayout = layoutCsv( aHeaderNames, aOptions );
+		chunk.begin = available;
+	}
+
+	chunk.end = available;
+	aChunks.push_back( chunk );
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Returns with the path of the cache entry of a CSV file loaded with the given options. The name is the hash of the
+* path and the options, which the entries of every version of the file share, followed by the hash of the size, the
+* modification time and the content.
+*/
+QString cacheEntryPath( const QString& aCacheDirectory, const QString& aFullPath, const char* aData, qint64 aSize, char aSeparator, const TabularDataLoadOptions& aOptions )
+{
+	QFileInfo fileInfo( aFullPath );
+	QStringList source = { fileInfo.absoluteFilePath(), QString( QChar( aSeparator ) ) };
+	for ( int schemaIndex = 0; schemaIndex < aOptions.schema.size(); ++schemaIndex )
+	{
+		source.push_back( aOptions.schema.name( schemaIndex ) + ":" + lpmldata::TabularDataSchema::typeName( aOptions.schema.type( schemaIndex ) ) );
+	}
+
+	source += aOptions.columns;
+	for ( const TabularDataRowCondition& condition : aOptions.conditions )
+	{
+		source.push_back( condition.columnName + " " + QString::number( int( condition.comparison ) ) + " " + condition.value.toString() );
+	}
+
+	QByteArray sourceBytes = source.join( '\n' ).toUtf8();
+	quint64 state[ 3 ] = { quint64( aSize ), quint64( fileInfo.lastModified().toMSecsSinceEpoch() ), TabularDataBinaryFileIo::checksum( aData, aSize ) };
+
+	QString sourceHash = QString::number( TabularDataBinaryFileIo::checksum( sourceBytes.constData(), sourceBytes.size() ), 16 );
+	QString stateHash = QString::number( TabularDataBinaryFileIo::checksum( reinterpret_cast< const char* >( state ), sizeof( state ) ), 16 );
+	return aCacheDirectory + "/" + sourceHash + "-" + stateHash + ".tdb";
+}
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Stores a parsed table as a cache entry and removes the entries of the earlier versions of its file. The entry is
+* written to a uniquely named temporary file in the cache directory first and then renamed, so that a partly written entry
+* is never loaded and concurrent loads of the same file never write to the same file. If another load stored the entry
+* meanwhile, that one is kept.
+*/
+void storeCacheEntry( const QString& aEntryPath, const lpmldata::TabularData& aTabularData )
+{
+	QFileInfo entryInfo( aEntryPath );
+	QDir cacheDirectory( entryInfo.path() );
+	if ( !cacheDirectory.exists() && !cacheDirectory.mkpath( entryInfo.path() ) )
+	{
+		qDebug() << "Cannot create the cache directory: " << entryInfo.path();
+		return;
+	}
+
+	QString sourceHash = entryInfo.fileName().left( entryInfo.fileName().indexOf( '-' ) );
+	for ( const QString& entryName : cacheDirectory.entryList( QStringList( sourceHash + "-*.tdb" ), QDir::Files ) )
+	{
+		if ( entryName != entryInfo.fileName() ) cacheDirectory.remove( entryName );
+	}
+
+	// The temporary file keeps its name reserved until it goes out of scope, which removes it unless it was renamed.
+	QTemporaryFile temporaryFile( aEntryPath + ".XXXXXX" );
+	if ( !temporaryFile.open() )
+	{
+		qDebug() << "Cannot create a cache entry in: " << entryInfo.path();
+		return;
+	}
+
+	QString temporaryPath = temporaryFile.fileName();
+	temporaryFile.close();
+
+	TabularDataBinaryFileIo binaryFileIo;
+	if ( binaryFileIo.save( temporaryPath, aTabularData ) && QFile::rename( temporaryPath, aEntryPath ) )
+	{
+		temporaryFile.setAutoRemove( false );
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Adds a loaded table to the table given to load(): its rows are appended and a key already in the table gets the row of
+* the loaded one, with the columns matched by name. An empty table is replaced, the name of the table is kept unless it is
+* empty, e.g. for the name stored in a binary file.
+*/
+void addLoadedRows( lpmldata::TabularData& aTabularData, lpmldata::TabularData&& aLoadedTabularData )
+{
+	// Nothing was read, e.g. from an empty file.
+	if ( aLoadedTabularData.columnCount() == 0 && aLoadedTabularData.rowCount() == 0 ) return;
+
+	QString name = aTabularData.name().isEmpty() ? aLoadedTabularData.name() : aTabularData.name();
+
+	if ( aTabularData.rowCount() == 0 )
+	{
+		aTabularData = std::move( aLoadedTabularData );
+	}
+	else
+	{
+		QList< lpmldata::TabularData > tabularDatas;
+		tabularDatas.push_back( std::move( aTabularData ) );
+		tabularDatas.push_back( std::move( aLoadedTabularData ) );
+		aTabularData = lpmldata::TabularData::mergeFeatures( std::move( tabularDatas ), lpmldata::TabularDataMerge::Rows );
+	}
+
+	aTabularData.name() = name;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+
 TabularDataFileIo::TabularDataFileIo()
 :
 	mWorkingDirectory( "" ),
-	mCommaSeparator( ';' )
+	mCommaSeparator( ';' ),
+	mCacheDirectory(),
+	mMaxConcurrentLoads( kDefaultConcurrentLoads ),
+	mIsArenaAllocated( false )
 {
 }
 
@@ -28,7 +822,10 @@ TabularDataFileIo::TabularDataFileIo()
 TabularDataFileIo::TabularDataFileIo( QString aWorkingDirectory )
 	:
 	mWorkingDirectory( aWorkingDirectory ),
-	mCommaSeparator( ';' )
+	mCommaSeparator( ';' ),
+	mCacheDirectory(),
+	mMaxConcurrentLoads( kDefaultConcurrentLoads ),
+	mIsArenaAllocated( false )
 {
 }
 
@@ -42,6 +839,24 @@ TabularDataFileIo::~TabularDataFileIo()
 
 void TabularDataFileIo::load( QString aHeaderFileName, lpmldata::TabularData& aTabularData )
 {
+	load( aHeaderFileName, aTabularData, lpmldata::TabularDataSchema() );
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataFileIo::load( QString aHeaderFileName, lpmldata::TabularData& aTabularData, const lpmldata::TabularDataSchema& aSchema )
+{
+	TabularDataLoadOptions options;
+	options.schema = aSchema;
+	load( aHeaderFileName, aTabularData, options );
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataFileIo::load( QString aHeaderFileName, lpmldata::TabularData& aTabularData, const TabularDataLoadOptions& aOptions )
+{
+	// The file is loaded into a new table, a cache hit as well as a parse, which is then added to the given one.
+	lpmldata::TabularData tabularData;
 
 	QString fullPath;
 	if ( mWorkingDirectory.count() == 0 )
@@ -52,6 +867,17 @@ void TabularDataFileIo::load( QString aHeaderFileName, lpmldata::TabularData& aT
 	{
 		fullPath = mWorkingDirectory + "/" + aHeaderFileName;
 	}
+
+	// Load the binary columnar format.
+	if ( fullPath.endsWith( ".tdb" ) )
+	{
+		TabularDataBinaryFileIo binaryFileIo;
+		if ( binaryFileIo.load( fullPath, tabularData ) )
+		{
+			addLoadedRows( aTabularData, std::move( tabularData ) );
+		}
+		return;
+	}
 	
 	//Load CSV
 	if ( !fullPath.contains( ".csv" ) )
@@ -59,63 +885,215 @@ void TabularDataFileIo::load( QString aHeaderFileName, lpmldata::TabularData& aT
 		fullPath = fullPath + ".csv";
 	}
 	QFile fileInCsv( fullPath );
-	if ( fileInCsv.open( QIODevice::ReadOnly | QIODevice::Text) )
+	if ( fileInCsv.open( QIODevice::ReadOnly ) )
 	{
+		// The file is mapped and tokenized in place; reading it is the fallback if it cannot be mapped.
+		qint64 fileSize = fileInCsv.size();
+		const uchar* mappedData = fileSize > 0 ? fileInCsv.map( 0, fileSize ) : nullptr;
+		QByteArray content;
+		if ( mappedData == nullptr )
+		{
+			content = fileInCsv.readAll();
+		}
 
-		QTextStream in( &fileInCsv );
+		const char* data = mappedData != nullptr ? reinterpret_cast< const char* >( mappedData ) : content.constData();
+		qint64 size = mappedData != nullptr ? fileSize : qint64( content.size() );
 
-		//qDebug() << "Loading: " << fullPath + ".csv" << "...";
+		// The table parsed before from the same bytes with the same options is mapped from the cache.
+		QString cachePath = mCacheDirectory.isEmpty() ? QString() : cacheEntryPath( mCacheDirectory, fullPath, data, size, mCommaSeparator, aOptions );
+		TabularDataBinaryFileIo binaryFileIo;
+		bool isCached = !cachePath.isEmpty() && QFile::exists( cachePath ) && binaryFileIo.load( cachePath, tabularData );
 
-		QString key;
-		QVariantList row;
+		if ( !isCached )
+		{
+			// A gzip file is recognized by its magic bytes, whatever its name.
+			if ( GzipInflater::isGzip( data, size ) )
+			{
+				parseGzipCsv( data, size, tabularData, aOptions );
+			}
+			else
+			{
+				parseCsv( data, size, tabularData, aOptions );
+			}
 
-		// Read the header
-		QString line = in.readLine();  //Read the header data which is the first line.
-		QList< QString > separatedLine = line.split( mCommaSeparator );  //Separate column values.
+			if ( !cachePath.isEmpty() )
+			{
+				storeCacheEntry( cachePath, tabularData );
+			}
+		}
 
-		if ( QString( separatedLine.at( separatedLine.size() - 1 ) ).compare("") == 0 )
+		if ( mappedData != nullptr )
 		{
-			separatedLine.removeLast();
+			fileInCsv.unmap( const_cast< uchar* >( mappedData ) );
 		}
-		
-		// Remove possible empty strings from end.
+		fileInCsv.close();
+
+		// A cache entry carries the name of the table it was stored from, which is not part of the file.
+		tabularData.name() = QString();
+		addLoadedRows( aTabularData, std::move( tabularData ) );
+	}
+	else qDebug() << "Failed to open: " << fullPath << endl;
+}
+
+//-----------------------------------------------------------------------------
+
+QFuture< lpmldata::TabularData > TabularDataFileIo::loadAsync( const QString& aFileName, const TabularDataLoadOptions& aOptions, QThreadPool* aThreadPool ) const
+{
+	// The task loads with a copy of the file IO, which does not have to outlive it then.
+	TabularDataFileIo loader( *this );
+	return QtConcurrent::run( aThreadPool != nullptr ? aThreadPool : QThreadPool::globalInstance(), [ loader, aFileName, aOptions ]() mutable
+	{
+		lpmldata::TabularData tabularData;
+		loader.load( aFileName, tabularData, aOptions );
+		return tabularData;
+	} );
+}
+
+//-----------------------------------------------------------------------------
+
+QVector< lpmldata::TabularData > TabularDataFileIo::loadMany( const QStringList& aFileNames, const TabularDataLoadOptions& aOptions ) const
+{
+	// The cores are shared among the concurrent loads, so that their parallel parsing does not oversubscribe them.
+	int concurrentLoads = std::max( std::min( mMaxConcurrentLoads, aFileNames.size() ), 1 );
+	int threadsPerLoad = std::max( QThread::idealThreadCount() / concurrentLoads, 1 );
 
-		lpmldata::TabularDataHeader header;
+	QThreadPool threadPool;
+	threadPool.setMaxThreadCount( concurrentLoads );
 
-		for ( int headerIndex = 1; headerIndex < separatedLine.size(); ++headerIndex )
+	QVector< QFuture< lpmldata::TabularData > > futures;
+	futures.reserve( aFileNames.size() );
+	for ( const QString& fileName : aFileNames )
+	{
+		// The thread count of the parallel regions is set per thread; the threads of the pool end with it.
+		TabularDataFileIo loader( *this );
+		futures.push_back( QtConcurrent::run( &threadPool, [ loader, fileName, aOptions, threadsPerLoad ]() mutable
 		{
-			QString value = separatedLine.at( headerIndex );
-			QString type = "Float";
-			QVariantList headerValue = { value, type };
-			header.insert( QString::number( headerIndex - 1), headerValue );
-		}
+#if defined( _OPENMP )
+			omp_set_num_threads( threadsPerLoad );
+#else
+			Q_UNUSED( threadsPerLoad );
+#endif
+			lpmldata::TabularData tabularData;
+			loader.load( fileName, tabularData, aOptions );
+			return tabularData;
+		} ) );
+	}
+
+	QVector< lpmldata::TabularData > tabularDatas;
+	tabularDatas.reserve( futures.size() );
+	for ( const QFuture< lpmldata::TabularData >& future : futures )
+	{
+		tabularDatas.push_back( future.result() );
+	}
+
+	return tabularDatas;
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataFileIo::parseCsv( const char* aData, qint64 aSize, lpmldata::TabularData& aTabularData, const TabularDataLoadOptions& aOptions ) const
+{
+	// Skip the UTF-8 byte order mark.
+	if ( aSize >= 3 && std::memcmp( aData, "\xEF\xBB\xBF", 3 ) == 0 )
+	{
+		aData += 3;
+		aSize -= 3;
+	}
 
-		aTabularData.header() = header;  // Save the header to the tabular data.
+	CsvTokenizer tokenizer( aData, aSize, mCommaSeparator );
+	QVector< CsvField > fields;
 
-		// Read up the file.
-		while ( !in.atEnd() )
+	tokenizer.readRecord( fields );
+	QStringList headerNames = csvHeaderNames( fields );
+	CsvLayout layout = layoutCsv( headerNames, aOptions );
+
+	// Split the records into chunks and index them: keys, offsets, widths and text sizes.
+	QVector< CsvChunk > chunks = splitCsv( aData, aSize, tokenizer.position() );
+	if ( !indexCsvChunks( aData, aSize, mCommaSeparator, layout, chunks ) )
+	{
+		// A quote inside an unquoted field misled the split, read the records in one go.
+		chunks = { CsvChunk() };
+		chunks.first().begin = tokenizer.position();
+		chunks.first().end   = aSize;
+		indexCsvChunks( aData, aSize, mCommaSeparator, layout, chunks );
+	}
+
+	// If enabled, the columns are allocated once, in an arena of the size of the file; columns added later come from the heap.
+	if ( mIsArenaAllocated ) aTabularData.setArena( std::make_shared< lpmldata::Arena >( std::max( size_t( aSize ), size_t( 64 ) << 10 ) ) );
+	fillCsv( aData, aSize, mCommaSeparator, headerNames, aOptions.schema, layout, chunks, aTabularData );
+	aTabularData.setArena( nullptr );
+}
+
+//-----------------------------------------------------------------------------
+
+void TabularDataFileIo::parseGzipCsv( const char* aData, qint64 aSize, lpmldata::TabularData& aTabularData, const TabularDataLoadOptions& aOptions ) const
+{
+	// The trailer gives the size of a file of one member below 4 GB: the buffer is allocated once and its records are
+	// indexed while the rest is inflated.
+	CsvInflation inflation;
+	inflation.capacity   = GzipInflater::sizeHint( aData, aSize );
+	inflation.size       = 0;
+	inflation.isFinished = false;
+	inflation.isFailed   = false;
+
+	std::unique_ptr< char[] > buffer( new char[ size_t( std::max( inflation.capacity, qint64( 1 ) ) ) ] );
+	inflation.data = buffer.get();
+
+	QStringList headerNames;
+	CsvLayout layout;
+	QVector< CsvChunk > chunks;
+	qint64 chunkSize = std::max( kMinimumChunkSize, inflation.capacity / ( qint64( QThread::idealThreadCount() ) * 4 ) );
+	bool isIndexed = false;
+
+	#pragma omp parallel sections num_threads( 2 )
+	{
+		#pragma omp section
 		{
-			
-			QString line = in.readLine();  // Read one line, remove whitespaces.
-			QList< QString > separatedLine = line.split( mCommaSeparator );  // Separate column values.
-			key = separatedLine.at( 0 );  // Read out the key.
+			inflateCsv( aData, aSize, inflation );
+		}
 
-			// Fill up the row with values of the given key.
-			row.clear();
-			for ( int columnIndex = 1; columnIndex < separatedLine.size(); ++columnIndex )
+		#pragma omp section
+		{
+			isIndexed = indexCsvStream( inflation, mCommaSeparator, aOptions, chunkSize, headerNames, layout, chunks );
+		}
+	}
+
+	if ( !isIndexed )
+	{
+		// Several members or more than 4 GB: inflate the whole file first.
+		buffer.reset();
+
+		GzipInflater inflater( aData, aSize );
+		std::vector< char > content;
+		qint64 size = 0;
+		while ( true )
+		{
+			content.resize( size_t( size + kInflationBlockSize ) );
+			qint64 blockSize = inflater.inflate( content.data() + size, kInflationBlockSize );
+			if ( blockSize < 0 )
 			{
-				row.push_back( separatedLine.at( columnIndex ) );
+				qDebug() << "Corrupt gzip data";
+				return;
 			}
 
-			// Place the key-value pairs into the tabular data.
-			aTabularData.insert( key, row );
+			if ( blockSize == 0 ) break;
+			size += blockSize;
 		}
 
-		fileInCsv.close();
-
-		//qDebug() << "Loading finished." << endl;
+		parseCsv( content.data(), size, aTabularData, aOptions );
+		return;
 	}
-	else qDebug() << "Failed to open: " << fullPath << endl;
+
+	if ( mIsArenaAllocated ) aTabularData.setArena( std::make_shared< lpmldata::Arena >( std::max( size_t( inflation.size ), size_t( 64 ) << 10 ) ) );
+	fillCsv( inflation.data, inflation.size, mCommaSeparator, headerNames, aOptions.schema, layout, chunks, aTabularData );
+	aTabularData.setArena( nullptr );
+}
+
+//-----------------------------------------------------------------------------
+
+QString TabularDataFileIo::defaultCacheDirectory()
+{
+	return QDir::tempPath() + "/TabularDataCache";
 }
 
 //-----------------------------------------------------------------------------
@@ -132,52 +1110,75 @@ void TabularDataFileIo::save( QString aFileName, lpmldata::TabularData& aTabular
 		fullPath = mWorkingDirectory + "/" + aFileName;
 	}
 
+	// Save the binary columnar format.
+	if ( fullPath.endsWith( ".tdb" ) )
+	{
+		TabularDataBinaryFileIo binaryFileIo;
+		binaryFileIo.save( fullPath, aTabularData );
+		return;
+	}
+
 	// Save CSV
 	if ( !fullPath.contains( ".csv" ) )
 	{
 		fullPath = fullPath + ".csv";
 	}
 	QFile fileOutCsv( fullPath );
-	if ( fileOutCsv.open( QFile::WriteOnly | QFile::Text ) )
+	if ( fileOutCsv.open( QFile::WriteOnly ) )
 	{
-		QTextStream stream( &fileOutCsv );
+		// A name ending with .gz writes a gzip file.
+		std::unique_ptr< GzipDeflater > deflater( fullPath.endsWith( ".gz" ) ? new GzipDeflater( fileOutCsv ) : nullptr );
+		auto write = [ & ]( const QByteArray& aBytes )
+		{
+			if ( deflater ) deflater->write( aBytes.constData(), aBytes.size() );
+			else fileOutCsv.write( aBytes );
+		};
 
 		// Save header.
-		QMap< QString, QVariant > header = aTabularData.header();
-
-		stream << "Key";
+		const QStringList& headerNames = aTabularData.headerNames();
 
-		for ( int headerIndex = 0; headerIndex < header.size(); ++headerIndex )
+		QByteArray header( "Key" );
+		for ( int headerIndex = 0; headerIndex < headerNames.size(); ++headerIndex )
 		{
-			QStringList headerColumnDescriptor = header.value( QString::number( headerIndex ) ).toStringList();
-			stream << mCommaSeparator << headerColumnDescriptor.at( 0 );
+			QByteArray name = headerNames.at( headerIndex ).toUtf8();
+			header.append( mCommaSeparator );
+			appendField( header, name.constData(), name.size(), mCommaSeparator );
 		}
 
-		stream << endl;
-		fileOutCsv.flush();
-		
+		header.append( kLineEnd, int( sizeof( kLineEnd ) ) - 1 );
+		write( header );
 
-		// Save the tabular data entries.
+		// Save the tabular data entries, ordered by key.
+		const QList< QString > keys = aTabularData.keys();
+		QVector< int > rowOrder( keys.size() );
+		std::iota( rowOrder.begin(), rowOrder.end(), 0 );
+		std::sort( rowOrder.begin(), rowOrder.end(), [ &keys ]( int aFirst, int aSecond ) { return keys.at( aFirst ) < keys.at( aSecond ); } );
 
-		auto keys = aTabularData.keys();
-		std::sort( keys.begin(), keys.end() );
+		// Blocks of rows are formatted in parallel, a round at a time, and written in order with one write each.
+		int blockCount = ( rowOrder.size() + kRowsPerBlock - 1 ) / kRowsPerBlock;
+		int roundSize = QThread::idealThreadCount() * 4;
+		QVector< QByteArray > blocks( roundSize );
 
-		for ( auto key : keys )
+		for ( int firstBlock = 0; firstBlock < blockCount; firstBlock += roundSize )
 		{
-			stream << key;
-			for ( int columnIndex = 0; columnIndex < aTabularData.columnCount(); ++columnIndex )
+			int roundBlockCount = std::min( roundSize, blockCount - firstBlock );
+
+			#pragma omp parallel for schedule( dynamic, 1 )
+			for ( int blockIndex = 0; blockIndex < roundBlockCount; ++blockIndex )
 			{
-				auto cell = aTabularData.valueAt( key, columnIndex ).toString();
-				if ( cell == "nan" )
-				{
-					cell = "NA";
-				}
-				stream << mCommaSeparator << cell;
+				int begin = ( firstBlock + blockIndex ) * kRowsPerBlock;
+				int end = std::min( begin + kRowsPerBlock, rowOrder.size() );
+				blocks[ blockIndex ].clear();
+				formatCsvRows( aTabularData, keys, rowOrder, begin, end, mCommaSeparator, blocks[ blockIndex ] );
+			}
+
+			for ( int blockIndex = 0; blockIndex < roundBlockCount; ++blockIndex )
+			{
+				write( blocks.at( blockIndex ) );
 			}
-			stream << endl;
-			fileOutCsv.flush();
 		}
 
+		if ( deflater ) deflater->finish();
 		fileOutCsv.close();
 	}
 	else
@@ -11,12 +11,56 @@
 
 #include <FileIo/Export.h>
 #include <DataRepresentation/TabularData.h>
+#include <QFuture>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+class QThreadPool;
 
 namespace lpmlfio
 {
 
 //-----------------------------------------------------------------------------
 
+enum class TabularDataComparison
+{
+	Equal = 0,
+	NotEqual,
+	Less,
+	LessOrEqual,
+	Greater,
+	GreaterOrEqual
+};
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief A condition on a column of the rows to load, e.g. Progression == 1. A missing value fails every condition.
+*/
+struct FileIo_API TabularDataRowCondition
+{
+	QString                 columnName;   //!< The column the condition refers to, it does not have to be loaded.
+	TabularDataComparison   comparison;   //!< How the field is compared with the value.
+	QVariant                value;        //!< A numeric value compares numerically, a text value compares UTF-8 bytes.
+};
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief What to load of a CSV file: declared column types, the columns and the rows.
+* \details Fields of columns which are not loaded are not tokenized beyond the last needed one, rows which fail a condition
+* are not materialized.
+*/
+struct FileIo_API TabularDataLoadOptions
+{
+	lpmldata::TabularDataSchema          schema;       //!< Declared column types by name, the other columns are inferred.
+	QStringList                          columns;      //!< Names or wildcard patterns (* and ?) of the columns to load, in file order; all if empty.
+	QVector< TabularDataRowCondition >   conditions;   //!< The conditions a record has to meet, all of them; of a repeated key the last record meeting them is loaded.
+};
+
+//-----------------------------------------------------------------------------
+
 
 class FileIo_API TabularDataFileIo
 {
@@ -31,12 +75,109 @@ public:
 
 	void load( QString aHeaderFileName, lpmldata::TabularData& aTabularData );
 
+	/*!
+	* \brief Loads a table with declared column types instead of inferred ones.
+	* \details The CSV columns named by the schema get its types, a field which is not of the declared type becomes a missing
+	* value. The other columns are inferred: Float if every field is a number or missing, String otherwise.
+	* \param [in] aHeaderFileName The name of the file.
+	* \param [out] aTabularData The loaded table.
+	* \param [in] aSchema The declared types by column name.
+	*/
+	void load( QString aHeaderFileName, lpmldata::TabularData& aTabularData, const lpmldata::TabularDataSchema& aSchema );
+
+	/*!
+	* \brief Loads the projected columns of the rows meeting the conditions of a CSV file, e.g. load( "radiomics", table,
+	* { {}, { "original_glcm_*" }, { { "Progression", TabularDataComparison::Equal, 1 } } } ). A binary file is loaded whole.
+	* \details The rows of the file, whether parsed or mapped from the cache, are added to the table like insert() does: new keys
+	* are appended, a key already in the table gets the row of the file, and the columns are matched by name. An empty table is
+	* replaced at no cost. The name of the table is kept. The table is left as it was if the file cannot be read.
+	* \param [in] aHeaderFileName The name of the file.
+	* \param [out] aTabularData The loaded table.
+	* \param [in] aOptions The declared types, the projection and the row conditions.
+	*/
+	void load( QString aHeaderFileName, lpmldata::TabularData& aTabularData, const TabularDataLoadOptions& aOptions );
+
+	/*!
+	* \brief Loads a file on a thread pool, e.g. while the GUI thread goes on or other files are loaded.
+	* \details The task loads with a copy of this file IO, so the working directory, the separator and the cache are those at
+	* the time of the call.
+	* \param [in] aFileName The name of the file, as for load().
+	* \param [in] aOptions The declared types, the projection and the row conditions.
+	* \param [in] aThreadPool The pool to run the task on, the global one if nullptr.
+	* \return The future of the loaded table, empty if the file cannot be read.
+	*/
+	QFuture< lpmldata::TabularData > loadAsync( const QString& aFileName, const TabularDataLoadOptions& aOptions = TabularDataLoadOptions(), QThreadPool* aThreadPool = nullptr ) const;
+
+	/*!
+	* \brief Loads files concurrently, at most maxConcurrentLoads() at a time, so that the reads and the parsing of the files
+	* overlap. Each concurrent load parses with its share of the cores. Returns when all of them are loaded.
+	* \param [in] aFileNames The names of the files, as for load().
+	* \param [in] aOptions The declared types, the projection and the row conditions, the same for every file.
+	* \return The loaded tables in the order of the names.
+	*/
+	QVector< lpmldata::TabularData > loadMany( const QStringList& aFileNames, const TabularDataLoadOptions& aOptions = TabularDataLoadOptions() ) const;
+
+	/*!
+	* \brief Sets how many files loadMany() reads at a time, 4 by default. The cores are divided among the concurrent loads, so
+	* more of them hide more of the latency of the storage while each file is parsed on fewer cores; 1 parses every file on all
+	* cores one after the other.
+	*/
+	void setMaxConcurrentLoads( int aMaxConcurrentLoads ) { mMaxConcurrentLoads = aMaxConcurrentLoads; }
+
+	int maxConcurrentLoads() const { return mMaxConcurrentLoads; }
+
+	/*!
+	* \brief Enables the allocation of the parsed CSV columns in one arena per table, off by default.
+	* \details The arena spares the allocations of the columns when a table is loaded to be read only. Its memory is freed
+	* with the last of these columns only, so the text of edited string cells and the growth of the columns stay in it.
+	*/
+	void setArenaAllocated( bool aIsArenaAllocated ) { mIsArenaAllocated = aIsArenaAllocated; }
+
+	bool isArenaAllocated() const { return mIsArenaAllocated; }
+
+	/*!
+	* \brief Saves the table, rows ordered by key. CSV rows are formatted in parallel blocks (UTF-8, numbers with the fewest
+	* digits which load back exactly) and written with a few large writes, gzip compressed if the name ends with .gz.
+	*/
 	void save( QString aHeaderFileName, lpmldata::TabularData& aTabularData );
 
+	/*!
+	* \brief Enables the cache of parsed CSV files in the given directory, an empty path disables it (the default).
+	* \details A parsed table is stored in the binary format under a name made of hashes of the path and the load options and
+	* of the size, the modification time and the content of the file. A later load of the same bytes with the same options
+	* maps that image instead of parsing; a changed file gets a new entry, which replaces those of its earlier versions.
+	*/
+	void setCacheDirectory( const QString& aCacheDirectory ) { mCacheDirectory = aCacheDirectory; }
+
+	const QString& cacheDirectory() const { return mCacheDirectory; }
+
+	/*!
+	* \brief Returns with the cache directory for applications which enable the cache, TabularDataCache in the temporary directory.
+	*/
+	static QString defaultCacheDirectory();
+
 private:
 
+	/*!
+	* \brief Parses CSV text into the table. The first line is the header, the first field of each line is the key.
+	* \details The records are split into chunks which are read on all cores: a first pass collects the keys, so that the rows
+	* are created at once, a second one parses the numbers straight into the columns and a third one fills the text of the
+	* columns which are not numeric. Records of a repeated key are applied last, in file order. The header gets the column types.
+	* Only the fields up to the last projected or conditioned one are tokenized.
+	*/
+	void parseCsv( const char* aData, qint64 aSize, lpmldata::TabularData& aTabularData, const TabularDataLoadOptions& aOptions ) const;
+
+	/*!
+	* \brief Inflates a gzip compressed CSV file on a second thread while the records inflated so far are indexed, then parses
+	* it like parseCsv.
+	*/
+	void parseGzipCsv( const char* aData, qint64 aSize, lpmldata::TabularData& aTabularData, const TabularDataLoadOptions& aOptions ) const;
+
 	QString mWorkingDirectory;  //!< The working directory of the file tabular data file IO.
 	char mCommaSeparator;       //!< Comma separator character for CSV file handling.
+	QString mCacheDirectory;    //!< The directory of the parsed table cache, empty if there is no cache.
+	int mMaxConcurrentLoads;    //!< The number of files loadMany reads at a time.
+	bool mIsArenaAllocated;     //!< True if the parsed CSV columns are allocated in an arena.
 
 };
 
@@ -0,0 +1,311 @@
+/*!
+* \file
+* Member function definitions for BinaryMask class.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#include <TestApplication/BinaryMask.h>
+#include <algorithm>
+#include <cstring>
+#include <emmintrin.h>
+
+//-----------------------------------------------------------------------------
+
+namespace muw
+{
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+/*!
+* \brief Transposes a 64 x 64 bit block in place, bit x of word y becomes bit y of word x: six rounds swap the off-diagonal
+* halves of ever smaller sub-blocks.
+*/
+void transposeBlock( quint64* aBlock )
+{
+	quint64 mask = 0x00000000FFFFFFFFull;
+	for ( int width = 32; width != 0; width >>= 1, mask ^= mask << width )
+	{
+		for ( int index = 0; index < 64; index = ( ( index | width ) + 1 ) & ~width )
+		{
+			quint64 swapped = ( ( aBlock[ index ] >> width ) ^ aBlock[ index | width ] ) & mask;
+			aBlock[ index ] ^= swapped << width;
+			aBlock[ index | width ] ^= swapped;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+quint64 lastWordMask( int aWidth )
+{
+	return ( aWidth & 63 ) == 0 ? ~quint64( 0 ) : ( quint64( 1 ) << ( aWidth & 63 ) ) - 1;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+
+BinaryMask::BinaryMask()
+:
+	mWidth( 0 ),
+	mHeight( 0 ),
+	mWordsPerRow( 0 ),
+	mWords()
+{
+}
+
+//-----------------------------------------------------------------------------
+
+BinaryMask::BinaryMask( int aWidth, int aHeight )
+:
+	mWidth( aWidth ),
+	mHeight( aHeight ),
+	mWordsPerRow( ( aWidth + 63 ) / 64 ),
+	mWords( ( ( aWidth + 63 ) / 64 ) * aHeight, 0 )
+{
+}
+
+//-----------------------------------------------------------------------------
+
+BinaryMask::BinaryMask( const QImage& aImage )
+:
+	BinaryMask( aImage.width(), aImage.height() )
+{
+	QImage plane = MaskMorphology::lightnessPlane( aImage );
+	const __m128i zero = _mm_setzero_si128();
+
+	for ( int y = 0; y < mHeight; ++y )
+	{
+		const uchar* source = plane.constScanLine( y );
+		quint64* target = row( y );
+
+		// The zero bytes of 16 pixels at a time give 16 clear bits.
+		int x = 0;
+		for ( ; x + 16 <= mWidth; x += 16 )
+		{
+			__m128i pixels = _mm_loadu_si128( reinterpret_cast< const __m128i* >( source + x ) );
+			quint64 bits = ~unsigned( _mm_movemask_epi8( _mm_cmpeq_epi8( pixels, zero ) ) ) & 0xFFFF;
+			target[ x >> 6 ] |= bits << ( x & 63 );
+		}
+
+		for ( ; x < mWidth; ++x )
+		{
+			if ( source[ x ] != 0 ) target[ x >> 6 ] |= quint64( 1 ) << ( x & 63 );
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+BinaryMask::~BinaryMask()
+{
+}
+
+//-----------------------------------------------------------------------------
+
+void BinaryMask::setPixel( int aX, int aY, bool aIsSet )
+{
+	quint64 bit = quint64( 1 ) << ( aX & 63 );
+	if ( aIsSet ) row( aY )[ aX >> 6 ] |= bit;
+	else row( aY )[ aX >> 6 ] &= ~bit;
+}
+
+//-----------------------------------------------------------------------------
+
+QImage BinaryMask::toImage() const
+{
+	QImage image( mWidth, mHeight, QImage::Format_Grayscale8 );
+	for ( int y = 0; y < mHeight; ++y )
+	{
+		uchar* target = image.scanLine( y );
+		for ( int x = 0; x < mWidth; ++x )
+		{
+			target[ x ] = pixel( x, y ) ? 255 : 0;
+		}
+	}
+
+	return image;
+}
+
+//-----------------------------------------------------------------------------
+
+BinaryMask BinaryMask::dilated( const StructuringElement& aElement ) const
+{
+	BinaryMask result( mWidth, mHeight );
+
+	for ( const QSize& radius : aElement.radii )
+	{
+		// The rows are filtered as the columns of the transposed mask, so both passes run on whole words.
+		BinaryMask rectangle = *this;
+		if ( radius.width() > 0 )
+		{
+			rectangle = rectangle.transposed();
+			rectangle.dilateColumns( radius.width() );
+			rectangle = rectangle.transposed();
+		}
+
+		rectangle.dilateColumns( radius.height() );
+
+		for ( int wordIndex = 0; wordIndex < result.mWords.size(); ++wordIndex ) result.mWords[ wordIndex ] |= rectangle.mWords.at( wordIndex );
+	}
+
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+
+BinaryMask BinaryMask::eroded( const StructuringElement& aElement ) const
+{
+	// A pixel stays set if no pixel of the element inside the mask is clear: the complement of the dilated complement.
+	BinaryMask complement = *this;
+	complement.invert();
+
+	BinaryMask result = complement.dilated( aElement );
+	result.invert();
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+
+BinaryMask BinaryMask::closed( const StructuringElement& aElement ) const
+{
+	return dilated( aElement ).eroded( aElement );
+}
+
+//-----------------------------------------------------------------------------
+
+bool BinaryMask::isSet( int aStartX, int aStartY, int aEndX, int aEndY ) const
+{
+	if ( aEndX <= aStartX || aEndY <= aStartY ) return true;
+
+	int firstWord = aStartX >> 6;
+	int lastWord  = ( aEndX - 1 ) >> 6;
+	quint64 firstMask = ~quint64( 0 ) << ( aStartX & 63 );
+	quint64 lastMask  = ~quint64( 0 ) >> ( 63 - ( ( aEndX - 1 ) & 63 ) );
+
+	for ( int y = aStartY; y < aEndY; ++y )
+	{
+		const quint64* words = row( y );
+		if ( firstWord == lastWord )
+		{
+			quint64 mask = firstMask & lastMask;
+			if ( ( words[ firstWord ] & mask ) != mask ) return false;
+			continue;
+		}
+
+		if ( ( words[ firstWord ] & firstMask ) != firstMask ) return false;
+		for ( int wordIndex = firstWord + 1; wordIndex < lastWord; ++wordIndex )
+		{
+			if ( words[ wordIndex ] != ~quint64( 0 ) ) return false;
+		}
+		if ( ( words[ lastWord ] & lastMask ) != lastMask ) return false;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+
+BinaryMask BinaryMask::transposed() const
+{
+	BinaryMask result( mHeight, mWidth );
+	quint64 block[ 64 ];
+
+	// Word w of the rows 64 b to 64 b + 63 becomes word b of the rows 64 w to 64 w + 63.
+	for ( int blockY = 0; blockY < mHeight; blockY += 64 )
+	{
+		int rowCount = std::min( 64, mHeight - blockY );
+		for ( int wordIndex = 0; wordIndex < mWordsPerRow; ++wordIndex )
+		{
+			for ( int index = 0; index < 64; ++index ) block[ index ] = index < rowCount ? row( blockY + index )[ wordIndex ] : 0;
+			transposeBlock( block );
+
+			int columnCount = std::min( 64, mWidth - wordIndex * 64 );
+			for ( int index = 0; index < columnCount; ++index ) result.row( wordIndex * 64 + index )[ blockY >> 6 ] = block[ index ];
+		}
+	}
+
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+
+void BinaryMask::dilateColumns( int aRadius )
+{
+	if ( aRadius <= 0 || mWordsPerRow == 0 ) return;
+
+	// Van Herk/Gil-Werman on whole rows: the rows, padded by aRadius clear rows on both sides, are cut into blocks of the
+	// window size. A window is the OR of the suffix of one block and the prefix of the next, three ORs per word whatever
+	// the radius. Padded row p is row p - aRadius.
+	int windowSize   = 2 * aRadius + 1;
+	int paddedHeight = ( mHeight + 2 * aRadius + windowSize - 1 ) / windowSize * windowSize;
+	QVector< quint64 > prefix( paddedHeight * mWordsPerRow );
+	QVector< quint64 > suffix( paddedHeight * mWordsPerRow );
+	QVector< quint64 > clearRow( mWordsPerRow, 0 );
+
+	auto paddedRow = [ this, aRadius, &clearRow ]( int aPaddedY ) -> const quint64*
+	{
+		int y = aPaddedY - aRadius;
+		return y >= 0 && y < mHeight ? row( y ) : clearRow.constData();
+	};
+
+	for ( int blockStart = 0; blockStart < paddedHeight; blockStart += windowSize )
+	{
+		int blockEnd = blockStart + windowSize - 1;
+
+		std::copy( paddedRow( blockStart ), paddedRow( blockStart ) + mWordsPerRow, prefix.data() + blockStart * mWordsPerRow );
+		for ( int paddedY = blockStart + 1; paddedY <= blockEnd; ++paddedY )
+		{
+			const quint64* source   = paddedRow( paddedY );
+			const quint64* previous = prefix.constData() + ( paddedY - 1 ) * mWordsPerRow;
+			quint64* target         = prefix.data() + paddedY * mWordsPerRow;
+			for ( int wordIndex = 0; wordIndex < mWordsPerRow; ++wordIndex ) target[ wordIndex ] = previous[ wordIndex ] | source[ wordIndex ];
+		}
+
+		std::copy( paddedRow( blockEnd ), paddedRow( blockEnd ) + mWordsPerRow, suffix.data() + blockEnd * mWordsPerRow );
+		for ( int paddedY = blockEnd - 1; paddedY >= blockStart; --paddedY )
+		{
+			const quint64* source = paddedRow( paddedY );
+			const quint64* next   = suffix.constData() + ( paddedY + 1 ) * mWordsPerRow;
+			quint64* target       = suffix.data() + paddedY * mWordsPerRow;
+			for ( int wordIndex = 0; wordIndex < mWordsPerRow; ++wordIndex ) target[ wordIndex ] = next[ wordIndex ] | source[ wordIndex ];
+		}
+	}
+
+	// The window of row y is padded rows y to y + windowSize - 1.
+	for ( int y = 0; y < mHeight; ++y )
+	{
+		const quint64* first  = suffix.constData() + y * mWordsPerRow;
+		const quint64* second = prefix.constData() + ( y + windowSize - 1 ) * mWordsPerRow;
+		quint64* target       = row( y );
+		for ( int wordIndex = 0; wordIndex < mWordsPerRow; ++wordIndex ) target[ wordIndex ] = first[ wordIndex ] | second[ wordIndex ];
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void BinaryMask::invert()
+{
+	if ( mWordsPerRow == 0 ) return;
+
+	quint64 lastMask = lastWordMask( mWidth );
+	for ( int y = 0; y < mHeight; ++y )
+	{
+		quint64* words = row( y );
+		for ( int wordIndex = 0; wordIndex < mWordsPerRow; ++wordIndex ) words[ wordIndex ] = ~words[ wordIndex ];
+		words[ mWordsPerRow - 1 ] &= lastMask;
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,113 @@
+/*!
+* The BinaryMask class holds a mask with one bit per pixel, 64 pixels to a word, e.g. the tissue masks of the OCT slices
+* tiled by the ImageMaskTiler class. Morphology and rectangle queries work on whole words with shifts and bitwise operations;
+* the morphology is the van Herk/Gil-Werman running OR, constant per pixel for rectangles and approximated disks.
+*
+* \remarks
+* Pixel x of a row is bit x % 64 of word x / 64 of the row; every row starts on a new word and the bits beyond the width are
+* always clear.
+*
+* \authors
+* lpapp
+*/
+
+#pragma once
+
+#include <TestApplication/MaskMorphology.h>
+#include <QImage>
+#include <QVector>
+
+//-----------------------------------------------------------------------------
+
+namespace muw
+{
+
+class BinaryMask
+{
+
+public:
+
+	BinaryMask();
+
+	/*!
+	* \brief Creates a mask of the given size with every pixel clear.
+	*/
+	BinaryMask( int aWidth, int aHeight );
+
+	/*!
+	* \brief Creates a mask whose pixels are set where the lightness of the image is not 0.
+	*/
+	explicit BinaryMask( const QImage& aImage );
+
+	~BinaryMask();
+
+	int width() const { return mWidth; }
+
+	int height() const { return mHeight; }
+
+	bool pixel( int aX, int aY ) const { return ( row( aY )[ aX >> 6 ] >> ( aX & 63 ) ) & 1; }
+
+	void setPixel( int aX, int aY, bool aIsSet );
+
+	/*!
+	* \brief Returns with a Format_Grayscale8 image, 255 where the mask is set and 0 elsewhere.
+	*/
+	QImage toImage() const;
+
+	/*!
+	* \brief Dilates the mask by the element, a rectangle or an approximated disk; pixels outside the mask are clear.
+	* \details Each rectangle is applied separably with the van Herk/Gil-Werman running OR on whole words, the rows through
+	* a transposition of 64 x 64 bit blocks, so the cost per pixel does not depend on the radius.
+	*/
+	BinaryMask dilated( const StructuringElement& aElement ) const;
+
+	/*!
+	* \brief Erodes the mask by the element, pixels outside the mask are ignored.
+	*/
+	BinaryMask eroded( const StructuringElement& aElement ) const;
+
+	/*!
+	* \brief Closes the mask by the element; closing by StructuringElement::rectangle( n, n ) equals n 3x3 dilations followed
+	* by n 3x3 erosions.
+	*/
+	BinaryMask closed( const StructuringElement& aElement ) const;
+
+	/*!
+	* \brief Returns true if every pixel of the rectangle [aStartX, aEndX) x [aStartY, aEndY) is set, testing each row with
+	* the masks of the words it covers.
+	*/
+	bool isSet( int aStartX, int aStartY, int aEndX, int aEndY ) const;
+
+private:
+
+	quint64* row( int aY ) { return mWords.data() + aY * mWordsPerRow; }
+
+	const quint64* row( int aY ) const { return mWords.constData() + aY * mWordsPerRow; }
+
+	/*!
+	* \brief Inverts the mask, leaving the bits beyond the width clear.
+	*/
+	void invert();
+
+	/*!
+	* \brief Returns with the mask mirrored at its diagonal, a height x width mask.
+	*/
+	BinaryMask transposed() const;
+
+	/*!
+	* \brief Dilates the columns in place by a window of 2 * aRadius + 1 rows, rows outside the mask clear.
+	*/
+	void dilateColumns( int aRadius );
+
+private:
+
+	int                  mWidth;         //!< The number of pixels of a row.
+	int                  mHeight;        //!< The number of rows.
+	int                  mWordsPerRow;   //!< The number of words of a row.
+	QVector< quint64 >   mWords;         //!< The rows of the mask one after the other.
+
+};
+
+}
+
+//-----------------------------------------------------------------------------
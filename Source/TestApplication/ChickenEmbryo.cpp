@@ -18,7 +18,7 @@
 namespace muw
 {
 
-ChickenEmbryo::ChickenEmbryo( QString aProjectFolderPath, QString aVolumeFeatureName )
+ChickenEmbryo::ChickenEmbryo( QString aProjectFolderPath, QString aVolumeFeatureName, QString aCacheDirectory )
 :
 	mProjectFolderPath( aProjectFolderPath ),
 	mVolumeFeatureName( aVolumeFeatureName ),
@@ -33,8 +33,10 @@ ChickenEmbryo::ChickenEmbryo( QString aProjectFolderPath, QString aVolumeFeature
 	qDebug() << "Project folder:" << mProjectFolderPath;
 
 	lpmlfio::TabularDataFileIo loader;
-	loader.load( aProjectFolderPath + "/CM.csv", mCorrelationMatrix );
-	loader.load( aProjectFolderPath + "/CL.csv", mLabelMatrix );
+	loader.setCacheDirectory( aCacheDirectory );
+	QVector< lpmldata::TabularData > inputs = loader.loadMany( { aProjectFolderPath + "/CM.csv", aProjectFolderPath + "/CL.csv" } );
+	mCorrelationMatrix = std::move( inputs[ 0 ] );
+	mLabelMatrix = std::move( inputs[ 1 ] );
 
 	validateInputs();
 }
@@ -84,8 +86,7 @@ void ChickenEmbryo::execute( double aSpearmanRankThreshold )
 
 void ChickenEmbryo::generateVolumeEffectTable()
 {
-	QString labelName = mLabelMatrix.headerNames().at( 0 );
-	QStringList correlationColumnNames = mCorrelationMatrix.headerNames();
+	QString labelName = mLabelMatrix.columnName( 0 );
 
 	if ( mVolumeFeatureName == "" )
 	{
@@ -108,9 +109,8 @@ void ChickenEmbryo::generateVolumeEffectTable()
 			QVariantList row;
 			row.push_back( mLabelMatrix.valueAt( currentFeature, 0 ) );
 
-			auto volumeCorrelationRow = mCorrelationMatrix.value( mVolumeFeatureName );
-			int columnIndex = correlationColumnNames.indexOf( currentFeature );
-			double correlationWithVolume = volumeCorrelationRow.at( columnIndex ).toDouble();
+			int columnIndex = mCorrelationMatrix.columnIndex( currentFeature );
+			double correlationWithVolume = mCorrelationMatrix.valueAt( mVolumeFeatureName, columnIndex ).toDouble();
 
 			row.push_back( correlationWithVolume );
 
@@ -124,35 +124,37 @@ void ChickenEmbryo::generateVolumeEffectTable()
 void ChickenEmbryo::generateRedundantGroups()
 {
 	mRedundantGroups.clear();
-	auto columnFeatureNames = mCorrelationMatrix.headerNames();
-	QStringList processedFeatures;
+	const lpmldata::TabularDataSchema& columnFeatures = mCorrelationMatrix.schema();
+	QVector< char > isProcessed( columnFeatures.namePool().size(), 0 );  // Indexed by the symbols of the column names.
 	int groupIndex = 0;
 
 	for ( int i = 0; i < mFeatureNames.size(); ++i )
 	{
 		auto currentRowFeature = mFeatureNames.at( i );
+		lpmldata::Symbol currentRowSymbol = columnFeatures.namePool().find( currentRowFeature );  // -1 for a feature which is no column.
+		int currentRowIndex = mCorrelationMatrix.rowIndex( currentRowFeature );
 
-		if ( !processedFeatures.contains( currentRowFeature ) )  // We found a new feature which has not been in any redundancy group.
+		if ( currentRowSymbol < 0 || !isProcessed.at( currentRowSymbol ) )  // We found a new feature which has not been in any redundancy group.
 		{
 			QStringList newGroup;
 			newGroup.push_back( currentRowFeature );
 			mRedundantGroups.push_back( newGroup );
-			processedFeatures.push_back( currentRowFeature );
+			if ( currentRowSymbol >= 0 ) isProcessed[ currentRowSymbol ] = 1;
 			groupIndex++;
 		}
 
-		for ( int j = 0; j < columnFeatureNames.size(); ++j )
+		for ( int j = 0; j < columnFeatures.size(); ++j )
 		{
-			auto currentColumnFeature = columnFeatureNames.at( j );
+			lpmldata::Symbol currentColumnSymbol = columnFeatures.symbol( j );
 
 			if ( i == j ) continue;
-			if ( processedFeatures.contains( currentColumnFeature ) ) continue;
+			if ( isProcessed.at( currentColumnSymbol ) ) continue;
 
-			double currentCorrelationValue = mCorrelationMatrix.valueAt( currentRowFeature, j ).toDouble();
+			double currentCorrelationValue = currentRowIndex < 0 ? 0.0 : mCorrelationMatrix.columnData( j ).toDouble( currentRowIndex );
 			if ( std::abs( currentCorrelationValue ) >= mSpearmanRankThreshold )
 			{
-				mRedundantGroups[ groupIndex - 1 ].push_back( currentColumnFeature );
-				processedFeatures.push_back( currentColumnFeature );
+				mRedundantGroups[ groupIndex - 1 ].push_back( columnFeatures.name( j ) );
+				isProcessed[ currentColumnSymbol ] = 1;
 			}
 		}
 	}
@@ -29,7 +29,13 @@ class ChickenEmbryo
 
 public:
 
-	ChickenEmbryo( QString aProjectFolderPath, QString aVolumeFeatureName = "" );
+	/*!
+	* \brief Constructor, loads the input matrices.
+	* \param [in] aProjectFolderPath The folder of CM.csv and CL.csv.
+	* \param [in] aVolumeFeatureName The name of the volume feature, empty if there is none.
+	* \param [in] aCacheDirectory The directory of the parsed table cache of the loader, empty to parse the files on each run.
+	*/
+	ChickenEmbryo( QString aProjectFolderPath, QString aVolumeFeatureName = "", QString aCacheDirectory = "" );
 	~ChickenEmbryo();
 
 	void execute( double aSpearmanRankThreshold );
@@ -9,6 +9,7 @@
 */
 
 #include <TestApplication/ImageMaskTiler.h>
+#include <TestApplication/MaskMorphology.h>
 #include <QDirIterator>
 #include <QDebug>
 #include <random>
@@ -73,8 +74,8 @@ void ImageMaskTiler::processImagePairs( QString aImagePairFolderPath )
 {
 	QDirIterator it( aImagePairFolderPath, QDir::AllEntries | QDir::NoDotAndDotDot, QDirIterator::Subdirectories );
 
-	QImage mask;
 	QImage image;
+	BinaryMask mask;
 
 	bool isMaskLoaded  = false;
 	bool isImageLoaded = false;
@@ -91,10 +92,11 @@ void ImageMaskTiler::processImagePairs( QString aImagePairFolderPath )
 		{
 			if ( name.contains( "Mask.tif" ) )
 			{
-				mask.load( path, "tiff" );
+				QImage maskImage;
+				maskImage.load( path, "tiff" );
 				isMaskLoaded = true;
 
-				mask = morphClose( mask, 3 );
+				mask = morphClose( maskImage, 3 );
 			}
 			else
 			{
@@ -115,7 +117,7 @@ void ImageMaskTiler::processImagePairs( QString aImagePairFolderPath )
 
 //-----------------------------------------------------------------------------
 
-void ImageMaskTiler::tileImages( QImage aImage, QImage aMask, QString aImagePairFolderPath )
+void ImageMaskTiler::tileImages( QImage aImage, const BinaryMask& aMask, QString aImagePairFolderPath )
 {
 	auto size = aImage.size();
 
@@ -131,7 +133,10 @@ void ImageMaskTiler::tileImages( QImage aImage, QImage aMask, QString aImagePair
 	qDebug() << "--------------------------------------------------";
 	qDebug() << "Target folder" << targetTileProjectFolderPath;
 	qDebug() << "Image and mask size" << size;
-	auto idealTileStart = detectIdealTileStart( aMask, sampleTilePath.replace("/","-") );
+	// The clear pixels are counted once, every tile is tested with four lookups.
+	SummedAreaTable clearPixels( aMask );
+	TileOffsetHistogram tileOffsets;
+	auto idealTileStart = detectIdealTileStart( aMask, clearPixels, sampleTilePath.replace("/","-"), tileOffsets );
 	qDebug() << "Ideal tile start" << idealTileStart;
 	
 	int tileCountX = size.width() / mTileSize;
@@ -144,7 +149,7 @@ void ImageMaskTiler::tileImages( QImage aImage, QImage aMask, QString aImagePair
 			int currentStartX = idealTileStart.first  + ( tX * mTileSize );
 			int currentStartY = idealTileStart.second + ( tY * mTileSize );
 
-			if ( validTile( aMask, currentStartX, currentStartY, currentStartX + mTileSize, currentStartY + mTileSize ) )
+			if ( validTile( clearPixels, currentStartX, currentStartY, currentStartX + mTileSize, currentStartY + mTileSize ) )
 			{
 				auto currentTile = tile( aImage, currentStartX, currentStartY, currentStartX + mTileSize, currentStartY + mTileSize );
 				QString tileFileName = targetTileProjectFolderPath + "/TILE-" + QString::number( tX ) + "-" + QString::number( tY ) + "-"
@@ -162,18 +167,11 @@ void ImageMaskTiler::tileImages( QImage aImage, QImage aMask, QString aImagePair
 
 //-----------------------------------------------------------------------------
 
-QImage ImageMaskTiler::morphClose( QImage aMask, int aRounds )
+BinaryMask ImageMaskTiler::morphClose( QImage aMask, int aRounds )
 {
-	for ( int i = 0; i < aRounds; ++i )
-	{
-		aMask = morphDilate( aMask );
-	}
-	for ( int i = 0; i < aRounds; ++i )
-	{
-		aMask = morphErode( aMask );
-	}
-
-	return aMask;
+	// Only the zero pixels matter to the tiling, so the mask is closed as one bit per pixel. Closing by a square of radius
+	// aRounds equals aRounds 3x3 dilations followed by aRounds 3x3 erosions.
+	return BinaryMask( aMask ).closed( StructuringElement::rectangle( aRounds, aRounds ) );
 }
 
 //-----------------------------------------------------------------------------
@@ -182,38 +180,7 @@ QImage ImageMaskTiler::morphErode( QImage aMask )
 {
 	qDebug() << "morphErode";
 
-	QImage eroded = aMask;
-	auto size = aMask.size();
-	eroded.fill( Qt::GlobalColor::black );
-
-	for ( int i = 0; i < size.width(); ++i )
-	{
-		for ( int j = 0; j < size.height(); ++j )
-		{
-			int min = 255;
-
-			for ( int ii = i - 1; ii < i + 2; ++ii )
-			{
-				for ( int jj = j - 1; jj < j + 2; ++jj )
-				{
-						
-						if ( ii > -1 && jj > -1 && ii < size.width() && jj < size.height() )
-						{
-							int value = aMask.pixelColor( QPoint( ii, jj ) ).lightness();
-							if ( value < min )
-							{
-								min = value;
-							}
-						}
-						
-				}
-			}
-
-			eroded.setPixelColor( QPoint( i, j ), QColor( min, min, min ) );
-		}
-	}
-
-	return eroded;
+	return MaskMorphology::toMaskFormat( MaskMorphology::erode( MaskMorphology::lightnessPlane( aMask ) ), aMask );
 }
 
 //-----------------------------------------------------------------------------
@@ -222,129 +189,69 @@ QImage ImageMaskTiler::morphDilate( QImage aMask )
 {
 	qDebug() << "morphDilate";
 
-	QImage dilated = aMask;
-	auto size = aMask.size();
-	dilated.fill( Qt::GlobalColor::black );
-
-	for ( int i = 0; i < size.width(); ++i )
-	{
-		for ( int j = 0; j < size.height(); ++j )
-		{
-			int max = 0;
-
-			for ( int ii = i - 1; ii < i + 2; ++ii )
-			{
-				for ( int jj = j - 1; jj < j + 2; ++jj )
-				{
-
-					if ( ii > -1 && jj > -1 && ii < size.width() && jj < size.height() )
-					{
-						int value = aMask.pixelColor( QPoint( ii, jj ) ).lightness();
-						if ( value > max )
-						{
-							max = value;
-						}
-					}
-
-				}
-			}
-
-			dilated.setPixelColor( QPoint( i, j ), QColor( max, max, max ) );
-		}
-	}
-
-	return dilated;
+	return MaskMorphology::toMaskFormat( MaskMorphology::dilate( MaskMorphology::lightnessPlane( aMask ) ), aMask );
 }
 
 //-----------------------------------------------------------------------------
 
-QPair< int, int > ImageMaskTiler::detectIdealTileStart( QImage aMask, QString aScanPath )
+QPair< int, int > ImageMaskTiler::detectIdealTileStart( const BinaryMask& aMask, const SummedAreaTable& aClearPixels, QString aScanPath, TileOffsetHistogram& aTileOffsets )
 {
-	std::random_device rd;
-	std::mt19937 eng( rd() );
-	std::uniform_int_distribution< int > RGB( 0, 255 );
-
-	auto maskSize = aMask.size();
-	int tileCountX = maskSize.width()  / mTileSize;
-	int tileCountY = maskSize.height() / mTileSize;
+	int tileCountX = aMask.width()  / mTileSize;
+	int tileCountY = aMask.height() / mTileSize;
 
 	bool isLog = true;
 
 	qDebug() << "Number of maximum tiles" << tileCountX << "x" << tileCountY;
 
-	QPair< int, int > bestCoordinate;
-	int               maxTileCount = 0;
+	// One pass over the anchors of all valid tiles counts the tiles of every start, the search keeps to half a tile.
+	aTileOffsets = TileOffsetHistogram( aClearPixels, mTileSize );
+	QPair< int, int > bestCoordinate = aTileOffsets.bestOffset( mTileSize / 2 );
+	int               maxTileCount   = aTileOffsets.tileCount( bestCoordinate.first, bestCoordinate.second );
+
+	qDebug() << "number of tiles identified:" << maxTileCount << "with start x,y" << bestCoordinate;
 
-	for ( int sX = 0; sX < mTileSize / 2; ++sX )
+	// Only the tiles of the best start are painted, each in a random color.
+	if ( isLog && maxTileCount > 0 )
 	{
-		for ( int sY = 0; sY < mTileSize / 2; ++sY )
-		{
-			QImage logTile = aMask;
+		std::random_device rd;
+		std::mt19937 eng( rd() );
+		std::uniform_int_distribution< int > RGB( 0, 255 );
 
-			// Check number of valid tiles with current sX and sY shifts.
-			int validTileCount = 0;
-			for ( int tX = 0; tX < tileCountX; ++tX )
+		QImage logTile = aMask.toImage();
+		for ( int tX = 0; tX < tileCountX; ++tX )
+		{
+			for ( int tY = 0; tY < tileCountY; ++tY )
 			{
-				for ( int tY = 0; tY < tileCountY; ++tY )
-				{
-					int currentStartX = sX + ( tX * mTileSize );
-					int currentStartY = sY + ( tY * mTileSize );
+				int currentStartX = bestCoordinate.first  + ( tX * mTileSize );
+				int currentStartY = bestCoordinate.second + ( tY * mTileSize );
 
-					if ( validTile( aMask, currentStartX, currentStartY, currentStartX + mTileSize, currentStartY + mTileSize ) )
+				if ( validTile( aClearPixels, currentStartX, currentStartY, currentStartX + mTileSize, currentStartY + mTileSize ) )
+				{
+					QColor logColor( RGB( eng ), RGB( eng ), RGB( eng ) );
+					for ( int logX = currentStartX; logX < currentStartX + mTileSize; ++logX )
 					{
-						int logPixelValueR = RGB( eng );
-						int logPixelValueG = RGB( eng );
-						int logPixelValueB = RGB( eng );
-
-						++validTileCount;
-						if ( isLog )
+						for ( int logY = currentStartY; logY < currentStartY + mTileSize; ++logY )
 						{
-							for ( int logX = currentStartX; logX < currentStartX + mTileSize; ++logX )
-							{
-								for ( int logY = currentStartY; logY < currentStartY + mTileSize; ++logY )
-								{
-									
-									logTile.setPixelColor( QPoint( logX, logY ), QColor( logPixelValueR, logPixelValueG, logPixelValueB ) );
-								}
-							}
+							logTile.setPixelColor( QPoint( logX, logY ), logColor );
 						}
 					}
 				}
 			}
-
-			if ( validTileCount > maxTileCount )
-			{
-				maxTileCount = validTileCount;
-				bestCoordinate.first  = sX;
-				bestCoordinate.second = sY;
-				if ( isLog ) logTile.save( mProjectFolderPath + "/log/BestTile-" + aScanPath + ".tif", "tif" );
-			}
 		}
-	}
 
-	qDebug() << "number of tiles identified:" << maxTileCount << "with start x,y" << bestCoordinate;
+		logTile.save( mProjectFolderPath + "/log/BestTile-" + aScanPath + ".tif", "tif" );
+	}
 
 	return bestCoordinate;
 }
 
 //-----------------------------------------------------------------------------
 
-bool ImageMaskTiler::validTile( QImage aMask, int aStartX, int aStartY, int aEndX, int aEndY )
+bool ImageMaskTiler::validTile( const SummedAreaTable& aClearPixels, int aStartX, int aStartY, int aEndX, int aEndY )
 {
-	auto maskSize = aMask.size();
-
-	if ( aEndX > maskSize.width() || aEndY > maskSize.height() ) return false;
-
-	for ( int i = aStartX; i < aEndX; ++i )
-	{
-		for ( int j = aStartY; j < aEndY; ++j )
-		{
-			int value = aMask.pixelColor( QPoint( i, j ) ).lightness();
-			if ( value == 0 ) return false;
-		}
-	}
+	if ( aEndX > aClearPixels.width() || aEndY > aClearPixels.height() ) return false;
 
-	return true;
+	return aClearPixels.clearCount( aStartX, aStartY, aEndX, aEndY ) == 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -11,6 +11,9 @@
 
 #pragma once
 
+#include <TestApplication/BinaryMask.h>
+#include <TestApplication/SummedAreaTable.h>
+#include <TestApplication/TileOffsetHistogram.h>
 #include <QList>
 #include <QString>
 #include <QImage>
@@ -30,17 +33,26 @@ public:
 
 	void execute();
 
+	/*!
+	* \brief Erodes the mask by a 3x3 square on its 8-bit scanlines, pixels outside the mask ignored; the result is in the
+	* format of the mask and bit-identical to the pixelColor() loop it replaces.
+	*/
+	QImage morphErode( QImage aMask );
+
+	/*!
+	* \brief Dilates the mask by a 3x3 square on its 8-bit scanlines, as morphErode().
+	*/
+	QImage morphDilate( QImage aMask );
+
 private:
 
 	void scanImagePairPaths();
 	void processImagePairs( QString aImagePairFolderPath );
-	void tileImages( QImage aImage, QImage aMask, QString aImagePairFolderPath );
-	QImage morphClose( QImage aMask, int aRounds );
-	QImage morphErode( QImage aMask );
-	QImage morphDilate( QImage aMask );
+	void tileImages( QImage aImage, const BinaryMask& aMask, QString aImagePairFolderPath );
+	BinaryMask morphClose( QImage aMask, int aRounds );
 
-	QPair< int, int > detectIdealTileStart( QImage aMask, QString aScanPath );
-	bool validTile( QImage aMask, int aStartX, int aStartY, int aEndX, int aEndY );
+	QPair< int, int > detectIdealTileStart( const BinaryMask& aMask, const SummedAreaTable& aClearPixels, QString aScanPath, TileOffsetHistogram& aTileOffsets );
+	bool validTile( const SummedAreaTable& aClearPixels, int aStartX, int aStartY, int aEndX, int aEndY );
 	QImage tile( QImage aImage, int aStartX, int aStartY, int aEndX, int aEndY );
 
 private:
@@ -0,0 +1,290 @@
+/*!
+* \file
+* Member function definitions for MaskMorphology class.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#include <TestApplication/MaskMorphology.h>
+#include <QColor>
+#include <QtMath>
+#include <algorithm>
+#include <cstring>
+#include <emmintrin.h>
+
+//-----------------------------------------------------------------------------
+
+namespace muw
+{
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+const int kMaximumDiskRectangles = 4;   //!< The rectangles approximating a disk, their number bounds its cost.
+
+struct Minimum
+{
+	static __m128i apply( __m128i aLeft, __m128i aRight ) { return _mm_min_epu8( aLeft, aRight ); }
+	static uchar apply( uchar aLeft, uchar aRight ) { return std::min( aLeft, aRight ); }
+};
+
+struct Maximum
+{
+	static __m128i apply( __m128i aLeft, __m128i aRight ) { return _mm_max_epu8( aLeft, aRight ); }
+	static uchar apply( uchar aLeft, uchar aRight ) { return std::max( aLeft, aRight ); }
+};
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Combines two rows element by element into the target row, which may be one of them.
+*/
+template< typename Operation >
+void combineRows( const uchar* aFirst, const uchar* aSecond, uchar* aTarget, int aWidth )
+{
+	// SSE2 is part of x64, no check needed.
+	int x = 0;
+	for ( ; x + 16 <= aWidth; x += 16 )
+	{
+		__m128i first  = _mm_loadu_si128( reinterpret_cast< const __m128i* >( aFirst + x ) );
+		__m128i second = _mm_loadu_si128( reinterpret_cast< const __m128i* >( aSecond + x ) );
+		_mm_storeu_si128( reinterpret_cast< __m128i* >( aTarget + x ), Operation::apply( first, second ) );
+	}
+
+	for ( ; x < aWidth; ++x )
+	{
+		aTarget[ x ] = Operation::apply( aFirst[ x ], aSecond[ x ] );
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Filters a row by a window of 2 * aRadius + 1 pixels with the van Herk/Gil-Werman algorithm.
+* \details The row is padded by aRadius border pixels on both sides and cut into blocks of the window size. A window spans
+* the end of one block and the start of the next one, so it is the combination of the suffix of the first and the prefix
+* of the second: three operations per pixel whatever the radius. Repeating the border pixels leaves the minimum and the
+* maximum of the pixels inside the row unchanged.
+*/
+template< typename Operation >
+void filterRow( const uchar* aSource, uchar* aTarget, int aWidth, int aRadius, QVector< uchar >& aPadded, QVector< uchar >& aPrefix, QVector< uchar >& aSuffix )
+{
+	int windowSize = 2 * aRadius + 1;
+	int paddedSize = ( aWidth + 2 * aRadius + windowSize - 1 ) / windowSize * windowSize;
+	aPadded.resize( paddedSize );
+	aPrefix.resize( paddedSize );
+	aSuffix.resize( paddedSize );
+
+	uchar* padded = aPadded.data();
+	std::memset( padded, aSource[ 0 ], size_t( aRadius ) );
+	std::memcpy( padded + aRadius, aSource, size_t( aWidth ) );
+	std::memset( padded + aRadius + aWidth, aSource[ aWidth - 1 ], size_t( paddedSize - aRadius - aWidth ) );
+
+	uchar* prefix = aPrefix.data();
+	uchar* suffix = aSuffix.data();
+	for ( int blockStart = 0; blockStart < paddedSize; blockStart += windowSize )
+	{
+		int blockEnd = blockStart + windowSize - 1;
+
+		prefix[ blockStart ] = padded[ blockStart ];
+		for ( int i = blockStart + 1; i <= blockEnd; ++i )
+		{
+			prefix[ i ] = Operation::apply( prefix[ i - 1 ], padded[ i ] );
+		}
+
+		suffix[ blockEnd ] = padded[ blockEnd ];
+		for ( int i = blockEnd - 1; i >= blockStart; --i )
+		{
+			suffix[ i ] = Operation::apply( suffix[ i + 1 ], padded[ i ] );
+		}
+	}
+
+	for ( int x = 0; x < aWidth; ++x )
+	{
+		aTarget[ x ] = Operation::apply( suffix[ x ], prefix[ x + windowSize - 1 ] );
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Filters the plane by a centered rectangle, first along the rows, then along the columns.
+* \details The column pass runs the van Herk/Gil-Werman algorithm of filterRow on whole rows, so that the prefixes and the
+* suffixes of all columns are combined 16 pixels at a time.
+*/
+template< typename Operation >
+QImage filterRectangle( const QImage& aPlane, int aRadiusX, int aRadiusY )
+{
+	int width  = aPlane.width();
+	int height = aPlane.height();
+	if ( width == 0 || height == 0 ) return aPlane;
+
+	QVector< uchar > padded;
+	QVector< uchar > prefix;
+	QVector< uchar > suffix;
+	QVector< uchar > rowFiltered( width * height );
+	for ( int y = 0; y < height; ++y )
+	{
+		filterRow< Operation >( aPlane.constScanLine( y ), rowFiltered.data() + y * width, width, aRadiusX, padded, prefix, suffix );
+	}
+
+	int windowSize = 2 * aRadiusY + 1;
+	int paddedSize = ( height + 2 * aRadiusY + windowSize - 1 ) / windowSize * windowSize;
+	auto paddedRow = [ & ]( int aRow ) { return rowFiltered.constData() + std::min( std::max( aRow - aRadiusY, 0 ), height - 1 ) * width; };
+
+	QVector< uchar > prefixRows( paddedSize * width );
+	QVector< uchar > suffixRows( paddedSize * width );
+	for ( int i = 0; i < paddedSize; ++i )
+	{
+		uchar* target = prefixRows.data() + i * width;
+		if ( i % windowSize == 0 ) std::memcpy( target, paddedRow( i ), size_t( width ) );
+		else combineRows< Operation >( target - width, paddedRow( i ), target, width );
+	}
+
+	for ( int i = paddedSize - 1; i >= 0; --i )
+	{
+		uchar* target = suffixRows.data() + i * width;
+		if ( i % windowSize == windowSize - 1 ) std::memcpy( target, paddedRow( i ), size_t( width ) );
+		else combineRows< Operation >( target + width, paddedRow( i ), target, width );
+	}
+
+	// The result is a copy of the plane, so that it keeps its metadata.
+	QImage filtered = aPlane;
+	for ( int y = 0; y < height; ++y )
+	{
+		combineRows< Operation >( suffixRows.constData() + y * width, prefixRows.constData() + ( y + windowSize - 1 ) * width, filtered.scanLine( y ), width );
+	}
+
+	return filtered;
+}
+
+//-----------------------------------------------------------------------------
+
+/*!
+* \brief Filters the plane by each rectangle of the element and combines the results.
+*/
+template< typename Operation >
+QImage filter( const QImage& aPlane, const StructuringElement& aElement )
+{
+	if ( aElement.radii.isEmpty() ) return aPlane;
+
+	QImage filtered = filterRectangle< Operation >( aPlane, aElement.radii.first().width(), aElement.radii.first().height() );
+	for ( int rectangleIndex = 1; rectangleIndex < aElement.radii.size(); ++rectangleIndex )
+	{
+		const QSize& radius = aElement.radii.at( rectangleIndex );
+		QImage rectangleFiltered = filterRectangle< Operation >( aPlane, radius.width(), radius.height() );
+		for ( int y = 0; y < filtered.height(); ++y )
+		{
+			combineRows< Operation >( filtered.constScanLine( y ), rectangleFiltered.constScanLine( y ), filtered.scanLine( y ), filtered.width() );
+		}
+	}
+
+	return filtered;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+
+StructuringElement StructuringElement::rectangle( int aRadiusX, int aRadiusY )
+{
+	StructuringElement element;
+	element.radii.push_back( QSize( std::max( aRadiusX, 0 ), std::max( aRadiusY, 0 ) ) );
+	return element;
+}
+
+//-----------------------------------------------------------------------------
+
+StructuringElement StructuringElement::disk( int aRadius )
+{
+	// The corners of the rectangles are spread evenly over the quarter circle, rectangles inside others are left out.
+	int rectangleCount = std::min( std::max( aRadius, 0 ) + 1, kMaximumDiskRectangles );
+
+	StructuringElement element;
+	for ( int rectangleIndex = 0; rectangleIndex < rectangleCount; ++rectangleIndex )
+	{
+		double angle = M_PI / 2.0 * ( rectangleIndex + 0.5 ) / rectangleCount;
+		QSize radius( qRound( aRadius * qCos( angle ) ), qRound( aRadius * qSin( angle ) ) );
+
+		auto containsRadius = [ &radius ]( const QSize& aOther ) { return aOther.width() >= radius.width() && aOther.height() >= radius.height(); };
+		auto isInsideRadius = [ &radius ]( const QSize& aOther ) { return aOther.width() <= radius.width() && aOther.height() <= radius.height(); };
+		if ( std::any_of( element.radii.begin(), element.radii.end(), containsRadius ) ) continue;
+
+		element.radii.erase( std::remove_if( element.radii.begin(), element.radii.end(), isInsideRadius ), element.radii.end() );
+		element.radii.push_back( radius );
+	}
+
+	return element;
+}
+
+//-----------------------------------------------------------------------------
+
+QImage MaskMorphology::lightnessPlane( const QImage& aMask )
+{
+	if ( aMask.format() == QImage::Format_Grayscale8 ) return aMask;
+
+	QImage plane( aMask.size(), QImage::Format_Grayscale8 );
+	for ( int y = 0; y < aMask.height(); ++y )
+	{
+		uchar* target = plane.scanLine( y );
+		for ( int x = 0; x < aMask.width(); ++x )
+		{
+			target[ x ] = uchar( aMask.pixelColor( QPoint( x, y ) ).lightness() );
+		}
+	}
+
+	return plane;
+}
+
+//-----------------------------------------------------------------------------
+
+QImage MaskMorphology::toMaskFormat( const QImage& aPlane, const QImage& aMask )
+{
+	if ( aMask.format() == QImage::Format_Grayscale8 ) return aPlane;
+
+	QImage mask = aMask;
+	mask.fill( Qt::GlobalColor::black );
+
+	for ( int y = 0; y < aPlane.height(); ++y )
+	{
+		const uchar* source = aPlane.constScanLine( y );
+		for ( int x = 0; x < aPlane.width(); ++x )
+		{
+			mask.setPixelColor( QPoint( x, y ), QColor( source[ x ], source[ x ], source[ x ] ) );
+		}
+	}
+
+	return mask;
+}
+
+//-----------------------------------------------------------------------------
+
+QImage MaskMorphology::erode( const QImage& aPlane, const StructuringElement& aElement )
+{
+	return filter< Minimum >( aPlane, aElement );
+}
+
+//-----------------------------------------------------------------------------
+
+QImage MaskMorphology::dilate( const QImage& aPlane, const StructuringElement& aElement )
+{
+	return filter< Maximum >( aPlane, aElement );
+}
+
+//-----------------------------------------------------------------------------
+
+QImage MaskMorphology::close( const QImage& aPlane, const StructuringElement& aElement )
+{
+	return erode( dilate( aPlane, aElement ), aElement );
+}
+
+//-----------------------------------------------------------------------------
+
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,81 @@
+/*!
+* The MaskMorphology class implements the grayscale morphology of the masks processed by the ImageMaskTiler class.
+* The operations work on 8-bit planes (Format_Grayscale8 images) row by row through their scanlines. Rectangles are applied
+* separably with the van Herk/Gil-Werman running minimum and maximum, which costs the same per pixel whatever the radius;
+* the column pass combines whole rows with SSE2.
+*
+* \remarks
+* A plane holds the lightness of the mask pixels, as QColor::lightness() returns it; a Format_Grayscale8 mask is its own plane.
+* Pixels outside the plane are ignored, like the border handling of repeated 3x3 passes.
+*
+* \authors
+* lpapp
+*/
+
+#pragma once
+
+#include <QImage>
+#include <QVector>
+
+//-----------------------------------------------------------------------------
+
+namespace muw
+{
+
+/*!
+* \brief A structuring element centered on the pixel: the union of centered rectangles.
+*/
+struct StructuringElement
+{
+	QVector< QSize > radii;   //!< The half widths and half heights of the rectangles, a radius of 1 is 3 pixels wide.
+
+	/*!
+	* \brief Returns with a (2 * aRadiusX + 1) x (2 * aRadiusY + 1) rectangle.
+	*/
+	static StructuringElement rectangle( int aRadiusX, int aRadiusY );
+
+	/*!
+	* \brief Returns with a disk approximated by up to four rectangles inscribed in it, so that it costs at most four
+	* rectangles whatever the radius. A radius of 1 gives the 4-neighborhood, a radius of 0 the pixel itself.
+	*/
+	static StructuringElement disk( int aRadius );
+};
+
+//-----------------------------------------------------------------------------
+
+class MaskMorphology
+{
+
+public:
+
+	/*!
+	* \brief Returns with the plane of the lightness of the mask pixels, the mask itself if it is Format_Grayscale8.
+	*/
+	static QImage lightnessPlane( const QImage& aMask );
+
+	/*!
+	* \brief Returns with the plane stored in the format of the mask, gray pixels as QImage::setPixelColor() stores them.
+	*/
+	static QImage toMaskFormat( const QImage& aPlane, const QImage& aMask );
+
+	/*!
+	* \brief Erodes the plane, each pixel becomes the minimum of the pixels of the element around it inside the plane.
+	*/
+	static QImage erode( const QImage& aPlane, const StructuringElement& aElement = StructuringElement::rectangle( 1, 1 ) );
+
+	/*!
+	* \brief Dilates the plane, each pixel becomes the maximum of the pixels of the element around it inside the plane.
+	*/
+	static QImage dilate( const QImage& aPlane, const StructuringElement& aElement = StructuringElement::rectangle( 1, 1 ) );
+
+	/*!
+	* \brief Closes the plane: dilates, then erodes it by the element. Closing by rectangle( n, n ) equals n 3x3 dilations
+	* followed by n 3x3 erosions.
+	*/
+	static QImage close( const QImage& aPlane, const StructuringElement& aElement );
+
+};
+
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,63 @@
+/*!
+* \file
+* Member function definitions for SummedAreaTable class.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#include <TestApplication/SummedAreaTable.h>
+
+//-----------------------------------------------------------------------------
+
+namespace muw
+{
+
+//-----------------------------------------------------------------------------
+
+SummedAreaTable::SummedAreaTable()
+:
+	mWidth( 0 ),
+	mHeight( 0 ),
+	mEntries( 1, 0 )
+{
+}
+
+//-----------------------------------------------------------------------------
+
+SummedAreaTable::SummedAreaTable( const BinaryMask& aMask )
+:
+	mWidth( aMask.width() ),
+	mHeight( aMask.height() ),
+	mEntries( size_t( qint64( aMask.width() + 1 ) * qint64( aMask.height() + 1 ) ), 0 )
+{
+	// Each entry is the one above it plus the clear pixels of its row up to it.
+	size_t stride = size_t( mWidth ) + 1;
+	quint32* entries = mEntries.data();
+	for ( int y = 0; y < mHeight; ++y )
+	{
+		const quint32* above = entries + size_t( y ) * stride;
+		quint32* target = entries + size_t( y + 1 ) * stride;
+
+		quint32 rowCount = 0;
+		for ( int x = 0; x < mWidth; ++x )
+		{
+			rowCount += aMask.pixel( x, y ) ? 0 : 1;
+			target[ x + 1 ] = above[ x + 1 ] + rowCount;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+SummedAreaTable::~SummedAreaTable()
+{
+}
+
+//-----------------------------------------------------------------------------
+
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,67 @@
+/*!
+* The SummedAreaTable class counts the clear pixels of a BinaryMask in any rectangle in constant time, e.g. to test whether
+* a candidate tile of the ImageMaskTiler class lies completely inside the mask.
+*
+* \remarks
+* Entry (x, y) of the table is the number of clear pixels above and to the left of pixel (x, y); the table has one more row
+* and column than the mask. The entries are 32 bit and wrap around, the differences of clearCount() are exact all the same
+* for any rectangle of less than 2^32 pixels. The table takes 4 bytes per pixel, 32 times the BinaryMask it is built from,
+* e.g. 1.6 GB for a 20000 x 20000 mask; its size is computed in 64 bits, so only the memory limits the mask.
+*
+* \authors
+* lpapp
+*/
+
+#pragma once
+
+#include <TestApplication/BinaryMask.h>
+#include <QtGlobal>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+
+namespace muw
+{
+
+class SummedAreaTable
+{
+
+public:
+
+	SummedAreaTable();
+
+	/*!
+	* \brief Builds the table of the clear pixels of the mask in one pass.
+	*/
+	explicit SummedAreaTable( const BinaryMask& aMask );
+
+	~SummedAreaTable();
+
+	int width() const { return mWidth; }
+
+	int height() const { return mHeight; }
+
+	/*!
+	* \brief Returns with the number of clear pixels of the rectangle [aStartX, aEndX) x [aStartY, aEndY), from the entries
+	* of its four corners.
+	*/
+	qint64 clearCount( int aStartX, int aStartY, int aEndX, int aEndY ) const
+	{
+		return qint64( quint32( entry( aEndX, aEndY ) - entry( aStartX, aEndY ) - entry( aEndX, aStartY ) + entry( aStartX, aStartY ) ) );
+	}
+
+private:
+
+	quint32 entry( int aX, int aY ) const { return mEntries[ size_t( aY ) * size_t( mWidth + 1 ) + size_t( aX ) ]; }
+
+private:
+
+	int                      mWidth;     //!< The width of the mask.
+	int                      mHeight;    //!< The height of the mask.
+	std::vector< quint32 >   mEntries;   //!< The ( mWidth + 1 ) x ( mHeight + 1 ) entries row by row, modulo 2^32.
+
+};
+
+}
+
+//-----------------------------------------------------------------------------
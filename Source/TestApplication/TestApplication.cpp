@@ -104,6 +104,7 @@ TestApplication::TestApplication( QWidget *parent )
 void TestApplication::fDBSliderChanged( int aPosition )
 {
 	lpmlfio::TabularDataFileIo loader;
+	loader.setCacheDirectory( mSettingsMap->value( "Loading/CacheDirectory" ).toString() );
 
 	QString actualFDBPath = mFDBList.at( aPosition );
 
@@ -125,6 +126,7 @@ void TestApplication::fDBSliderChanged( int aPosition )
 void TestApplication::buildUpFDBList()
 {
 	lpmlfio::TabularDataFileIo loader;
+	loader.setCacheDirectory( mSettingsMap->value( "Loading/CacheDirectory" ).toString() );
 	lpmleval::TabularDataFilter filter;
 
 	// TODO: build up the fdblist
@@ -141,8 +143,9 @@ void TestApplication::buildUpFDBList()
 		}
 	}
 
-	loader.load( mFDBList.at( 0 ), mFDBLoaded );
-	loader.load( ui.folderPath->text() + "/Labels/LDB", mLDBLoaded );
+	QVector< lpmldata::TabularData > databases = loader.loadMany( { mFDBList.at( 0 ), ui.folderPath->text() + "/Labels/LDB" } );
+	mFDBLoaded = std::move( databases[ 0 ] );
+	mLDBLoaded = std::move( databases[ 1 ] );
 
 	mKDExtractor = new lpmleval::KernelDensityExtractor( mFDBLoaded, mLDBLoaded, mActiveLabel );
 	QMap< double, int > overlapR = mKDExtractor->overlapRatios();
@@ -0,0 +1,88 @@
+/*!
+* \file
+* Member function definitions for TileOffsetHistogram class.
+*
+* \remarks
+*
+* \authors
+* lpapp
+*/
+
+#include <TestApplication/TileOffsetHistogram.h>
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+
+namespace muw
+{
+
+//-----------------------------------------------------------------------------
+
+TileOffsetHistogram::TileOffsetHistogram()
+:
+	mTileSize( 0 ),
+	mTileCounts()
+{
+}
+
+//-----------------------------------------------------------------------------
+
+TileOffsetHistogram::TileOffsetHistogram( const SummedAreaTable& aClearPixels, int aTileSize )
+:
+	mTileSize( aTileSize ),
+	mTileCounts( aTileSize * aTileSize, 0 )
+{
+	if ( aTileSize <= 0 ) return;
+
+	// Every anchor of a tile that fits is tested once; x % T and y % T are tracked instead of divided.
+	int* tileCounts = mTileCounts.data();
+	int offsetY = 0;
+	for ( int y = 0; y + aTileSize <= aClearPixels.height(); ++y )
+	{
+		int* offsetCounts = tileCounts + offsetY * aTileSize;
+		int offsetX = 0;
+		for ( int x = 0; x + aTileSize <= aClearPixels.width(); ++x )
+		{
+			if ( aClearPixels.clearCount( x, y, x + aTileSize, y + aTileSize ) == 0 ) ++offsetCounts[ offsetX ];
+			if ( ++offsetX == aTileSize ) offsetX = 0;
+		}
+
+		if ( ++offsetY == aTileSize ) offsetY = 0;
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+TileOffsetHistogram::~TileOffsetHistogram()
+{
+}
+
+//-----------------------------------------------------------------------------
+
+QPair< int, int > TileOffsetHistogram::bestOffset( int aSearchSize ) const
+{
+	QPair< int, int > bestCoordinate( 0, 0 );
+	int maxTileCount = 0;
+
+	int searchSize = std::min( aSearchSize, mTileSize );
+	for ( int offsetX = 0; offsetX < searchSize; ++offsetX )
+	{
+		for ( int offsetY = 0; offsetY < searchSize; ++offsetY )
+		{
+			if ( tileCount( offsetX, offsetY ) > maxTileCount )
+			{
+				maxTileCount = tileCount( offsetX, offsetY );
+				bestCoordinate.first  = offsetX;
+				bestCoordinate.second = offsetY;
+			}
+		}
+	}
+
+	return bestCoordinate;
+}
+
+//-----------------------------------------------------------------------------
+
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,61 @@
+/*!
+* The TileOffsetHistogram class counts, for every offset of a grid of square tiles, the number of grid tiles that lie
+* completely inside a mask, e.g. to let the ImageMaskTiler class choose where its tiling starts.
+*
+* \remarks
+* A tile anchored at pixel (x, y) belongs to the grid of offset (x % T, y % T), T being the tile size. The anchors of all
+* valid tiles are visited once and counted into the bin of their offset, so the whole T x T surface costs O(W * H) instead
+* of one tiling per offset.
+*
+* \authors
+* lpapp
+*/
+
+#pragma once
+
+#include <TestApplication/SummedAreaTable.h>
+#include <QPair>
+#include <QVector>
+
+//-----------------------------------------------------------------------------
+
+namespace muw
+{
+
+class TileOffsetHistogram
+{
+
+public:
+
+	TileOffsetHistogram();
+
+	/*!
+	* \brief Builds the histogram of the valid tiles of the given size, those without clear pixels in the table.
+	*/
+	TileOffsetHistogram( const SummedAreaTable& aClearPixels, int aTileSize );
+
+	~TileOffsetHistogram();
+
+	int tileSize() const { return mTileSize; }
+
+	/*!
+	* \brief Returns with the number of valid tiles of the grid starting at (aOffsetX, aOffsetY), both in [0, tileSize()).
+	*/
+	int tileCount( int aOffsetX, int aOffsetY ) const { return mTileCounts.at( aOffsetY * mTileSize + aOffsetX ); }
+
+	/*!
+	* \brief Returns with the offset of the most valid tiles among those below aSearchSize in both directions, the first one
+	* by x, then by y, on ties; (0, 0) if no grid has a valid tile.
+	*/
+	QPair< int, int > bestOffset( int aSearchSize ) const;
+
+private:
+
+	int              mTileSize;     //!< The edge length of the tiles.
+	QVector< int >   mTileCounts;   //!< The tile counts of the mTileSize x mTileSize offsets row by row.
+
+};
+
+}
+
+//-----------------------------------------------------------------------------
@@ -13,13 +13,14 @@ int main( int argc, char* argv[] )
 	QString projectFolderPath = "c:/XOCTRA/";
 	int tileWidthHeight = 80;
 	double SpearmanRankThreshold = 0.7;
+	QString tableCacheFolderPath = "";  // E.g. projectFolderPath + "/Cache/" to keep the parsed CSV files between runs.
 
 	// Use Case 1: Tiling OCT images and their corresponding masks.
 	muw::ImageMaskTiler IMT( projectFolderPath + "/ToTile/", tileWidthHeight );
 	IMT.execute();
 
 	// USe Case 2: Radiomics redundancy clustering and ranking
-	muw::ChickenEmbryo Embryo( projectFolderPath + "/Radiomics/" );
+	muw::ChickenEmbryo Embryo( projectFolderPath + "/Radiomics/", "", tableCacheFolderPath );
 	Embryo.execute( SpearmanRankThreshold );
 
 	return 0;